@@ -0,0 +1,10 @@
+#version 330 core
+
+#include "material.glsl"
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = materialColor();
+}
@@ -0,0 +1,27 @@
+#version 330 core
+
+// Pass-through vertex shader shared by the scenes that are built from shader files.
+// The inputs are switched on by the same permutation defines as the fragment shader.
+
+layout (location = 0) in vec3 aPos;
+
+#if defined(USE_VERTEX_COLOR) || defined(UBER_SHADER)
+layout (location = 1) in vec3 aColor;
+out vec3 vtxColor;
+#endif
+
+#if defined(USE_TEXTURE) || defined(UBER_SHADER)
+layout (location = 2) in vec2 aTexCoord;
+out vec2 texCoord;
+#endif
+
+void main()
+{
+    gl_Position = vec4(aPos.xyz, 1.0);
+#if defined(USE_VERTEX_COLOR) || defined(UBER_SHADER)
+    vtxColor = aColor;
+#endif
+#if defined(USE_TEXTURE) || defined(UBER_SHADER)
+    texCoord = aTexCoord;
+#endif
+}
@@ -0,0 +1,37 @@
+// Color of a surface, built from the vertex color and/or a texture.
+//   USE_VERTEX_COLOR: multiply by the interpolated vertex color
+//   USE_TEXTURE: multiply by textureSampler at texCoord
+//   UBER_SHADER: everything is compiled in and switched at runtime with the useVertexColor/useTexture uniforms
+
+#if defined(USE_VERTEX_COLOR) || defined(UBER_SHADER)
+in vec3 vtxColor;
+#endif
+
+// the fragment shader needs to know the texture we are using to render the final pixel color
+// OpenGL has sampler[123]D for this purpose
+#if defined(USE_TEXTURE) || defined(UBER_SHADER)
+uniform sampler2D textureSampler;
+in vec2 texCoord;
+#endif
+
+#ifdef UBER_SHADER
+uniform bool useVertexColor;
+uniform bool useTexture;
+#endif
+
+vec4 materialColor()
+{
+    vec4 color = vec4(1.0);
+#ifdef UBER_SHADER
+    if (useVertexColor) color *= vec4(vtxColor, 1.0);
+    if (useTexture) color *= texture(textureSampler, texCoord);
+#else
+#ifdef USE_VERTEX_COLOR
+    color *= vec4(vtxColor, 1.0);
+#endif
+#ifdef USE_TEXTURE
+    color *= texture(textureSampler, texCoord);
+#endif
+#endif
+    return color;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <glad/glad.h>
+#include "batch.h"
+
+namespace batch {
+
+	int add(Batch& batch, const float* positions, int vertexCount, const unsigned int* indices, int indexCount,
+		float r, float g, float b)
+	{
+		if (batch.VAO != 0)
+		{
+			std::cout << "ERROR::BATCH::ALREADY_UPLOADED" << std::endl;
+			return -1;
+		}
+
+		Mesh mesh;
+		mesh.baseVertex = (int)batch.vertices.size();
+		mesh.firstIndex = (unsigned int)batch.indices.size();
+		mesh.indexCount = (unsigned int)indexCount;
+
+		for (int i = 0; i < vertexCount; i++)
+		{
+			batch.vertices.push_back({ positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], r, g, b });
+		}
+		// the indices stay relative to the mesh, the base vertex moves them to its vertices
+		batch.indices.insert(batch.indices.end(), indices, indices + indexCount);
+
+		batch.meshes.push_back(mesh);
+		return (int)batch.meshes.size() - 1;
+	}
+
+	int upload(Batch& batch)
+	{
+		if (batch.meshes.empty()) return -1;
+
+		glGenVertexArrays(1, &batch.VAO);
+		glGenBuffers(1, &batch.VBO);
+		glGenBuffers(1, &batch.EBO);
+
+		glBindVertexArray(batch.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, batch.VBO);
+		glBufferData(GL_ARRAY_BUFFER, batch.vertices.size() * sizeof(Vertex), batch.vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, batch.indices.size() * sizeof(unsigned int), batch.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+
+		// the parameters of the full draw never change
+		for (const Mesh& mesh : batch.meshes)
+		{
+			batch.counts.push_back((int)mesh.indexCount);
+			batch.offsets.push_back((const void*)(mesh.firstIndex * sizeof(unsigned int)));
+			batch.baseVertices.push_back(mesh.baseVertex);
+		}
+
+		// the GPU has its copy now
+		batch.vertices = std::vector<Vertex>();
+		batch.indices = std::vector<unsigned int>();
+
+		return 0;
+	}
+
+	void destroy(Batch& batch)
+	{
+		glDeleteVertexArrays(1, &batch.VAO);
+		glDeleteBuffers(1, &batch.VBO);
+		glDeleteBuffers(1, &batch.EBO);
+		batch = Batch();
+	}
+
+	void draw(const Batch& batch)
+	{
+		if (batch.VAO == 0) return;
+
+		glBindVertexArray(batch.VAO);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, batch.counts.data(), GL_UNSIGNED_INT, batch.offsets.data(),
+			(GLsizei)batch.counts.size(), batch.baseVertices.data());
+		glBindVertexArray(0);
+	}
+
+	void draw(const Batch& batch, const int* meshes, int count)
+	{
+		if (batch.VAO == 0 || count <= 0) return;
+
+		// gathered every call, the list of visible meshes usually changes from frame to frame
+		std::vector<int> counts(count), baseVertices(count);
+		std::vector<const void*> offsets(count);
+		for (int i = 0; i < count; i++)
+		{
+			const Mesh& mesh = batch.meshes[meshes[i]];
+			counts[i] = (int)mesh.indexCount;
+			offsets[i] = (const void*)(mesh.firstIndex * sizeof(unsigned int));
+			baseVertices[i] = mesh.baseVertex;
+		}
+
+		glBindVertexArray(batch.VAO);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), count, baseVertices.data());
+		glBindVertexArray(0);
+	}
+
+	void drawEach(const Batch& batch)
+	{
+		if (batch.VAO == 0) return;
+
+		glBindVertexArray(batch.VAO);
+		for (size_t i = 0; i < batch.counts.size(); i++)
+		{
+			glDrawElementsBaseVertex(GL_TRIANGLES, batch.counts[i], GL_UNSIGNED_INT, batch.offsets[i], batch.baseVertices[i]);
+		}
+		glBindVertexArray(0);
+	}
+
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+
+// Packs many small meshes that are drawn with the same program into one VBO and one EBO, so all of them can be
+// drawn with a single glMultiDrawElementsBaseVertex instead of a VAO bind and a draw call per mesh.
+// The color of a mesh is a vertex attribute, it does not need a uniform between the draws.
+// Vertex layout: location 0 = vec3 position, location 1 = vec3 color (what shaders/basic.vert reads).
+namespace batch {
+    struct Vertex {
+        float x, y, z;
+        float r, g, b;
+    };
+
+    // where a mesh is inside the batch's buffers
+    struct Mesh {
+        // the mesh's indices start at 0, they are offset by baseVertex at draw time
+        int baseVertex;
+        // first index in the EBO
+        unsigned int firstIndex;
+        unsigned int indexCount;
+    };
+
+    struct Batch {
+        unsigned int VAO, VBO, EBO;
+        // the CPU copy, cleared by upload
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<Mesh> meshes;
+        // glMultiDrawElementsBaseVertex parameters for drawing every mesh, built by upload
+        std::vector<int> counts;
+        std::vector<const void*> offsets;
+        std::vector<int> baseVertices;
+    };
+
+    // Adds a mesh of vertexCount positions (x, y, z) with the same color, indices are relative to the mesh.
+    // Returns the index of the mesh in the batch, or -1 if the batch was already uploaded.
+    int add(Batch& batch, const float* positions, int vertexCount, const unsigned int* indices, int indexCount,
+        float r, float g, float b);
+    // creates the buffers and the VAO, no meshes can be added after this. Returns 0 on success.
+    int upload(Batch& batch);
+    void destroy(Batch& batch);
+
+    // draws every mesh of the batch with one call
+    void draw(const Batch& batch);
+    // draws only the listed meshes, still with one call
+    void draw(const Batch& batch, const int* meshes, int count);
+    // One draw call per mesh from the same buffers, what the batch replaces. For comparisons only.
+    void drawEach(const Batch& batch);
+}
+
+#endif
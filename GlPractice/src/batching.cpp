@@ -0,0 +1,125 @@
+#include <iostream>
+#include <glad/glad.h>
+#include "batching.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "shader_preprocessor.h"
+#include "uniform_table.h"
+#include "batch.h"
+
+namespace batching {
+
+	const int gridSize = 64;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	batch::Batch meshes;
+	// uber mode only: the switches of the uber-shader
+	uniform_table::Table uniformTable;
+	uniform_table::IntHandle useVertexColorHandle = { -1 };
+	uniform_table::IntHandle useTextureHandle = { -1 };
+
+	void registerScene()
+	{
+		scene::registerScene({ "batching", init, NULL, render, shutdown });
+		scene::registerScene({ "batching_per_draw", init, NULL, renderPerDraw, shutdown });
+	}
+
+	int init() {
+		if (initShaders() != 0) return -1;
+		return initMeshes();
+	}
+
+	void useProgram()
+	{
+		shader_compiler::useProgram(shaderProgram);
+		// the handles are only valid for the uber-shader, otherwise these do nothing
+		uniform_table::setInt(uniformTable, useVertexColorHandle, 1);
+		uniform_table::setInt(uniformTable, useTextureHandle, 0);
+	}
+
+	void render()
+	{
+		// black background color
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		useProgram();
+		batch::draw(meshes);
+	}
+
+	void renderPerDraw()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		useProgram();
+		batch::drawEach(meshes);
+	}
+
+	void shutdown()
+	{
+		batch::destroy(meshes);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		shaderProgram = 0;
+		programJob = -1;
+		useVertexColorHandle = useTextureHandle = { -1 };
+	}
+
+	int initMeshes()
+	{
+		// every cell of the grid gets a triangle or a quad, the meshes are built around the origin
+		// and moved into their cell on the CPU, so the shader does not need a transform
+		const float triangle[] = { -.5f, -.5f, .0f,   .5f, -.5f, .0f,   .0f, .5f, .0f };
+		const unsigned int triangleIndices[] = { 0, 1, 2 };
+		const float quad[] = { -.5f, -.5f, .0f,   .5f, -.5f, .0f,   .5f, .5f, .0f,   -.5f, .5f, .0f };
+		const unsigned int quadIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+		const float cellSize = 2.0f / gridSize;
+		for (int y = 0; y < gridSize; y++)
+		{
+			for (int x = 0; x < gridSize; x++)
+			{
+				bool isQuad = (x + y) % 2 == 0;
+				const float* shape = isQuad ? quad : triangle;
+				int vertexCount = isQuad ? 4 : 3;
+
+				float positions[12];
+				for (int i = 0; i < vertexCount; i++)
+				{
+					positions[i * 3] = -1.0f + (x + 0.5f + shape[i * 3] * 0.8f) * cellSize;
+					positions[i * 3 + 1] = -1.0f + (y + 0.5f + shape[i * 3 + 1] * 0.8f) * cellSize;
+					positions[i * 3 + 2] = 0.0f;
+				}
+
+				float r = (float)x / gridSize, g = (float)y / gridSize;
+				if (isQuad) batch::add(meshes, positions, 4, quadIndices, 6, r, g, 0.5f);
+				else batch::add(meshes, positions, 3, triangleIndices, 3, r, g, 1.0f);
+			}
+		}
+
+		return batch::upload(meshes);
+	}
+
+	int initShaders() {
+		std::vector<std::string> defines = { shader_preprocessor::uberShaders() ? "UBER_SHADER" : "USE_VERTEX_COLOR" };
+		const std::string* vertexShaderSrc = shader_preprocessor::variant("basic.vert", defines);
+		const std::string* fragmentShaderSrc = shader_preprocessor::variant("basic.frag", defines);
+		if (vertexShaderSrc == NULL || fragmentShaderSrc == NULL) return -1;
+
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc->c_str(), fragmentShaderSrc->c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		useVertexColorHandle = uniform_table::getInt(uniformTable, "useVertexColor");
+		useTextureHandle = uniform_table::getInt(uniformTable, "useTexture");
+	}
+
+}
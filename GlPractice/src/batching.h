@@ -0,0 +1,22 @@
+#ifndef BATCHING_H
+#define BATCHING_H
+
+// A grid of thousands of small meshes with their own colors, all in one batch.
+// "batching" draws them with a single glMultiDrawElementsBaseVertex, "batching_per_draw" issues a draw call
+// per mesh from the same buffers, so the bench shows what the draw calls themselves cost.
+namespace batching {
+    // adds both versions of the demo to the scene registry
+    void registerScene();
+    int init();
+    // clears the screen and draws the meshes with one call
+    void render();
+    // same, with one draw call per mesh
+    void renderPerDraw();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initMeshes();
+}
+
+#endif
@@ -0,0 +1,701 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "bench.h"
+#include "scene.h"
+#include "scene_runner.h"
+#include "uniform_table.h"
+#include "program_cache.h"
+#include "shader_compiler.h"
+#include "stage_cache.h"
+#include "shader_preprocessor.h"
+#include "stream_buffer.h"
+#include "mesh_optimizer.h"
+#include "obj_loader.h"
+#include "mesh_file.h"
+#include "lod.h"
+#include "indirect_draw.h"
+#include "texture_loader.h"
+#include "texture_upload.h"
+#include "texture_compressor.h"
+#include "stb_image.h"
+
+// Drives the demos without their own render loops so every run is reproducible.
+// The window is never shown, everything is drawn into an offscreen framebuffer,
+// which means this also works on a software rasterizer like Mesa llvmpipe.
+namespace bench {
+
+	struct SceneResult {
+		std::string name;
+		double p50, p95, p99, max;
+		// time until the scene's programs are linked, mostly shader compilation
+		double initMs;
+		// time from there until its textures are decoded and uploaded
+		double texturesMs;
+		// what the textures take on the GPU once they are there, estimated by texture_loader
+		size_t textureBytes;
+		unsigned long long programCacheHits, programCacheMisses;
+		unsigned long long stageCompiles, stageReuses;
+		double drawCallsPerFrame;
+		double uniformLookupsAvoidedPerFrame;
+		double uniformUploadsSkippedPerFrame;
+		double streamBytesPerFrame;
+		// frames that had to wait for the GPU before writing into the stream buffer
+		unsigned long long streamFenceWaits;
+		// vertex cache of the meshes the scene optimized at init, 0 if it optimized none
+		double acmrBefore, acmrAfter;
+		double atvrBefore, atvrAfter;
+		// objects that changed their level of detail, per frame
+		double lodSwitchesPerFrame;
+		// draws submitted through glMultiDrawElementsIndirect, per frame
+		double indirectCommandsPerFrame;
+		// textures thrown out for the texture_loader budget and loaded again while the frames ran
+		unsigned long long textureEvictions, textureReloads;
+	};
+
+	// load times of one mesh, the best of meshLoadRuns runs
+	struct MeshLoadResult {
+		std::string path;
+		size_t objBytes, binaryBytes;
+		size_t vertices, triangles;
+		// parsing the OBJ and uploading what the loader returns
+		double objMs;
+		// parsing, optimizing, packing and writing the binary file
+		double convertMs;
+		// mapping the binary file and uploading it with glBufferData or through a mapped buffer
+		double bufferDataMs, mappedMs;
+		// whether parsing on one thread and on meshLoadThreads threads gave the same mesh
+		bool threadsMatch;
+	};
+
+	// upload bandwidth of one texture size, in MB/s
+	struct TextureUploadResult {
+		int size;
+		int uploads;
+		double directMBps, pboMBps, orphanMBps;
+		unsigned long long fenceWaits;
+	};
+
+	// one format at one quality setting of the compression benchmark
+	struct TextureCompressResult {
+		texture_compressor::Format format;
+		int quality;
+		double ms;
+		double psnr;
+		// the whole mip chain
+		size_t bytes;
+		// the worst of the checkers below, blocks with two colors the encoder has to find the axis of
+		double checkerPsnr;
+	};
+
+	// 8x8 checkers of two colors, red/green, red/blue and cyan/magenta vary along axes orthogonal to grey
+	const unsigned char textureCompressCheckers[][2][4] = {
+		{ { 255, 0, 0, 255 }, { 0, 255, 0, 255 } },
+		{ { 255, 0, 0, 255 }, { 0, 0, 255, 255 } },
+		{ { 0, 255, 255, 255 }, { 255, 0, 255, 255 } }
+	};
+
+	// the square RGBA8 textures the upload benchmark tries
+	const int textureUploadSizes[] = { 128, 512, 4096 };
+	// each size is uploaded until this many bytes went through, at least a few times
+	const size_t textureUploadBytes = 256 << 20;
+	const int minTextureUploads = 4;
+
+	int width = 800, height = 800;
+	int frameCount = 1000;
+	int warmupCount = 50;
+	const char* sceneFilter = NULL;
+	// runs every scene twice, with its specialized shader variants and with the uber-shader
+	bool compareVariants = false;
+
+	unsigned int FBO, colorRBO, depthStencilRBO;
+	std::vector<SceneResult> results;
+	// --mesh-load replaces the scenes with the mesh load benchmark
+	const char* meshLoadPath = NULL;
+	const int meshLoadRuns = 5;
+	// for the comparison with the single threaded parse, more than most machines have so every split is tested
+	const int meshLoadThreads = 16;
+	MeshLoadResult meshLoad;
+	// --texture-upload does the same for the texture upload benchmark
+	bool textureUpload = false;
+	std::vector<TextureUploadResult> textureUploads;
+	// --texture-compress compresses the image in every format at every quality instead
+	const char* textureCompressPath = NULL;
+	int textureCompressWidth, textureCompressHeight;
+	std::vector<TextureCompressResult> textureCompressions;
+
+	// Draw calls are counted by swapping the glad function pointers for wrappers, so the demos
+	// do not need to know they are being measured.
+	unsigned long long drawCalls = 0;
+	PFNGLDRAWARRAYSPROC realDrawArrays;
+	PFNGLDRAWELEMENTSPROC realDrawElements;
+	PFNGLDRAWELEMENTSBASEVERTEXPROC realDrawElementsBaseVertex;
+	PFNGLMULTIDRAWELEMENTSBASEVERTEXPROC realMultiDrawElementsBaseVertex;
+	PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced;
+	PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced;
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC realMultiDrawElementsIndirect;
+
+	void APIENTRY countingDrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		drawCalls++;
+		realDrawArrays(mode, first, count);
+	}
+
+	void APIENTRY countingDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		drawCalls++;
+		realDrawElements(mode, count, type, indices);
+	}
+
+	void APIENTRY countingDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+	{
+		drawCalls++;
+		realDrawElementsBaseVertex(mode, count, type, indices, basevertex);
+	}
+
+	// a multi-draw is one call, however many draws it contains
+	void APIENTRY countingMultiDrawElementsBaseVertex(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices,
+		GLsizei drawcount, const GLint* basevertex)
+	{
+		drawCalls++;
+		realMultiDrawElementsBaseVertex(mode, count, type, indices, drawcount, basevertex);
+	}
+
+	void APIENTRY countingDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+	{
+		drawCalls++;
+		realDrawArraysInstanced(mode, first, count, instancecount);
+	}
+
+	void APIENTRY countingDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+	{
+		drawCalls++;
+		realDrawElementsInstanced(mode, count, type, indices, instancecount);
+	}
+
+	void APIENTRY countingMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+	{
+		drawCalls++;
+		realMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+	}
+
+	void installDrawHooks()
+	{
+		realDrawArrays = glad_glDrawArrays;
+		realDrawElements = glad_glDrawElements;
+		glad_glDrawArrays = countingDrawArrays;
+		glad_glDrawElements = countingDrawElements;
+		realDrawElementsBaseVertex = glad_glDrawElementsBaseVertex;
+		realMultiDrawElementsBaseVertex = glad_glMultiDrawElementsBaseVertex;
+		glad_glDrawElementsBaseVertex = countingDrawElementsBaseVertex;
+		glad_glMultiDrawElementsBaseVertex = countingMultiDrawElementsBaseVertex;
+		realDrawArraysInstanced = glad_glDrawArraysInstanced;
+		realDrawElementsInstanced = glad_glDrawElementsInstanced;
+		glad_glDrawArraysInstanced = countingDrawArraysInstanced;
+		glad_glDrawElementsInstanced = countingDrawElementsInstanced;
+		// only there on GL 4.3, the scenes check for NULL to know whether they can use it
+		realMultiDrawElementsIndirect = glad_glMultiDrawElementsIndirect;
+		if (realMultiDrawElementsIndirect != NULL) glad_glMultiDrawElementsIndirect = countingMultiDrawElementsIndirect;
+	}
+
+	// nearest-rank percentile of an already sorted sample
+	double percentile(const std::vector<double>& sorted, double p)
+	{
+		size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+		if (rank == 0) rank = 1;
+		return sorted[rank - 1];
+	}
+
+	int main(int argc, char** argv) {
+		for (int i = 1; i < argc; i++)
+		{
+			if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frameCount = std::atoi(argv[++i]);
+			else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmupCount = std::atoi(argv[++i]);
+			else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) sceneFilter = argv[++i];
+			else if (std::strcmp(argv[i], "--no-program-cache") == 0) program_cache::setEnabled(false);
+			else if (std::strcmp(argv[i], "--uber-shaders") == 0) shader_preprocessor::setUberShaders(true);
+			else if (std::strcmp(argv[i], "--compare-variants") == 0) compareVariants = true;
+			else if (std::strcmp(argv[i], "--no-persistent-map") == 0) stream_buffer::setPersistentEnabled(false);
+			else if (std::strcmp(argv[i], "--mesh-load") == 0 && i + 1 < argc) meshLoadPath = argv[++i];
+			else if (std::strcmp(argv[i], "--texture-upload") == 0) textureUpload = true;
+			else if (std::strcmp(argv[i], "--texture-compress") == 0 && i + 1 < argc) textureCompressPath = argv[++i];
+			else
+			{
+				std::cout << "usage: glpractice_bench [--frames N] [--warmup N] [--scene NAME] [--no-program-cache] [--uber-shaders] [--compare-variants] [--no-persistent-map] [--mesh-load OBJ] [--texture-upload] [--texture-compress IMAGE]" << std::endl;
+				return -1;
+			}
+		}
+		if (frameCount < 1) frameCount = 1;
+		if (warmupCount < 0) warmupCount = 0;
+
+		scene::registerAll();
+		if (sceneFilter != NULL && scene::findScene(sceneFilter) == NULL)
+		{
+			std::cout << "ERROR::BENCH::UNKNOWN_SCENE " << sceneFilter << std::endl;
+			return -1;
+		}
+
+		// the context is created once and shared by every scene
+		if (initContext() != 0) return -1;
+		installDrawHooks();
+
+		if (meshLoadPath != NULL || textureUpload || textureCompressPath != NULL)
+		{
+			int result = meshLoadPath != NULL ? runMeshLoad(meshLoadPath) : 0;
+			if (result == 0 && textureUpload) result = runTextureUpload();
+			if (result == 0 && textureCompressPath != NULL) result = runTextureCompress(textureCompressPath);
+			if (result == 0) printResults();
+			runner::terminate();
+			return result;
+		}
+
+		for (int i = 0; i < scene::sceneCount(); i++)
+		{
+			if (sceneFilter != NULL && std::strcmp(sceneFilter, scene::sceneAt(i).name) != 0) continue;
+			if (compareVariants) shader_preprocessor::setUberShaders(false);
+			if (runScene(i) != 0 || (compareVariants && runUberScene(i) != 0))
+			{
+				runner::terminate();
+				return -1;
+			}
+		}
+
+		printResults();
+
+		runner::terminate();
+
+		return 0;
+	}
+
+	int runUberScene(int index)
+	{
+		shader_preprocessor::setUberShaders(true);
+		int result = runScene(index);
+		shader_preprocessor::setUberShaders(false);
+		return result;
+	}
+
+	int runScene(int index)
+	{
+		const scene::Scene& active = scene::sceneAt(index);
+
+		program_cache::resetStats();
+		stage_cache::resetStats();
+		mesh_optimizer::resetStats();
+		auto initStart = std::chrono::steady_clock::now();
+		if (runner::switchScene(index) != 0) return -1;
+		// init only submits the programs, the scene is not really started until they are linked
+		shader_compiler::waitAll();
+		// include the work the driver deferred from init
+		glFinish();
+		auto initEnd = std::chrono::steady_clock::now();
+		// the textures stream in while the scene is running, the frames are measured once they are all there
+		texture_loader::waitAll();
+		auto texturesEnd = std::chrono::steady_clock::now();
+		size_t textureBytes = texture_loader::residentBytes();
+		program_cache::Stats cacheStats = program_cache::getStats();
+		stage_cache::Stats stageStats = stage_cache::getStats();
+
+		std::vector<double> frameTimes;
+		frameTimes.reserve(frameCount);
+		drawCalls = 0;
+
+		for (int frame = 0; frame < warmupCount + frameCount; frame++)
+		{
+			if (frame == warmupCount)
+			{
+				drawCalls = 0;
+				uniform_table::resetStats();
+				stream_buffer::resetStats();
+				lod::resetStats();
+				indirect_draw::resetStats();
+				texture_loader::resetStats();
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			// like the runner's loop, this is where textures that were evicted and bound again come back
+			texture_loader::update();
+			// fixed time step, so animated scenes draw the same frames on every run
+			if (active.update != NULL) active.update(frame / 60.0);
+			active.render();
+			// wait for the driver, otherwise we would only measure how fast commands get queued
+			// (on llvmpipe the rasterization itself happens on CPU threads)
+			glFinish();
+			auto end = std::chrono::steady_clock::now();
+
+			if (frame >= warmupCount)
+			{
+				frameTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+
+			glfwPollEvents();
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		SceneResult result;
+		result.name = active.name;
+		// scenes that do not use the shader files draw the same in both modes
+		if (shader_preprocessor::uberShaders()) result.name += "/uber";
+		result.initMs = std::chrono::duration<double, std::milli>(initEnd - initStart).count();
+		result.texturesMs = std::chrono::duration<double, std::milli>(texturesEnd - initEnd).count();
+		result.textureBytes = textureBytes;
+		result.programCacheHits = cacheStats.hits;
+		result.programCacheMisses = cacheStats.misses;
+		result.stageCompiles = stageStats.compiles;
+		result.stageReuses = stageStats.reuses;
+		result.p50 = percentile(frameTimes, 50.0);
+		result.p95 = percentile(frameTimes, 95.0);
+		result.p99 = percentile(frameTimes, 99.0);
+		result.max = frameTimes.back();
+		result.drawCallsPerFrame = (double)drawCalls / frameCount;
+		const uniform_table::Stats& uniformStats = uniform_table::getStats();
+		result.uniformLookupsAvoidedPerFrame = (double)uniformStats.lookupsAvoided / frameCount;
+		result.uniformUploadsSkippedPerFrame = (double)uniformStats.uploadsSkipped / frameCount;
+		const stream_buffer::Stats& streamStats = stream_buffer::getStats();
+		result.streamBytesPerFrame = (double)streamStats.bytes / frameCount;
+		result.streamFenceWaits = streamStats.fenceWaits;
+		const mesh_optimizer::Stats& meshStats = mesh_optimizer::getStats();
+		result.acmrBefore = meshStats.triangles > 0 ? (double)meshStats.missesBefore / meshStats.triangles : 0.0;
+		result.acmrAfter = meshStats.triangles > 0 ? (double)meshStats.missesAfter / meshStats.triangles : 0.0;
+		result.atvrBefore = meshStats.vertices > 0 ? (double)meshStats.missesBefore / meshStats.vertices : 0.0;
+		result.atvrAfter = meshStats.vertices > 0 ? (double)meshStats.missesAfter / meshStats.vertices : 0.0;
+		result.lodSwitchesPerFrame = (double)lod::getStats().switches / frameCount;
+		result.indirectCommandsPerFrame = (double)indirect_draw::getStats().commands / frameCount;
+		result.textureEvictions = texture_loader::getStats().evictions;
+		result.textureReloads = texture_loader::getStats().reloads;
+		results.push_back(result);
+
+		runner::stopScene();
+
+		return 0;
+	}
+
+	double elapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// uploads the mapped binary mesh, returns how long it took until the GPU had it
+	double timeBinaryLoad(const char* path, mesh_file::UploadMode mode)
+	{
+		auto start = std::chrono::steady_clock::now();
+		mesh_file::Mesh mesh;
+		if (mesh_file::open(mesh, path) != 0) return -1.0;
+		unsigned int VAO, VBO, EBO;
+		mesh_file::upload(mesh, VAO, VBO, EBO, mode);
+		mesh_file::close(mesh);
+		glFinish();
+		double ms = elapsedMs(start);
+
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		return ms;
+	}
+
+	bool sameMesh(const obj_loader::Mesh& a, const obj_loader::Mesh& b)
+	{
+		if (a.vertices != b.vertices || a.indices != b.indices || a.vertexCount != b.vertexCount) return false;
+		if (a.submeshes.size() != b.submeshes.size() || a.materials.size() != b.materials.size()) return false;
+		for (size_t i = 0; i < a.submeshes.size(); i++)
+		{
+			const obj_loader::Submesh& x = a.submeshes[i];
+			const obj_loader::Submesh& y = b.submeshes[i];
+			if (x.firstIndex != y.firstIndex || x.indexCount != y.indexCount || x.material != y.material) return false;
+		}
+		for (size_t i = 0; i < a.materials.size(); i++)
+		{
+			if (a.materials[i].name != b.materials[i].name) return false;
+		}
+		return true;
+	}
+
+	int runMeshLoad(const char* path)
+	{
+		// converts the OBJ if the cache has no binary of it yet, which also creates the cache directory
+		mesh_file::Mesh mesh;
+		if (mesh_file::openObj(mesh, path) != 0) return -1;
+		std::string binaryPath = mesh_file::cachePath(path);
+		meshLoad = {};
+		meshLoad.path = path;
+		meshLoad.binaryBytes = mesh.file.size;
+		meshLoad.vertices = (size_t)mesh.header->vertexCount;
+		meshLoad.triangles = (size_t)(mesh.header->indexCount / 3);
+		mesh_file::close(mesh);
+
+		// every step is run a few times, the file is in the page cache after the first one either way
+		meshLoad.objMs = meshLoad.convertMs = meshLoad.bufferDataMs = meshLoad.mappedMs = 1e30;
+		for (int run = 0; run < meshLoadRuns; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			obj_loader::Mesh source;
+			if (obj_loader::load(source, path) != 0) return -1;
+			unsigned int buffers[2];
+			glGenBuffers(2, buffers);
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+			glBufferData(GL_ARRAY_BUFFER, source.vertices.size() * sizeof(float), source.vertices.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+			glBufferData(GL_ARRAY_BUFFER, source.indices.size() * sizeof(unsigned int), source.indices.data(), GL_STATIC_DRAW);
+			glFinish();
+			meshLoad.objMs = std::min(meshLoad.objMs, elapsedMs(start));
+			meshLoad.objBytes = obj_loader::getStats().bytes;
+			glDeleteBuffers(2, buffers);
+
+			start = std::chrono::steady_clock::now();
+			if (mesh_file::convertObj(path, binaryPath.c_str()) != 0) return -1;
+			meshLoad.convertMs = std::min(meshLoad.convertMs, elapsedMs(start));
+
+			double bufferDataMs = timeBinaryLoad(binaryPath.c_str(), mesh_file::UPLOAD_BUFFER_DATA);
+			double mappedMs = timeBinaryLoad(binaryPath.c_str(), mesh_file::UPLOAD_MAPPED);
+			if (bufferDataMs < 0.0 || mappedMs < 0.0) return -1;
+			meshLoad.bufferDataMs = std::min(meshLoad.bufferDataMs, bufferDataMs);
+			meshLoad.mappedMs = std::min(meshLoad.mappedMs, mappedMs);
+		}
+
+		// the chunks are parsed on their own threads, what they return has to match a parse in one piece
+		obj_loader::Mesh single, threaded;
+		if (obj_loader::load(single, path, 1) != 0 || obj_loader::load(threaded, path, meshLoadThreads) != 0) return -1;
+		meshLoad.threadsMatch = sameMesh(single, threaded);
+		if (!meshLoad.threadsMatch) std::cout << "ERROR::BENCH::MESH_THREADS_MISMATCH " << path << std::endl;
+		return 0;
+	}
+
+	// MB/s of uploading the pixels into the texture count times in the mode, the first upload is not counted
+	double timeTextureUpload(unsigned int texture, int size, const std::vector<unsigned char>& pixels, int count, texture_upload::UploadMode mode)
+	{
+		texture_upload::setMode(mode);
+		texture_upload::upload(texture, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data(), pixels.size());
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < count; i++)
+		{
+			texture_upload::upload(texture, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data(), pixels.size());
+		}
+		// the PBO uploads return before the copies are done
+		glFinish();
+		double ms = elapsedMs(start);
+		return (double)pixels.size() * count / (1024.0 * 1024.0) / (ms / 1000.0);
+	}
+
+	int runTextureUpload()
+	{
+		texture_upload::UploadMode previousMode = texture_upload::getMode();
+		textureUploads.clear();
+		for (int size : textureUploadSizes)
+		{
+			std::vector<unsigned char> pixels((size_t)size * size * 4);
+			for (size_t i = 0; i < pixels.size(); i++) pixels[i] = (unsigned char)(i * 7 + (i >> 12));
+			unsigned int texture;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			TextureUploadResult result = {};
+			result.size = size;
+			result.uploads = (int)std::max((size_t)minTextureUploads, textureUploadBytes / pixels.size());
+			texture_upload::resetStats();
+			result.directMBps = timeTextureUpload(texture, size, pixels, result.uploads, texture_upload::UPLOAD_DIRECT);
+			result.pboMBps = timeTextureUpload(texture, size, pixels, result.uploads, texture_upload::UPLOAD_PBO);
+			result.orphanMBps = timeTextureUpload(texture, size, pixels, result.uploads, texture_upload::UPLOAD_PBO_ORPHAN);
+			result.fenceWaits = texture_upload::getStats().fenceWaits;
+			textureUploads.push_back(result);
+			glDeleteTextures(1, &texture);
+		}
+		texture_upload::setMode(previousMode);
+		return 0;
+	}
+
+	int runTextureCompress(const char* path)
+	{
+		int channels;
+		unsigned char* rgba = stbi_load(path, &textureCompressWidth, &textureCompressHeight, &channels, 4);
+		if (rgba == NULL)
+		{
+			std::cout << "ERROR::BENCH::CANT_LOAD_IMAGE " << path << std::endl;
+			return -1;
+		}
+		textureCompressions.clear();
+		for (int format = texture_compressor::FORMAT_BC1; format < texture_compressor::FORMAT_COUNT; format++)
+		{
+			int previousQuality = texture_compressor::getQuality((texture_compressor::Format)format);
+			for (int quality = 0; quality <= texture_compressor::MAX_QUALITY; quality++)
+			{
+				TextureCompressResult result = {};
+				result.format = (texture_compressor::Format)format;
+				result.quality = quality;
+				texture_compressor::setQuality(result.format, quality);
+				texture_compressor::Image image;
+				auto start = std::chrono::steady_clock::now();
+				if (texture_compressor::compress(image, rgba, textureCompressWidth, textureCompressHeight, result.format) != 0)
+				{
+					stbi_image_free(rgba);
+					return -1;
+				}
+				result.ms = elapsedMs(start);
+				result.psnr = image.psnr;
+				result.bytes = image.data.size();
+				result.checkerPsnr = 100.0;
+				for (const auto& colors : textureCompressCheckers)
+				{
+					unsigned char checker[8 * 8 * 4];
+					for (int i = 0; i < 8 * 8; i++) std::memcpy(&checker[i * 4], colors[(i % 8 + i / 8) % 2], 4);
+					texture_compressor::Image checkerImage;
+					if (texture_compressor::compress(checkerImage, checker, 8, 8, result.format, 1) != 0)
+					{
+						stbi_image_free(rgba);
+						return -1;
+					}
+					result.checkerPsnr = std::min(result.checkerPsnr, checkerImage.psnr);
+				}
+				textureCompressions.push_back(result);
+			}
+			texture_compressor::setQuality((texture_compressor::Format)format, previousQuality);
+		}
+		stbi_image_free(rgba);
+		return 0;
+	}
+
+	void printResults()
+	{
+		std::cout << "{\n";
+		std::cout << "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n";
+		std::cout << "  \"persistent_map\": " << (stream_buffer::persistentSupported() ? "true" : "false") << ",\n";
+		std::cout << "  \"parallel_shader_compile\": " << (shader_compiler::parallelSupported() ? "true" : "false") << ",\n";
+		std::cout << "  \"width\": " << width << ",\n";
+		std::cout << "  \"height\": " << height << ",\n";
+		std::cout << "  \"frames\": " << frameCount << ",\n";
+		std::cout << "  \"warmup\": " << warmupCount << ",\n";
+		if (meshLoadPath != NULL)
+		{
+			std::cout << "  \"mesh_load\": { \"path\": \"" << meshLoad.path << "\""
+				<< ", \"runs\": " << meshLoadRuns
+				<< ", \"obj_bytes\": " << meshLoad.objBytes
+				<< ", \"binary_bytes\": " << meshLoad.binaryBytes
+				<< ", \"vertices\": " << meshLoad.vertices
+				<< ", \"triangles\": " << meshLoad.triangles
+				<< ", \"obj_ms\": " << meshLoad.objMs
+				<< ", \"convert_ms\": " << meshLoad.convertMs
+				<< ", \"binary_buffer_data_ms\": " << meshLoad.bufferDataMs
+				<< ", \"binary_mapped_ms\": " << meshLoad.mappedMs
+				<< ", \"threads_match\": " << (meshLoad.threadsMatch ? "true" : "false")
+				<< " },\n";
+		}
+		if (textureUpload)
+		{
+			std::cout << "  \"texture_upload\": [\n";
+			for (size_t i = 0; i < textureUploads.size(); i++)
+			{
+				const TextureUploadResult& r = textureUploads[i];
+				std::cout << "    { \"size\": " << r.size
+					<< ", \"uploads\": " << r.uploads
+					<< ", \"direct_mbps\": " << r.directMBps
+					<< ", \"pbo_mbps\": " << r.pboMBps
+					<< ", \"orphan_mbps\": " << r.orphanMBps
+					<< ", \"fence_waits\": " << r.fenceWaits
+					<< " }" << (i + 1 < textureUploads.size() ? "," : "") << "\n";
+			}
+			std::cout << "  ],\n";
+		}
+		if (textureCompressPath != NULL)
+		{
+			// RGBA8 with mipmaps, what the image takes uncompressed
+			size_t rgbaBytes = 0;
+			for (int w = textureCompressWidth, h = textureCompressHeight; ; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+			{
+				rgbaBytes += (size_t)w * h * 4;
+				if (w == 1 && h == 1) break;
+			}
+			std::cout << "  \"texture_compress\": { \"path\": \"" << textureCompressPath << "\""
+				<< ", \"width\": " << textureCompressWidth
+				<< ", \"height\": " << textureCompressHeight
+				<< ", \"rgba_bytes\": " << rgbaBytes
+				<< ", \"formats\": [\n";
+			for (size_t i = 0; i < textureCompressions.size(); i++)
+			{
+				const TextureCompressResult& r = textureCompressions[i];
+				std::cout << "    { \"format\": \"" << texture_compressor::name(r.format) << "\""
+					<< ", \"quality\": " << r.quality
+					<< ", \"supported\": " << (texture_compressor::supported(r.format) ? "true" : "false")
+					<< ", \"ms\": " << r.ms
+					<< ", \"psnr_db\": " << r.psnr
+					<< ", \"checker_psnr_db\": " << r.checkerPsnr
+					<< ", \"bytes\": " << r.bytes
+					<< " }" << (i + 1 < textureCompressions.size() ? "," : "") << "\n";
+			}
+			std::cout << "  ] },\n";
+		}
+		std::cout << "  \"scenes\": [\n";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const SceneResult& r = results[i];
+			std::cout << "    { \"name\": \"" << r.name << "\""
+				<< ", \"init_ms\": " << r.initMs
+				<< ", \"textures_ms\": " << r.texturesMs
+				<< ", \"texture_bytes\": " << r.textureBytes
+				<< ", \"program_cache_hits\": " << r.programCacheHits
+				<< ", \"program_cache_misses\": " << r.programCacheMisses
+				<< ", \"stage_compiles\": " << r.stageCompiles
+				<< ", \"stage_reuses\": " << r.stageReuses
+				<< ", \"p50_ms\": " << r.p50
+				<< ", \"p95_ms\": " << r.p95
+				<< ", \"p99_ms\": " << r.p99
+				<< ", \"max_ms\": " << r.max
+				<< ", \"draw_calls_per_frame\": " << r.drawCallsPerFrame
+				<< ", \"uniform_lookups_avoided_per_frame\": " << r.uniformLookupsAvoidedPerFrame
+				<< ", \"uniform_uploads_skipped_per_frame\": " << r.uniformUploadsSkippedPerFrame
+				<< ", \"stream_bytes_per_frame\": " << r.streamBytesPerFrame
+				<< ", \"stream_fence_waits\": " << r.streamFenceWaits
+				<< ", \"acmr_before\": " << r.acmrBefore
+				<< ", \"acmr_after\": " << r.acmrAfter
+				<< ", \"atvr_before\": " << r.atvrBefore
+				<< ", \"atvr_after\": " << r.atvrAfter
+				<< ", \"lod_switches_per_frame\": " << r.lodSwitchesPerFrame
+				<< ", \"indirect_commands_per_frame\": " << r.indirectCommandsPerFrame
+				<< ", \"texture_evictions\": " << r.textureEvictions
+				<< ", \"texture_reloads\": " << r.textureReloads
+				<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		std::cout << "  ]\n";
+		std::cout << "}" << std::endl;
+	}
+
+	int initContext() {
+		// never show the window, we only need it for the context
+		if (runner::initContext(width, height, false) != 0) return -1;
+		// no vsync, it would cap every frame to the refresh rate
+		glfwSwapInterval(0);
+
+		// the default framebuffer of a hidden window is not guaranteed to be rendered,
+		// so draw into our own color buffer instead, with a depth buffer like the window has or the depth test does nothing
+		glGenFramebuffers(1, &FBO);
+		glGenRenderbuffers(1, &colorRBO);
+		glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glGenRenderbuffers(1, &depthStencilRBO);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthStencilRBO);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRBO);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE" << std::endl;
+			runner::terminate();
+			return -1;
+		}
+
+		glViewport(0, 0, width, height);
+
+		return 0;
+	}
+
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Headless benchmark that drives every demo for a fixed number of frames
+// and prints frame-time percentiles as JSON.
+namespace bench {
+    int main(int argc, char** argv);
+    // creates a hidden window and an offscreen framebuffer to render into
+    int initContext();
+    // runs the registered scene at index and appends its JSON entry to the output
+    int runScene(int index);
+    // runs the scene again with the uber-shader variants, the result is named "<scene>/uber"
+    int runUberScene(int index);
+    // times loading the OBJ as text against loading its binary mesh file, replaces the scenes
+    int runMeshLoad(const char* path);
+    // measures the texture upload bandwidth directly, through the staging buffers and through orphaned ones
+    int runTextureUpload();
+    // compresses the image in every block format at every quality, with the time, the PSNR and the size,
+    // and the worst PSNR of a few two color checkers
+    int runTextureCompress(const char* path);
+    void printResults();
+}
+
+#endif
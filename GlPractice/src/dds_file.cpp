@@ -0,0 +1,165 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include "dds_file.h"
+
+namespace dds_file {
+
+	struct PixelFormat {
+		unsigned int size;
+		unsigned int flags;
+		unsigned int fourCC;
+		unsigned int rgbBitCount;
+		unsigned int masks[4];
+	};
+
+	struct Header {
+		unsigned int size;
+		unsigned int flags;
+		unsigned int height;
+		unsigned int width;
+		unsigned int pitchOrLinearSize;
+		unsigned int depth;
+		unsigned int mipMapCount;
+		unsigned int reserved1[11];
+		PixelFormat pixelFormat;
+		unsigned int caps[4];
+		unsigned int reserved2;
+	};
+
+	struct HeaderDX10 {
+		unsigned int dxgiFormat;
+		unsigned int resourceDimension;
+		unsigned int miscFlag;
+		unsigned int arraySize;
+		unsigned int miscFlags2;
+	};
+
+	// "DDS " and "DX10" in little endian
+	const unsigned int fileMagic = 0x20534444;
+	const unsigned int dx10FourCC = 0x30315844;
+	// "GLPT", in reserved1[0] of the files we wrote
+	const unsigned int keyMagic = 0x54504c47;
+
+	const unsigned int DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+	const unsigned int DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	const unsigned int DDPF_FOURCC = 0x4;
+	const unsigned int DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+	const unsigned int DIMENSION_TEXTURE2D = 3;
+
+	// DXGI_FORMAT_BC1_UNORM and so on, by texture_compressor::Format
+	const unsigned int dxgiFormats[] = { 0, 71, 77, 80, 83, 98 };
+
+	int write(const char* path, const texture_compressor::Image& image, unsigned long long key)
+	{
+		Header header = {};
+		header.size = sizeof(Header);
+		header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+		header.height = image.height;
+		header.width = image.width;
+		header.pitchOrLinearSize = (unsigned int)image.levels[0].size;
+		header.mipMapCount = (unsigned int)image.levels.size();
+		header.reserved1[0] = keyMagic;
+		header.reserved1[1] = (unsigned int)key;
+		header.reserved1[2] = (unsigned int)(key >> 32);
+		header.pixelFormat.size = sizeof(PixelFormat);
+		header.pixelFormat.flags = DDPF_FOURCC;
+		header.pixelFormat.fourCC = dx10FourCC;
+		header.caps[0] = DDSCAPS_COMPLEX | DDSCAPS_TEXTURE | DDSCAPS_MIPMAP;
+
+		HeaderDX10 dx10 = {};
+		dx10.dxgiFormat = dxgiFormats[image.format];
+		dx10.resourceDimension = DIMENSION_TEXTURE2D;
+		dx10.arraySize = 1;
+
+		std::string tempPath = std::string(path) + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&fileMagic, sizeof(fileMagic));
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)&dx10, sizeof(dx10));
+			file.write((const char*)image.data.data(), image.data.size());
+			if (!file)
+			{
+				std::cout << "ERROR::DDS_FILE::CANT_WRITE " << path << std::endl;
+				return -1;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+		{
+			std::cout << "ERROR::DDS_FILE::CANT_WRITE " << path << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	int read(const char* path, texture_compressor::Image& image, unsigned long long key)
+	{
+		image = {};
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) return -1;
+		size_t fileSize = (size_t)file.tellg();
+		file.seekg(0);
+
+		unsigned int magic;
+		Header header;
+		HeaderDX10 dx10;
+		if (!file.read((char*)&magic, sizeof(magic)) || !file.read((char*)&header, sizeof(header))
+			|| magic != fileMagic || header.size != sizeof(Header) || header.pixelFormat.fourCC != dx10FourCC
+			|| !file.read((char*)&dx10, sizeof(dx10)))
+		{
+			std::cout << "ERROR::DDS_FILE::INVALID " << path << std::endl;
+			return -1;
+		}
+		// written by someone else, or for other pixels
+		unsigned long long fileKey = header.reserved1[1] | ((unsigned long long)header.reserved1[2] << 32);
+		if (header.reserved1[0] != keyMagic || fileKey != key) return -1;
+
+		int format = 0;
+		for (int i = 1; i < texture_compressor::FORMAT_COUNT; i++)
+		{
+			if (dxgiFormats[i] == dx10.dxgiFormat) format = i;
+		}
+		if (format == 0 || header.width == 0 || header.height == 0)
+		{
+			std::cout << "ERROR::DDS_FILE::UNSUPPORTED_FORMAT " << path << std::endl;
+			return -1;
+		}
+
+		image.format = (texture_compressor::Format)format;
+		image.width = (int)header.width;
+		image.height = (int)header.height;
+		size_t blockSize = texture_compressor::blockSize(image.format);
+		size_t size = 0;
+		int width = image.width, height = image.height;
+		for (unsigned int i = 0; i < (header.mipMapCount > 0 ? header.mipMapCount : 1); i++)
+		{
+			texture_compressor::Level level = { width, height, size, (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockSize };
+			image.levels.push_back(level);
+			size += level.size;
+			if (width == 1 && height == 1) break;
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+
+		size_t dataOffset = sizeof(magic) + sizeof(header) + sizeof(dx10);
+		if (fileSize < dataOffset || fileSize - dataOffset < size)
+		{
+			std::cout << "ERROR::DDS_FILE::INVALID " << path << std::endl;
+			image = {};
+			return -1;
+		}
+		image.data.resize(size);
+		if (!file.read((char*)image.data.data(), size))
+		{
+			image = {};
+			return -1;
+		}
+		return 0;
+	}
+
+}
@@ -0,0 +1,24 @@
+#ifndef DDS_FILE_H
+#define DDS_FILE_H
+
+#include "texture_compressor.h"
+
+// DirectDraw Surface files with the DX10 header extension, the container for block compressed textures
+// that every texture tool reads. texture_loader keeps the compressed mip chain of a source image next to
+// it (wall.jpg -> wall.jpg.bc1.dds), so the encoder only runs the first time.
+//
+//   "DDS "           magic
+//   DDS_HEADER       124 bytes, size and mip count, the pixel format only says "DX10"
+//   DDS_HEADER_DXT10 20 bytes, the DXGI format
+//   blocks           every mip level, the finest first, tightly packed
+//
+// The header has eleven reserved words, the cache key goes into three of them (a magic and the 64 bit
+// key), so a file written for other source pixels or other encoder settings reads as missing.
+namespace dds_file {
+    // writes the image, through a temporary file so there is never half a texture under the real name
+    int write(const char* path, const texture_compressor::Image& image, unsigned long long key);
+    // reads the file, returns -1 if it is missing, broken or written for another key
+    int read(const char* path, texture_compressor::Image& image, unsigned long long key);
+}
+
+#endif
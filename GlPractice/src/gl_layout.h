@@ -0,0 +1,201 @@
+#ifndef GL_LAYOUT_H
+#define GL_LAYOUT_H
+
+#include <cstddef>
+#include <string>
+#include <initializer_list>
+
+// Compile-time description of GLSL std140 / std430 blocks.
+// A block is listed as its member types, the offsets GLSL will use for them are computed with constexpr,
+// so they can be checked against the C++ struct that is copied into the buffer:
+//
+//     struct DrawBlock { gl_layout::Vec4 color; gl_layout::Mat4 transform; };
+//     typedef gl_layout::Block<gl_layout::Std140, gl_layout::Vec4, gl_layout::Mat4> DrawBlockLayout;
+//     static_assert(gl_layout::matches<DrawBlockLayout, DrawBlock>({
+//         GL_LAYOUT_FIELD(DrawBlock, color), GL_LAYOUT_FIELD(DrawBlock, transform) }), "DrawBlock is not std140");
+//
+// and the GLSL declaration is generated from the same description: DrawBlockLayout::glsl("DrawBlock", { "color", "transform" }).
+// Member types: float, int, unsigned int, Vec2, Vec3, Vec4, IVec4, Mat3, Mat4 and one dimensional arrays of them (T[N]).
+namespace gl_layout {
+    // C++ storage of the vector and matrix types, the matrices are column-major like in GLSL
+    struct Vec2 { float x, y; };
+    struct Vec3 { float x, y, z; };
+    struct Vec4 { float x, y, z, w; };
+    struct IVec4 { int x, y, z, w; };
+    // the columns of a mat3 are 16 bytes apart in both layouts, so the 4th float of every column is padding
+    struct Mat3 { float m[12]; };
+    struct Mat4 { float m[16]; };
+
+    // Element of a std140 array. Every array element starts at a multiple of 16 in std140, so an array of
+    // floats in C++ has to be an array of these (std430 arrays of scalars and vec2s are tightly packed).
+    template <typename T>
+    struct alignas(16) Std140Element { T value; };
+
+    // what GLSL sees of a type: rows x columns floats (or ints), count > 0 for arrays
+    template <typename T> struct Type;
+    template <> struct Type<float> { static constexpr size_t rows = 1, columns = 1, count = 0; static constexpr const char* glsl = "float"; };
+    template <> struct Type<int> { static constexpr size_t rows = 1, columns = 1, count = 0; static constexpr const char* glsl = "int"; };
+    template <> struct Type<unsigned int> { static constexpr size_t rows = 1, columns = 1, count = 0; static constexpr const char* glsl = "uint"; };
+    template <> struct Type<Vec2> { static constexpr size_t rows = 2, columns = 1, count = 0; static constexpr const char* glsl = "vec2"; };
+    template <> struct Type<Vec3> { static constexpr size_t rows = 3, columns = 1, count = 0; static constexpr const char* glsl = "vec3"; };
+    template <> struct Type<Vec4> { static constexpr size_t rows = 4, columns = 1, count = 0; static constexpr const char* glsl = "vec4"; };
+    template <> struct Type<IVec4> { static constexpr size_t rows = 4, columns = 1, count = 0; static constexpr const char* glsl = "ivec4"; };
+    template <> struct Type<Mat3> { static constexpr size_t rows = 3, columns = 3, count = 0; static constexpr const char* glsl = "mat3"; };
+    template <> struct Type<Mat4> { static constexpr size_t rows = 4, columns = 4, count = 0; static constexpr const char* glsl = "mat4"; };
+    template <typename T, size_t N> struct Type<T[N]> {
+        static_assert(Type<T>::count == 0, "arrays of arrays are not supported");
+        static constexpr size_t rows = Type<T>::rows, columns = Type<T>::columns, count = N;
+        static constexpr const char* glsl = Type<T>::glsl;
+    };
+
+    constexpr size_t roundUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // The two sets of rules only differ in one thing: std140 rounds the alignment of arrays (and so of
+    // matrix columns) and structs up to 16 bytes, std430 does not.
+    template <bool RoundTo16>
+    struct Rules {
+        static constexpr bool std140 = RoundTo16;
+
+        static constexpr size_t vectorAlign(size_t rows)
+        {
+            // a vec3 is aligned like a vec4
+            return rows == 1 ? 4 : rows == 2 ? 8 : 16;
+        }
+        static constexpr size_t arrayAlign(size_t elementAlign)
+        {
+            return RoundTo16 ? roundUp(elementAlign, 16) : elementAlign;
+        }
+
+        // base alignment and size of a single (non-array) value
+        template <typename T>
+        static constexpr size_t elementAlign()
+        {
+            // a matrix is stored like an array of its column vectors
+            return Type<T>::columns == 1 ? vectorAlign(Type<T>::rows) : arrayAlign(vectorAlign(Type<T>::rows));
+        }
+        template <typename T>
+        static constexpr size_t elementSize()
+        {
+            return Type<T>::columns == 1 ? Type<T>::rows * 4
+                : Type<T>::columns * roundUp(Type<T>::rows * 4, elementAlign<T>());
+        }
+
+        template <typename T>
+        static constexpr size_t align()
+        {
+            return Type<T>::count == 0 ? elementAlign<T>() : arrayAlign(elementAlign<T>());
+        }
+        // distance of two array elements
+        template <typename T>
+        static constexpr size_t stride()
+        {
+            return roundUp(elementSize<T>(), align<T>());
+        }
+        template <typename T>
+        static constexpr size_t size()
+        {
+            return Type<T>::count == 0 ? elementSize<T>() : Type<T>::count * stride<T>();
+        }
+    };
+
+    typedef Rules<true> Std140;
+    typedef Rules<false> Std430;
+
+    // offset and size of a member of the C++ struct, see GL_LAYOUT_FIELD
+    struct Field {
+        size_t offset;
+        size_t size;
+    };
+
+    template <typename Layout, typename... Members>
+    struct Block {
+        static_assert(sizeof...(Members) > 0, "a block needs at least one member");
+        static constexpr size_t count = sizeof...(Members);
+
+        static constexpr size_t offset(size_t index)
+        {
+            const size_t aligns[] = { Layout::template align<Members>()... };
+            const size_t sizes[] = { Layout::template size<Members>()... };
+            size_t current = 0;
+            for (size_t i = 0; i <= index && i < count; i++)
+            {
+                current = roundUp(current, aligns[i]);
+                if (i == index) break;
+                current += sizes[i];
+            }
+            return current;
+        }
+
+        static constexpr size_t memberSize(size_t index)
+        {
+            const size_t sizes[] = { Layout::template size<Members>()... };
+            return sizes[index];
+        }
+
+        // the block itself is aligned like a struct of its members, its size is rounded up to that
+        static constexpr size_t align()
+        {
+            const size_t aligns[] = { Layout::template align<Members>()... };
+            size_t largest = 4;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (aligns[i] > largest) largest = aligns[i];
+            }
+            return Layout::std140 ? roundUp(largest, 16) : largest;
+        }
+
+        static constexpr size_t size()
+        {
+            return roundUp(offset(count - 1) + memberSize(count - 1), align());
+        }
+
+        // The GLSL declaration of the block, an std140 block is a uniform block, an std430 one a shader
+        // storage block. names has one name for every member.
+        static std::string glsl(const char* blockName, std::initializer_list<const char*> names)
+        {
+            const char* types[] = { Type<Members>::glsl... };
+            const size_t counts[] = { Type<Members>::count... };
+
+            std::string source = Layout::std140 ? "layout (std140) uniform " : "layout (std430) buffer ";
+            source += blockName;
+            source += "\n{\n";
+            size_t i = 0;
+            for (const char* name : names)
+            {
+                if (i >= count) break;
+                source += "    ";
+                source += types[i];
+                source += " ";
+                source += name;
+                if (counts[i] > 0) source += "[" + std::to_string(counts[i]) + "]";
+                source += ";\n";
+                i++;
+            }
+            source += "};\n";
+            return source;
+        }
+    };
+
+    // True if every field sits where GLSL expects the member and has its size, and the struct is as
+    // big as the block. Meant for static_assert, the fields are listed in the order of the members.
+    template <typename Block, typename Struct>
+    constexpr bool matches(std::initializer_list<Field> fields)
+    {
+        if (fields.size() != Block::count || sizeof(Struct) != Block::size()) return false;
+        size_t i = 0;
+        for (const Field& field : fields)
+        {
+            if (field.offset != Block::offset(i) || field.size != Block::memberSize(i)) return false;
+            i++;
+        }
+        return true;
+    }
+}
+
+// the Field of a member, for gl_layout::matches
+#define GL_LAYOUT_FIELD(Struct, member) gl_layout::Field{ offsetof(Struct, member), sizeof(Struct::member) }
+
+#endif
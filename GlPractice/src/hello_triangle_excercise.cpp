@@ -2,89 +2,82 @@
 
 #include <iostream>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include "hello_triangle_excercise.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "batch.h"
 
 namespace hello_triangle {
 
-	GLFWwindow* window;
-	// hint: could just attach and detach the yellow and orange shaders
-	unsigned int yellowShaderProgram, orangeShaderProgram;
-	unsigned int orangeVAO, yellowVAO;
+	// The exercise is two triangles in two colors. They used to have a VAO, a VBO and a program each,
+	// which is two program switches and two draw calls for two triangles. Now the color is a vertex attribute,
+	// so both triangles go into one batch and are drawn with the same program in one call.
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	batch::Batch triangles;
 
 	const char* vertexShaderSrc = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+out vec3 vtxColor;
 
 void main()
 {
     gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);
+    vtxColor = aColor;
 }
 )";
-	const char* orangeFragmentShaderSrc = R"(
+	const char* fragmentShaderSrc = R"(
 #version 330 core
-out vec4 FragColor;
+in vec3 vtxColor;
 
-void main()
-{
-    FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);
-}
-)";
-	const char* yellowFragmentShaderSrc = R"(
-#version 330 core
 out vec4 FragColor;
 
 void main()
 {
-    FragColor = vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    FragColor = vec4(vtxColor, 1.0f);
 }
 )";
 
-	int main() {
-		// 1. create a window, initialize OpenGL
-		if (initContext() != 0) return -1;
-		// 2. black background color
+	void registerScene()
+	{
+		scene::registerScene({ "hello_triangle", init, NULL, render, shutdown });
+	}
+
+	int init() {
+		// 1. initialize shaders
+		if (initShaders() != 0) return -1;
+		// 2. create two triangles
+		return initVAOs();
+	}
+
+	void render()
+	{
+		// black background color
 		glClearColor(.0f, .0f, .0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
-		// 3. initialize shaders
-		if (initShaders() != 0) return -1;
-		// 4. create two triangles
-		initVAOs();
-		// 5. render the triangles
+		// render the triangles
 		renderTriangles();
+	}
 
-		glfwSwapBuffers(window);
-
-		// 6. create render loop
-		while (!glfwWindowShouldClose(window))
-		{
-			glfwPollEvents();
-
-			if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-			{
-				glfwSetWindowShouldClose(window, true);
-			}
-		}
-
-		// 7. clean resources
-		glfwTerminate();
-
-		return 0;
+	void shutdown()
+	{
+		batch::destroy(triangles);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		programJob = -1;
+		shaderProgram = 0;
 	}
 
 	void renderTriangles() 
 	{
-		glUseProgram(orangeShaderProgram);
-		glBindVertexArray(orangeVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 3);
-		glUseProgram(yellowShaderProgram);
-		glBindVertexArray(yellowVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 3);
-
-		glBindVertexArray(0);
+		shader_compiler::useProgram(shaderProgram);
+		batch::draw(triangles);
 	}
 
-	void initVAOs() {
+	int initVAOs() {
 		// create the two triangles in RAM
 		float orangeVertices[] = {
 			-.5f, -.5f, .0f,
@@ -96,141 +89,23 @@ void main()
 			.5f, -.5f, .0f,
 			.25f, .0f, .0f
 		};
+		unsigned int indices[] = { 0, 1, 2 };
 
-		// create VBOs
-		unsigned int orangeVBO, yellowVBO;
-		glGenBuffers(1, &orangeVBO);
-		glGenBuffers(1, &yellowVBO);
-
-		// create VAOs
-		glGenVertexArrays(1, &orangeVAO);
-		glGenVertexArrays(1, &yellowVAO);
-
-		// bind orange VAO
-		glBindVertexArray(orangeVAO);
-		// bin VBO to the VAO
-		glBindBuffer(GL_ARRAY_BUFFER, orangeVBO);
-		// copy the vertices into VBO
-		glBufferData(GL_ARRAY_BUFFER, sizeof(orangeVertices), orangeVertices, GL_STATIC_DRAW);
-		// tell OpenGl how to interpret the data in VBO
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-		glEnableVertexAttribArray(0);
-		// unbind VAO
-		glBindVertexArray(0);
-
-		// same for yellow
-		glBindVertexArray(yellowVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, yellowVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(yellowVertices), yellowVertices, GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-		glEnableVertexAttribArray(0);
-		glBindVertexArray(0);
+		// both go into the same VBO and EBO, every vertex gets the color of its triangle
+		batch::add(triangles, orangeVertices, 3, indices, 3, 1.0f, 0.5f, 0.2f);
+		batch::add(triangles, yellowVertices, 3, indices, 3, 1.0f, 1.0f, 0.0f);
+		return batch::upload(triangles);
 	}
 
 	int initShaders() {
-		// compile shaders by creating a shader object and attaching the shader sources to them
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		unsigned int orangeFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		unsigned int yellowFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-		glShaderSource(vertexShader, 1, &vertexShaderSrc, NULL);
-		glShaderSource(orangeFragmentShader, 1, &orangeFragmentShaderSrc, NULL);
-		glShaderSource(yellowFragmentShader, 1, &yellowFragmentShaderSrc, NULL);
-		
-		glCompileShader(vertexShader);
-		glCompileShader(orangeFragmentShader);
-		glCompileShader(yellowFragmentShader);
-
-		int success;
-		char infoLog[512];
-
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glGetShaderiv(orangeFragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(orangeFragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glGetShaderiv(yellowFragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(yellowFragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		orangeShaderProgram = glCreateProgram();
-		yellowShaderProgram = glCreateProgram();
-
-		glAttachShader(orangeShaderProgram, vertexShader);
-		glAttachShader(orangeShaderProgram, orangeFragmentShader);
-		glAttachShader(yellowShaderProgram, vertexShader);
-		glAttachShader(yellowShaderProgram, yellowFragmentShader);
-
-		glLinkProgram(orangeShaderProgram);
-		glLinkProgram(yellowShaderProgram);
-
-		glGetProgramiv(orangeShaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(orangeShaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-		glGetProgramiv(yellowShaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(yellowShaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glDeleteShader(orangeFragmentShader);
-		glDeleteShader(yellowFragmentShader);
-
-		return 0;
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
 	}
 
-	int initContext() {
-		int width = 800, height = 800;
-		// init glfw
-		glfwInit();
-		// hint window for OpenGl version 3.3
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-		// hint window to use core profile
-		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-		// request glfw to create a window
-		window = glfwCreateWindow(width, height, "Hello triangle excercise", NULL, NULL);
-		// check for error during window creation
-		if (window == NULL)
-		{
-			std::cout << "ERROR::WINDOW::FAILED_TO_CREATE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-		// set the current context to the created window
-		glfwMakeContextCurrent(window);
-		// initialize glad
-		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-		{
-			std::cout << "ERROR::GLAD::FAILED_TO_INITIALIZE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-
-		glViewport(0, 0, width, height);
-
-		return 0;
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
 	}
 
 }
\ No newline at end of file
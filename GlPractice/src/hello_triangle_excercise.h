@@ -2,10 +2,17 @@
 #define HELLO_TRIANGLE_H
 
 namespace hello_triangle {
-    int main();
-    int initContext();
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // clears the screen and draws the triangles
+    void render();
+    void shutdown();
     int initShaders();
-    void initVAOs();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    // puts both triangles into one batch
+    int initVAOs();
     void renderTriangles();
 }
 
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <glad/glad.h>
+#include "indirect_draw.h"
+
+namespace indirect_draw {
+
+	Stats stats = {};
+
+	bool supported()
+	{
+		return (GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_multi_draw_indirect) && GLAD_GL_VERSION_4_2 && glMultiDrawElementsIndirect != NULL;
+	}
+
+	int create(Buffer& buffer, size_t capacity)
+	{
+		buffer = {};
+		if (!supported())
+		{
+			std::cout << "ERROR::INDIRECT_DRAW::NOT_SUPPORTED" << std::endl;
+			return -1;
+		}
+		buffer.capacity = capacity;
+		buffer.commands.reserve(capacity);
+		glGenBuffers(1, &buffer.buffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer.buffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(Command), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		return 0;
+	}
+
+	void destroy(Buffer& buffer)
+	{
+		glDeleteBuffers(1, &buffer.buffer);
+		buffer = {};
+	}
+
+	int add(Buffer& buffer, const mesh_pool::Pool& pool, mesh_pool::Handle mesh, int level)
+	{
+		if (buffer.commands.size() >= buffer.capacity)
+		{
+			std::cout << "ERROR::INDIRECT_DRAW::FULL" << std::endl;
+			return -1;
+		}
+		Command command;
+		command.count = mesh_pool::indexCount(pool, mesh, level);
+		command.instanceCount = 1;
+		command.firstIndex = (unsigned int)mesh_pool::firstIndex(pool, mesh, level);
+		command.baseVertex = mesh_pool::baseVertex(pool, mesh);
+		command.baseInstance = (unsigned int)buffer.commands.size();
+		buffer.commands.push_back(command);
+		return (int)command.baseInstance;
+	}
+
+	void clear(Buffer& buffer)
+	{
+		buffer.commands.clear();
+	}
+
+	void upload(Buffer& buffer)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer.buffer);
+		// orphan the old commands, the GPU may still be reading them
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, buffer.capacity * sizeof(Command), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, buffer.commands.size() * sizeof(Command), buffer.commands.data());
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		buffer.count = buffer.commands.size();
+	}
+
+	void draw(const Buffer& buffer, const mesh_pool::Pool& pool)
+	{
+		if (buffer.count == 0) return;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer.buffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, pool.indexType, NULL, (GLsizei)buffer.count, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		stats.submits++;
+		stats.commands += buffer.count;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,73 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+#include <cstddef>
+#include <vector>
+#include "mesh_pool.h"
+
+// Draws of a mesh pool described in a buffer object instead of in the arguments of a call.
+// Every draw is a DrawElementsIndirectCommand, glMultiDrawElementsIndirect reads them from the
+// GL_DRAW_INDIRECT_BUFFER, so thousands of meshes cost the CPU one call, and the commands can be
+// written once and drawn every frame, or written by a compute shader without the CPU knowing the count.
+//
+// The commands get their index in the buffer as baseInstance. GL 4.3 has no gl_DrawID, but an
+// instanced attribute (divisor 1) is read at baseInstance + gl_InstanceID, so with one instance per
+// command the attribute is the per-draw data of the draw:
+//
+//     indirect_draw::Buffer draws;
+//     indirect_draw::create(draws, meshCount);
+//     for (...) indirect_draw::add(draws, pool, mesh);    // draw ID = index of the per-draw data
+//     indirect_draw::upload(draws);
+//     mesh_pool::bind(pool);
+//     indirect_draw::draw(draws, pool);
+//
+// Needs GL 4.3 or ARB_multi_draw_indirect, and GL 4.2 for baseInstance.
+namespace indirect_draw {
+    // DrawElementsIndirectCommand, the layout is fixed by the spec
+    struct Command {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+
+    struct Buffer {
+        // GL_DRAW_INDIRECT_BUFFER with room for capacity commands
+        unsigned int buffer;
+        size_t capacity;
+        // the commands appended since the last clear(), upload() copies them into the buffer object
+        std::vector<Command> commands;
+        // how many commands are in the buffer object, draw() draws that many
+        size_t count;
+    };
+
+    struct Stats {
+        // glMultiDrawElementsIndirect calls
+        unsigned long long submits;
+        // commands they contained
+        unsigned long long commands;
+    };
+
+    bool supported();
+
+    int create(Buffer& buffer, size_t capacity);
+    void destroy(Buffer& buffer);
+
+    // Appends a draw of the mesh at the level of detail, with one instance. Returns its draw ID
+    // (the index of the command, which it also gets as baseInstance), -1 if the buffer is full.
+    int add(Buffer& buffer, const mesh_pool::Pool& pool, mesh_pool::Handle mesh, int level = 0);
+    void clear(Buffer& buffer);
+    // copies the appended commands into the buffer object, they replace the ones that were there
+    void upload(Buffer& buffer);
+
+    // Draws the commands of the buffer object with one glMultiDrawElementsIndirect.
+    // The pool has to be bound and its meshes must not have moved since the commands were written
+    // (a defragment changes the base vertices and first indices).
+    void draw(const Buffer& buffer, const mesh_pool::Pool& pool);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
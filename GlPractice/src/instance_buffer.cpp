@@ -0,0 +1,52 @@
+#include <iostream>
+#include <glad/glad.h>
+#include "instance_buffer.h"
+
+namespace instance_buffer {
+
+	void addAttribute(Layout& layout, unsigned int location, int components, size_t offset)
+	{
+		if ((components < 1 || components > 4) && components != 16)
+		{
+			std::cout << "ERROR::INSTANCE_BUFFER::INVALID_COMPONENT_COUNT " << components << std::endl;
+			return;
+		}
+		layout.attributes.push_back({ location, components, offset });
+	}
+
+	void setAttributes(const Layout& layout, unsigned int buffer, size_t offset)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		for (const Attribute& attribute : layout.attributes)
+		{
+			// a mat4 attribute is 4 vec4 attributes at consecutive locations
+			int columns = attribute.components == 16 ? 4 : 1;
+			int size = attribute.components == 16 ? 4 : attribute.components;
+			for (int column = 0; column < columns; column++)
+			{
+				unsigned int location = attribute.location + column;
+				size_t start = offset + attribute.offset + column * 4 * sizeof(float);
+				glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, (GLsizei)layout.stride, (void*)start);
+				glEnableVertexAttribArray(location);
+				// 1: the attribute moves to the next element after every instance, not every vertex
+				glVertexAttribDivisor(location, 1);
+			}
+		}
+	}
+
+	unsigned int createStatic(const void* data, size_t size)
+	{
+		unsigned int buffer = 0;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return buffer;
+	}
+
+	void* stream(stream_buffer::Buffer& stream, const Layout& layout, int count, size_t& offset)
+	{
+		return stream_buffer::allocate(stream, count * layout.stride, layout.stride, offset);
+	}
+
+}
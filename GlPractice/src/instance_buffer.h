@@ -0,0 +1,43 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+#include "stream_buffer.h"
+
+// Per-instance vertex attributes. The attributes of a layout advance once per instance (glVertexAttribDivisor 1)
+// instead of once per vertex, so a single glDraw*Instanced call can draw N copies of a mesh, each with its
+// own transform, color, texture layer...
+// The instance data can be a static buffer filled once from a CPU array, or written every frame into a
+// stream buffer, in which case the attributes are pointed at the frame's region before drawing.
+namespace instance_buffer {
+    struct Attribute {
+        unsigned int location;
+        // 1..4 floats, or 16 for a mat4 (which takes 4 locations, one per column)
+        int components;
+        // byte offset inside one instance
+        size_t offset;
+    };
+
+    struct Layout {
+        std::vector<Attribute> attributes;
+        // size of one instance in bytes
+        size_t stride;
+    };
+
+    // adds a float/vec2/vec3/vec4 (components 1..4) or mat4 (components 16) attribute to the layout
+    void addAttribute(Layout& layout, unsigned int location, int components, size_t offset);
+
+    // Points the layout's attributes of the currently bound VAO at the instances starting at offset in
+    // buffer, and makes them advance per instance. Binds buffer to GL_ARRAY_BUFFER.
+    void setAttributes(const Layout& layout, unsigned int buffer, size_t offset);
+
+    // creates a static buffer holding size bytes of instance data, returns 0 on failure
+    unsigned int createStatic(const void* data, size_t size);
+
+    // Room for count instances in the frame's region of the stream buffer, aligned to the stride.
+    // Fill it, flush the stream buffer, then call setAttributes with stream.id and offset. Returns NULL if full.
+    void* stream(stream_buffer::Buffer& stream, const Layout& layout, int count, size_t& offset);
+}
+
+#endif
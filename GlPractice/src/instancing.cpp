@@ -0,0 +1,294 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <glad/glad.h>
+#include "instancing.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "uniform_table.h"
+#include "instance_buffer.h"
+#include "stream_buffer.h"
+
+namespace instancing {
+
+	// what every copy of the quad gets
+	struct Instance {
+		// position, scale and rotation of the quad
+		float x, y, scale, angle;
+		float r, g, b, a;
+		// layer of the texture array
+		float layer;
+	};
+
+	const int layerCount = 4;
+
+	int instanceCount;
+	bool streamInstances;
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO, EBO;
+	// static instance data, unused when the instances are streamed
+	unsigned int instanceVBO;
+	stream_buffer::Buffer instanceStream = {};
+	instance_buffer::Layout instanceLayout;
+	std::vector<Instance> instances;
+	unsigned int textureArray;
+	float elapsedTime;
+	uniform_table::Table uniformTable;
+	uniform_table::FloatHandle timeHandle = { -1 };
+	uniform_table::IntHandle samplerHandle = { -1 };
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// these advance per instance, not per vertex
+layout (location = 2) in vec4 aTransform;
+layout (location = 3) in vec4 aColor;
+layout (location = 4) in float aLayer;
+
+uniform float time;
+
+out vec4 vtxColor;
+out vec3 texCoord;
+
+void main()
+{
+    float angle = aTransform.w + time;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    gl_Position = vec4(rotation * aPos.xy * aTransform.z + aTransform.xy, 0.0, 1.0);
+    vtxColor = aColor;
+    texCoord = vec3(aTexCoord, aLayer);
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+
+uniform sampler2DArray textures;
+
+in vec4 vtxColor;
+in vec3 texCoord;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = texture(textures, texCoord) * vtxColor;
+}
+)";
+
+	int init1() { return init(1, false); }
+	int init64() { return init(64, false); }
+	int init4k() { return init(4096, false); }
+	int init64k() { return init(65536, false); }
+	int init1m() { return init(1 << 20, false); }
+	int initStream4k() { return init(4096, true); }
+
+	void registerScene()
+	{
+		scene::registerScene({ "instancing_1", init1, update, render, shutdown });
+		scene::registerScene({ "instancing_64", init64, update, render, shutdown });
+		// the same number of quads as the batching scenes
+		scene::registerScene({ "instancing_4k", init4k, update, render, shutdown });
+		scene::registerScene({ "instancing_64k", init64k, update, render, shutdown });
+		scene::registerScene({ "instancing_1m", init1m, update, render, shutdown });
+		scene::registerScene({ "instancing_stream_4k", initStream4k, update, render, shutdown });
+	}
+
+	int init(int count, bool streamed) {
+		instanceCount = count;
+		streamInstances = streamed;
+
+		if (initShaders() != 0) return -1;
+		initTextures();
+		return initVAOs();
+	}
+
+	void update(double time)
+	{
+		elapsedTime = (float)time;
+	}
+
+	void render()
+	{
+		// black background color
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		renderInstances();
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		glDeleteBuffers(1, &instanceVBO);
+		glDeleteTextures(1, &textureArray);
+		stream_buffer::destroy(instanceStream);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = EBO = instanceVBO = textureArray = shaderProgram = 0;
+		programJob = -1;
+		timeHandle = { -1 };
+		samplerHandle = { -1 };
+		instances = std::vector<Instance>();
+		instanceLayout = instance_buffer::Layout();
+	}
+
+	void renderInstances()
+	{
+		if (streamInstances)
+		{
+			// the CPU rotates the quads and writes them into this frame's region
+			stream_buffer::beginFrame(instanceStream);
+			size_t offset;
+			Instance* frameInstances = (Instance*)instance_buffer::stream(instanceStream, instanceLayout, instanceCount, offset);
+			if (frameInstances == NULL)
+			{
+				stream_buffer::endFrame(instanceStream);
+				return;
+			}
+			for (int i = 0; i < instanceCount; i++)
+			{
+				frameInstances[i] = instances[i];
+				frameInstances[i].angle += elapsedTime;
+			}
+			stream_buffer::flush(instanceStream);
+
+			// the region moves every frame, so the instance attributes have to follow it
+			glBindVertexArray(VAO);
+			instance_buffer::setAttributes(instanceLayout, instanceStream.id, offset);
+		}
+
+		shader_compiler::useProgram(shaderProgram);
+		// streamed instances are already rotated
+		uniform_table::setFloat(uniformTable, timeHandle, streamInstances ? 0.0f : elapsedTime);
+		uniform_table::setInt(uniformTable, samplerHandle, 0);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+		glBindVertexArray(VAO);
+		// every instance draws the 6 indices of the quad
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, instanceCount);
+		glBindVertexArray(0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		if (streamInstances) stream_buffer::endFrame(instanceStream);
+	}
+
+	void initTextures()
+	{
+		// a few 8x8 checkerboards in different colors, one per layer
+		const int size = 8;
+		std::vector<unsigned char> pixels(size * size * 3 * layerCount);
+		for (int layer = 0; layer < layerCount; layer++)
+		{
+			for (int y = 0; y < size; y++)
+			{
+				for (int x = 0; x < size; x++)
+				{
+					unsigned char* pixel = &pixels[((layer * size + y) * size + x) * 3];
+					bool light = (x + y) % 2 == 0;
+					pixel[0] = light ? 255 : (unsigned char)(layer * 60);
+					pixel[1] = light ? 255 : (unsigned char)(255 - layer * 60);
+					pixel[2] = light ? 255 : 128;
+				}
+			}
+		}
+
+		glGenTextures(1, &textureArray);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		// the rows of an 8 pixel wide RGB image are 24 bytes, no need to change GL_UNPACK_ALIGNMENT
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, size, size, layerCount, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	int initVAOs() {
+		// the quad of the texture scene
+		float vertices[] = {
+			// positions          // texture coords
+			 0.5f,  0.5f, 0.0f,   1.0f, 1.0f,   // top right
+			 0.5f, -0.5f, 0.0f,   1.0f, 0.0f,   // bottom right
+			-0.5f, -0.5f, 0.0f,   0.0f, 0.0f,   // bottom left
+			-0.5f,  0.5f, 0.0f,   0.0f, 1.0f    // top left
+		};
+		unsigned int indices[] = {
+			0, 1, 3, // first triangle
+			1, 2, 3  // second triangle
+		};
+
+		// the instances fill a square grid over the whole screen
+		int side = (int)std::ceil(std::sqrt((double)instanceCount));
+		float cellSize = 2.0f / side;
+		instances.resize(instanceCount);
+		for (int i = 0; i < instanceCount; i++)
+		{
+			int x = i % side, y = i / side;
+			Instance& instance = instances[i];
+			instance.x = -1.0f + (x + 0.5f) * cellSize;
+			instance.y = -1.0f + (y + 0.5f) * cellSize;
+			instance.scale = cellSize * 0.7f;
+			instance.angle = i * 0.1f;
+			instance.r = (float)x / side;
+			instance.g = (float)y / side;
+			instance.b = 1.0f;
+			instance.a = 1.0f;
+			instance.layer = (float)(i % layerCount);
+		}
+
+		instanceLayout.stride = sizeof(Instance);
+		instance_buffer::addAttribute(instanceLayout, 2, 4, offsetof(Instance, x));
+		instance_buffer::addAttribute(instanceLayout, 3, 4, offsetof(Instance, r));
+		instance_buffer::addAttribute(instanceLayout, 4, 1, offsetof(Instance, layer));
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		// the per vertex attributes
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		if (streamInstances)
+		{
+			// renderInstances points the attributes at the frame's region
+			glBindVertexArray(0);
+			return stream_buffer::create(instanceStream, instanceCount * sizeof(Instance));
+		}
+
+		// static instances are uploaded once, the shader rotates them with the time uniform
+		instanceVBO = instance_buffer::createStatic(instances.data(), instances.size() * sizeof(Instance));
+		instance_buffer::setAttributes(instanceLayout, instanceVBO, 0);
+		glBindVertexArray(0);
+		instances = std::vector<Instance>();
+
+		return 0;
+	}
+
+	int initShaders() {
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		timeHandle = uniform_table::getFloat(uniformTable, "time");
+		samplerHandle = uniform_table::getInt(uniformTable, "textures");
+	}
+
+}
@@ -0,0 +1,23 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+// Draws N copies of a textured quad with one glDrawElementsInstanced. Registered with 1 to 1M instances,
+// so the bench shows where instancing starts to pay off compared to the batching scenes.
+// The stream version writes the instances into a stream buffer every frame instead of animating them in the shader.
+namespace instancing {
+    // adds every instance count of the demo to the scene registry
+    void registerScene();
+    // creates the scene with count instances, the init of the registered scenes only pick the count
+    int init(int count, bool streamed);
+    void update(double time);
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    void initTextures();
+    int initVAOs();
+    void renderInstances();
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <glad/glad.h>
+#include "level_of_detail.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
+#include "mesh_pool.h"
+#include "lod.h"
+
+namespace level_of_detail {
+
+	const int gridSize = 16;
+	// segments around and rings from pole to pole of the sphere
+	const int segments = 256;
+	const int rings = 128;
+	const float fovY = 1.0471976f;
+	// the spheres move between these distances, close enough to fill their cell and far enough to be a few pixels
+	const float minDistance = 28.0f;
+	const float maxDistance = 200.0f;
+
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 3>,
+		vertex_layout::Attr<1, vertex_layout::ubyte, 3, vertex_layout::normalized>> VertexLayout;
+
+	// one sphere of the grid
+	struct Object {
+		float x, y, distance;
+		// the level it was drawn with last frame
+		int level;
+	};
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	mesh_pool::Pool pool;
+	mesh_pool::Handle sphere = -1;
+	// the error of every level of the sphere, for lod::select
+	std::vector<float> levelErrors;
+	std::vector<Object> objects;
+	uniform_table::Table uniformTable;
+	uniform_table::Vec3Handle centerHandle = { -1 };
+	uniform_table::Vec2Handle focalHandle = { -1 };
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+// where the sphere is, in view space
+uniform vec3 center;
+// the focal length over the aspect ratio, and the focal length
+uniform vec2 focal;
+
+out vec3 vtxColor;
+
+const float near = 0.1;
+const float far = 500.0;
+
+void main()
+{
+    vec3 position = aPos + center;
+    gl_Position = vec4(position.xy * focal, (far + near) / (near - far) * position.z + 2.0 * far * near / (near - far), -position.z);
+    vtxColor = aColor;
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+
+in vec3 vtxColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(vtxColor, 1.0);
+}
+)";
+
+	void registerScene()
+	{
+		scene::registerScene({ "level_of_detail", init, update, render, shutdown });
+	}
+
+	int init()
+	{
+		if (initShaders() != 0) return -1;
+		return initMeshes();
+	}
+
+	// a unit sphere with bumps, colored by their height. Positions and colors as floats for the simplifier.
+	void buildSphere(std::vector<float>& vertices, std::vector<unsigned int>& indices)
+	{
+		for (int ring = 0; ring <= rings; ring++)
+		{
+			float theta = 3.1415927f * ring / rings;
+			for (int segment = 0; segment <= segments; segment++)
+			{
+				float phi = 6.2831853f * segment / segments;
+				float bump = std::sin(theta * 9.0f) * std::sin(phi * 8.0f);
+				float radius = 1.0f + 0.08f * bump;
+				float height = bump * 0.5f + 0.5f;
+				vertices.insert(vertices.end(), {
+					radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi),
+					0.2f + 0.8f * height, 0.4f, 1.0f - 0.8f * height });
+			}
+		}
+		// the first and last column are at the same place (the seam), like the vertices of each pole,
+		// the simplifier keeps those where they are
+		for (int ring = 0; ring < rings; ring++)
+		{
+			for (int segment = 0; segment < segments; segment++)
+			{
+				unsigned int a = ring * (segments + 1) + segment;
+				unsigned int b = a + segments + 1;
+				indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+			}
+		}
+	}
+
+	int initMeshes()
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		buildSphere(vertices, indices);
+		size_t vertexCount = vertices.size() / 6;
+
+		std::vector<lod::Level> levels;
+		// a color step of 0.1 costs as much as being off by 1% of the sphere
+		const float colorWeights[3] = { 0.01f, 0.01f, 0.01f };
+		// the far spheres are a few pixels, they can be off by a tenth of their size
+		lod::buildChain(levels, indices.data(), indices.size(), vertices.data(), vertexCount, 6,
+			lod::MAX_LEVELS, 0.5f, 0.1f, colorWeights, 3);
+
+		// the vertices are shared, the levels only take index space, about as much as the mesh again
+		size_t indexCapacity = 0;
+		for (const lod::Level& level : levels) indexCapacity += level.indices.size();
+		if (mesh_pool::create<VertexLayout>(pool, GL_UNSIGNED_INT, vertexCount, indexCapacity) != 0) return -1;
+
+		std::vector<float> positions(vertexCount * 3), colors(vertexCount * 3);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				positions[v * 3 + i] = vertices[v * 6 + i];
+				colors[v * 3 + i] = vertices[v * 6 + 3 + i];
+			}
+		}
+		std::vector<unsigned char> packed(VertexLayout::bufferSize(vertexCount));
+		VertexLayout::fill<0>(packed.data(), vertexCount, positions.data());
+		VertexLayout::fill<1>(packed.data(), vertexCount, colors.data());
+
+		sphere = mesh_pool::add(pool, packed.data(), vertexCount, levels[0].indices.data(), levels[0].indices.size());
+		if (sphere < 0) return -1;
+		levelErrors.assign(1, 0.0f);
+		for (size_t i = 1; i < levels.size(); i++)
+		{
+			if (mesh_pool::addLevel(pool, sphere, levels[i].indices.data(), levels[i].indices.size()) < 0) return -1;
+			levelErrors.push_back(levels[i].error);
+		}
+
+		objects.assign(gridSize * gridSize, { 0.0f, 0.0f, minDistance, -1 });
+		for (int i = 0; i < gridSize * gridSize; i++)
+		{
+			// the center of the cell, in normalized device coordinates
+			objects[i].x = -1.0f + (i % gridSize + 0.5f) * 2.0f / gridSize;
+			objects[i].y = -1.0f + (i / gridSize + 0.5f) * 2.0f / gridSize;
+		}
+		return 0;
+	}
+
+	void update(double time)
+	{
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			// every sphere on its own phase and speed, so they cross the switching distances at different times
+			float wave = 0.5f + 0.5f * std::sin((float)time * (0.3f + 0.05f * (i % 7)) + i * 0.61f);
+			objects[i].distance = minDistance + (maxDistance - minDistance) * wave * wave;
+		}
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_CULL_FACE);
+
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		float aspect = viewport[3] > 0 ? (float)viewport[2] / viewport[3] : 1.0f;
+		float tanHalf = std::tan(fovY * 0.5f);
+
+		shader_compiler::useProgram(shaderProgram);
+		uniform_table::setVec2(uniformTable, focalHandle, 1.0f / (tanHalf * aspect), 1.0f / tanHalf);
+
+		mesh_pool::bind(pool);
+		for (Object& object : objects)
+		{
+			// the sphere is 2 units across
+			float screenSize = lod::projectedSize(2.0f, object.distance, fovY, viewport[3]);
+			object.level = lod::select(levelErrors.data(), (int)levelErrors.size(), screenSize, object.level);
+
+			// keep the sphere in the middle of its cell whatever the distance
+			uniform_table::setVec3(uniformTable, centerHandle, object.x * object.distance * tanHalf * aspect,
+				object.y * object.distance * tanHalf, -object.distance);
+			mesh_pool::draw(pool, sphere, object.level);
+		}
+		glBindVertexArray(0);
+
+		glDisable(GL_CULL_FACE);
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	void shutdown()
+	{
+		mesh_pool::destroy(pool);
+		sphere = -1;
+		levelErrors.clear();
+		objects.clear();
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		shaderProgram = 0;
+		programJob = -1;
+		centerHandle = { -1 };
+		focalHandle = { -1 };
+	}
+
+	int initShaders()
+	{
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		centerHandle = uniform_table::getVec3(uniformTable, "center");
+		focalHandle = uniform_table::getVec2(uniformTable, "focal");
+	}
+
+}
@@ -0,0 +1,22 @@
+#ifndef LEVEL_OF_DETAIL_H
+#define LEVEL_OF_DETAIL_H
+
+// A grid of bumpy spheres that move towards and away from the camera. The sphere is simplified into a
+// chain of levels of detail once at init, they all live in one mesh pool next to its vertices. Every frame
+// each sphere picks the level that fits its size on screen (lod::select), with hysteresis so the ones
+// hovering around a switching distance do not pop back and forth.
+namespace level_of_detail {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // moves the spheres
+    void update(double time);
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initMeshes();
+}
+
+#endif
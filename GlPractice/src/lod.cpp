@@ -0,0 +1,84 @@
+#include <cmath>
+#include "lod.h"
+#include "mesh_simplifier.h"
+
+namespace lod {
+
+	// a level that removes less than this much of the triangles of the one before is not worth keeping
+	const float minReduction = 0.9f;
+
+	Stats stats = {};
+
+	void buildChain(std::vector<Level>& levels, const unsigned int* indices, size_t indexCount, const float* vertices,
+		size_t vertexCount, size_t vertexStride, int maxLevels, float ratio, float maxError,
+		const float* attributeWeights, size_t attributeCount)
+	{
+		levels.clear();
+		levels.push_back({ std::vector<unsigned int>(indices, indices + indexCount), 0.0f });
+
+		std::vector<unsigned int> simplified(indexCount);
+		while ((int)levels.size() < maxLevels)
+		{
+			// Simplifying the level before is much faster than starting from the mesh each time. Its error is
+			// measured from that level, added to the error it already had it is an upper bound for the whole.
+			const Level& previous = levels.back();
+			if (previous.error >= maxError) break;
+			size_t target = (size_t)(previous.indices.size() * ratio) / 3 * 3;
+			float error = 0.0f;
+			size_t count = mesh_simplifier::simplify(simplified.data(), previous.indices.data(), previous.indices.size(),
+				vertices, vertexCount, vertexStride, target, maxError - previous.error, &error, attributeWeights, attributeCount);
+			if (count == 0 || count > previous.indices.size() * minReduction) break;
+
+			Level level;
+			level.indices.assign(simplified.begin(), simplified.begin() + count);
+			level.error = previous.error + error;
+			levels.push_back(level);
+		}
+	}
+
+	float projectedSize(float size, float distance, float fovY, int viewportHeight)
+	{
+		if (distance <= 0.0f) return 1e30f;
+		return size / (2.0f * distance * std::tan(fovY * 0.5f)) * viewportHeight;
+	}
+
+	// the coarsest level that is off by at most maxPixels, level 0 if none is
+	int coarsest(const float* errors, int levelCount, float screenSize, float maxPixels)
+	{
+		int level = 0;
+		// the errors grow with the level, the first one that is too coarse ends the search
+		while (level + 1 < levelCount && errors[level + 1] * screenSize <= maxPixels) level++;
+		return level;
+	}
+
+	int select(const float* errors, int levelCount, float screenSize, int current, float maxPixelError, float hysteresis)
+	{
+		stats.selections++;
+		int level;
+		if (current < 0 || current >= levelCount || errors[current] * screenSize > maxPixelError)
+		{
+			// nothing drawn yet, or the current level is too coarse: take the best one right away
+			level = coarsest(errors, levelCount, screenSize, maxPixelError);
+		}
+		else
+		{
+			// the current level is good enough, only go coarser if the new one is well within the limit
+			level = coarsest(errors, levelCount, screenSize, maxPixelError * (1.0f - hysteresis));
+			if (level < current) level = current;
+			if (level == current && coarsest(errors, levelCount, screenSize, maxPixelError) > current) stats.held++;
+		}
+		if (current >= 0 && level != current) stats.switches++;
+		return level;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,53 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <cstddef>
+#include <vector>
+
+// Levels of detail for a mesh and the choice between them at runtime.
+// buildChain simplifies a mesh again and again (mesh_simplifier), every level has about half the triangles
+// of the one before and remembers its error, relative to the size of the mesh. At runtime the error times
+// the size of the mesh on screen is how many pixels the level is off by, select() takes the coarsest level
+// that is off by less than a pixel.
+//
+// An object right at the distance where two levels are equally good would switch between them every frame
+// as it moves a little, which shows as popping. select() only switches to a coarser level once it is clearly
+// good enough (hysteresis), and only back to a finer one when the current level is too coarse.
+namespace lod {
+    const int MAX_LEVELS = 8;
+
+    struct Level {
+        std::vector<unsigned int> indices;
+        // how far the level is from the mesh, relative to its largest extent
+        float error;
+    };
+
+    struct Stats {
+        unsigned long long selections;
+        // selections that picked another level than the current one
+        unsigned long long switches;
+        // selections that stayed at the current level only because of the hysteresis
+        unsigned long long held;
+    };
+
+    // Fills levels with the chain, levels[0] is the mesh itself (error 0). Every level gets ratio times the
+    // indices of the one before and stops when that would cost more than maxError or the simplifier can not
+    // get much further (locked borders and seams). The arguments are the ones of mesh_simplifier::simplify.
+    void buildChain(std::vector<Level>& levels, const unsigned int* indices, size_t indexCount, const float* vertices,
+        size_t vertexCount, size_t vertexStride, int maxLevels = MAX_LEVELS, float ratio = 0.5f, float maxError = 0.05f,
+        const float* attributeWeights = NULL, size_t attributeCount = 0);
+
+    // How many pixels an object of the size is high on screen at the distance, for a perspective projection
+    // with the vertical field of view fovY (radians) and a viewport of viewportHeight pixels.
+    float projectedSize(float size, float distance, float fovY, int viewportHeight);
+
+    // The level to draw an object with at screenSize pixels (projectedSize of its largest extent).
+    // errors has the error of every level, finest first. current is the level it was drawn with last frame,
+    // -1 if none. A coarser level is only taken when its error is below (1 - hysteresis) * maxPixelError pixels.
+    int select(const float* errors, int levelCount, float screenSize, int current, float maxPixelError = 1.0f, float hysteresis = 0.5f);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
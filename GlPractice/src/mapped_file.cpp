@@ -0,0 +1,99 @@
+#include <iostream>
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace mapped_file {
+
+#ifdef _WIN32
+	int open(File& file, const char* path)
+	{
+		file = {};
+		HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+			return -1;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(handle, &size))
+		{
+			std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+			CloseHandle(handle);
+			return -1;
+		}
+		file.file = handle;
+		file.size = (size_t)size.QuadPart;
+		if (file.size == 0) return 0;
+
+		HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		const void* view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+		if (view == NULL)
+		{
+			std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+			if (mapping != NULL) CloseHandle(mapping);
+			CloseHandle(handle);
+			file = {};
+			return -1;
+		}
+		file.mapping = mapping;
+		file.data = (const char*)view;
+		return 0;
+	}
+
+	void close(File& file)
+	{
+		if (file.data != NULL) UnmapViewOfFile(file.data);
+		if (file.mapping != NULL) CloseHandle((HANDLE)file.mapping);
+		if (file.file != NULL) CloseHandle((HANDLE)file.file);
+		file = {};
+	}
+#else
+	int open(File& file, const char* path)
+	{
+		file = {};
+		int descriptor = ::open(path, O_RDONLY);
+		struct stat info;
+		if (descriptor < 0 || fstat(descriptor, &info) != 0)
+		{
+			std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+			if (descriptor >= 0) ::close(descriptor);
+			return -1;
+		}
+		file.size = (size_t)info.st_size;
+		if (file.size > 0)
+		{
+			void* view = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if (view == MAP_FAILED)
+			{
+				std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+				::close(descriptor);
+				file = {};
+				return -1;
+			}
+			// the whole file is going to be read front to back
+			madvise(view, file.size, MADV_SEQUENTIAL);
+			file.data = (const char*)view;
+		}
+		// the mapping stays valid without the descriptor
+		::close(descriptor);
+		return 0;
+	}
+
+	void close(File& file)
+	{
+		if (file.data != NULL) munmap((void*)file.data, file.size);
+		file = {};
+	}
+#endif
+
+}
@@ -0,0 +1,22 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// A read-only file mapped into memory. The OS pages the file in on demand, there is no read() copy into
+// a buffer of our own, and any number of threads can read different parts of it at the same time.
+namespace mapped_file {
+    struct File {
+        const char* data;
+        size_t size;
+        // the OS handles, platform specific
+        void* file;
+        void* mapping;
+    };
+
+    // maps the whole file, returns 0 on success. An empty file is mapped with data NULL and size 0.
+    int open(File& file, const char* path);
+    void close(File& file);
+}
+
+#endif
@@ -0,0 +1,322 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <glad/glad.h>
+#include "mesh_file.h"
+#include "obj_loader.h"
+#include "mesh_optimizer.h"
+#include "vertex_layout.h"
+#include "program_cache.h"
+
+namespace mesh_file {
+
+	// "GLPM" in little endian
+	const unsigned int fileMagic = 0x4d504c47;
+	// bump this if the layout of the file or what the converter writes changes
+	const unsigned int fileVersion = 1;
+
+	// the vertices convertObj writes
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 3>,
+		vertex_layout::Attr<1, vertex_layout::int2_10_10_10, 4, vertex_layout::normalized>,
+		vertex_layout::Attr<2, vertex_layout::half, 2>> ConvertedLayout;
+
+	std::string directory = "mesh_cache";
+	Stats stats = {};
+
+	void setDirectory(const char* path)
+	{
+		directory = path;
+	}
+
+	size_t alignUp(size_t value)
+	{
+		return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+	}
+
+	int write(const char* path, const Description& description)
+	{
+		if (description.attributeCount > MAX_ATTRIBUTES)
+		{
+			std::cout << "ERROR::MESH_FILE::TOO_MANY_ATTRIBUTES " << path << std::endl;
+			return -1;
+		}
+
+		Header header = {};
+		header.magic = fileMagic;
+		header.version = fileVersion;
+		header.attributeCount = description.attributeCount;
+		header.stride = description.stride;
+		std::memcpy(header.attributes, description.attributes, description.attributeCount * sizeof(Attribute));
+		header.vertexCount = description.vertexCount;
+		header.indexType = description.indexType;
+		header.indexCount = description.indexCount;
+		header.submeshCount = description.submeshCount;
+		header.submeshOffset = sizeof(Header);
+		size_t vertexBytes = description.vertexCount * description.stride;
+		size_t indexBytes = description.indexCount * mesh_optimizer::indexSize(description.indexType);
+		header.vertexOffset = alignUp(header.submeshOffset + description.submeshCount * sizeof(Submesh));
+		header.indexOffset = alignUp(header.vertexOffset + vertexBytes);
+		header.fileSize = header.indexOffset + indexBytes;
+
+		std::string tempPath = std::string(path) + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				std::cout << "ERROR::MESH_FILE::CANT_WRITE " << path << std::endl;
+				return -1;
+			}
+
+			const char padding[BLOB_ALIGNMENT] = {};
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)description.submeshes, description.submeshCount * sizeof(Submesh));
+			file.write(padding, header.vertexOffset - (header.submeshOffset + description.submeshCount * sizeof(Submesh)));
+			file.write((const char*)description.vertices, vertexBytes);
+			file.write(padding, header.indexOffset - (header.vertexOffset + vertexBytes));
+			file.write((const char*)description.indices, indexBytes);
+			if (!file)
+			{
+				std::cout << "ERROR::MESH_FILE::CANT_WRITE " << path << std::endl;
+				return -1;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+		{
+			std::cout << "ERROR::MESH_FILE::CANT_WRITE " << path << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	// true if [offset, offset + size) is inside a file of fileSize bytes
+	bool inside(unsigned long long offset, unsigned long long size, unsigned long long fileSize)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	}
+
+	int open(Mesh& mesh, const char* path)
+	{
+		mesh = {};
+		if (mapped_file::open(mesh.file, path) != 0) return -1;
+
+		// a file from another version is treated like a missing one, the caller converts it again
+		const Header* header = (const Header*)mesh.file.data;
+		if (mesh.file.size < sizeof(Header) || header->magic != fileMagic || header->version != fileVersion)
+		{
+			close(mesh);
+			return -1;
+		}
+
+		size_t indexSize = mesh_optimizer::indexSize(header->indexType);
+		if (header->fileSize != mesh.file.size || header->attributeCount > MAX_ATTRIBUTES || header->stride == 0
+			|| header->vertexOffset % BLOB_ALIGNMENT != 0 || header->indexOffset % BLOB_ALIGNMENT != 0
+			|| header->vertexCount > mesh.file.size / header->stride || header->indexCount > mesh.file.size / indexSize
+			|| !inside(header->submeshOffset, (unsigned long long)header->submeshCount * sizeof(Submesh), mesh.file.size)
+			|| !inside(header->vertexOffset, header->vertexCount * header->stride, mesh.file.size)
+			|| !inside(header->indexOffset, header->indexCount * indexSize, mesh.file.size))
+		{
+			std::cout << "ERROR::MESH_FILE::INVALID " << path << std::endl;
+			close(mesh);
+			return -1;
+		}
+
+		mesh.header = header;
+		mesh.submeshes = (const Submesh*)(mesh.file.data + header->submeshOffset);
+		mesh.vertices = mesh.file.data + header->vertexOffset;
+		mesh.indices = mesh.file.data + header->indexOffset;
+		mesh.vertexBytes = (size_t)(header->vertexCount * header->stride);
+		mesh.indexBytes = (size_t)(header->indexCount * indexSize);
+		for (unsigned int i = 0; i < header->submeshCount; i++)
+		{
+			if (mesh.submeshes[i].firstIndex > header->indexCount || mesh.submeshes[i].indexCount > header->indexCount - mesh.submeshes[i].firstIndex)
+			{
+				std::cout << "ERROR::MESH_FILE::INVALID " << path << std::endl;
+				close(mesh);
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	void close(Mesh& mesh)
+	{
+		mapped_file::close(mesh.file);
+		mesh = {};
+	}
+
+	void setupAttributes(const Header& header, unsigned int buffer)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		for (unsigned int i = 0; i < header.attributeCount; i++)
+		{
+			const Attribute& attribute = header.attributes[i];
+			glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+				header.stride, (void*)(size_t)attribute.offset);
+			glEnableVertexAttribArray(attribute.location);
+		}
+	}
+
+	// fills the bound buffer at target with size bytes of data
+	int fillBuffer(GLenum target, const void* data, size_t size, UploadMode mode)
+	{
+		if (mode == UPLOAD_BUFFER_DATA)
+		{
+			// the driver reads the pages of the mapping, the file goes from the page cache to the driver
+			glBufferData(target, size, data, GL_STATIC_DRAW);
+			return 0;
+		}
+
+		glBufferData(target, size, NULL, GL_STATIC_DRAW);
+		if (size == 0) return 0;
+		void* mapped = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped == NULL)
+		{
+			std::cout << "ERROR::MESH_FILE::MAP_FAILED" << std::endl;
+			return -1;
+		}
+		std::memcpy(mapped, data, size);
+		// the contents are undefined if the buffer got lost while it was mapped, the caller would have to retry
+		if (glUnmapBuffer(target) != GL_TRUE)
+		{
+			std::cout << "ERROR::MESH_FILE::UNMAP_FAILED" << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	int upload(const Mesh& mesh, unsigned int& VAO, unsigned int& VBO, unsigned int& EBO, UploadMode mode)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		int result = fillBuffer(GL_ARRAY_BUFFER, mesh.vertices, mesh.vertexBytes, mode);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		if (result == 0) result = fillBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices, mesh.indexBytes, mode);
+		setupAttributes(*mesh.header, VBO);
+		glBindVertexArray(0);
+		return result;
+	}
+
+	int convertObj(const char* objPath, const char* meshPath)
+	{
+		obj_loader::Mesh source;
+		if (obj_loader::load(source, objPath) != 0) return -1;
+
+		// the submeshes are optimized on their own so they stay contiguous, the vertices are shared by all of them
+		std::vector<unsigned int> indices(source.indices.size());
+		for (const obj_loader::Submesh& submesh : source.submeshes)
+		{
+			unsigned int* range = indices.data() + submesh.firstIndex;
+			mesh_optimizer::optimizeVertexCache(range, source.indices.data() + submesh.firstIndex, submesh.indexCount, source.vertexCount);
+			mesh_optimizer::optimizeOverdraw(range, submesh.indexCount, source.vertices.data(), source.vertexCount, obj_loader::FLOATS_PER_VERTEX);
+		}
+		std::vector<float> vertices(source.vertices.size());
+		size_t vertexCount = mesh_optimizer::optimizeVertexFetch(vertices.data(), indices.data(), indices.size(),
+			source.vertices.data(), source.vertexCount, obj_loader::FLOATS_PER_VERTEX * sizeof(float));
+
+		// split the floats into the streams fill() converts
+		std::vector<float> positions, normals, texCoords;
+		positions.reserve(vertexCount * 3);
+		normals.reserve(vertexCount * 4);
+		texCoords.reserve(vertexCount * 2);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			const float* vertex = &vertices[v * obj_loader::FLOATS_PER_VERTEX];
+			positions.insert(positions.end(), vertex, vertex + 3);
+			normals.insert(normals.end(), { vertex[3], vertex[4], vertex[5], 0.0f });
+			texCoords.insert(texCoords.end(), vertex + 6, vertex + 8);
+		}
+		std::vector<unsigned char> packed(ConvertedLayout::bufferSize(vertexCount));
+		ConvertedLayout::fill<0>(packed.data(), vertexCount, positions.data());
+		ConvertedLayout::fill<1>(packed.data(), vertexCount, normals.data());
+		ConvertedLayout::fill<2>(packed.data(), vertexCount, texCoords.data());
+
+		std::vector<unsigned char> narrowIndices;
+		unsigned int indexType = mesh_optimizer::narrowIndices(narrowIndices, indices.data(), indices.size(), vertexCount);
+
+		Attribute attributes[ConvertedLayout::count];
+		for (size_t i = 0; i < ConvertedLayout::count; i++)
+		{
+			attributes[i] = { ConvertedLayout::location(i), ConvertedLayout::glType(i), (unsigned int)ConvertedLayout::components(i),
+				ConvertedLayout::isNormalized(i) ? 1u : 0u, (unsigned int)ConvertedLayout::offset(i) };
+		}
+
+		std::vector<Submesh> submeshes;
+		for (const obj_loader::Submesh& submesh : source.submeshes)
+		{
+			Submesh converted = { submesh.firstIndex, submesh.indexCount, submesh.material, { 1.0f, 1.0f, 1.0f } };
+			if (submesh.material >= 0) std::memcpy(converted.diffuse, source.materials[submesh.material].diffuse, sizeof(converted.diffuse));
+			submeshes.push_back(converted);
+		}
+
+		Description description = {};
+		description.attributes = attributes;
+		description.attributeCount = (unsigned int)ConvertedLayout::count;
+		description.stride = (unsigned int)ConvertedLayout::vertexSize();
+		description.vertices = packed.data();
+		description.vertexCount = vertexCount;
+		description.indices = narrowIndices.data();
+		description.indexType = indexType;
+		description.indexCount = indices.size();
+		description.submeshes = submeshes.data();
+		description.submeshCount = (unsigned int)submeshes.size();
+		return write(meshPath, description);
+	}
+
+	std::string cachePath(const char* objPath)
+	{
+		// named after the path, two OBJ files with the same name in different directories must not collide
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.mesh", program_cache::hash(objPath, std::strlen(objPath)));
+		return directory + "/" + name;
+	}
+
+	int openObj(Mesh& mesh, const char* objPath)
+	{
+		std::string path = cachePath(objPath);
+
+		// a converted file older than the OBJ is out of date (an edited MTL alone is not noticed)
+		std::error_code error;
+		auto objTime = std::filesystem::last_write_time(objPath, error);
+		if (error)
+		{
+			std::cout << "ERROR::MESH_FILE::MISSING " << objPath << std::endl;
+			return -1;
+		}
+		auto meshTime = std::filesystem::last_write_time(path, error);
+		if (!error && meshTime >= objTime && open(mesh, path.c_str()) == 0)
+		{
+			stats.hits++;
+			return 0;
+		}
+
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			std::cout << "ERROR::MESH_FILE::CANT_CREATE_DIRECTORY " << directory << std::endl;
+			return -1;
+		}
+		if (convertObj(objPath, path.c_str()) != 0) return -1;
+		stats.conversions++;
+		return open(mesh, path.c_str());
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,122 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <cstddef>
+#include <string>
+#include "mapped_file.h"
+
+// Binary mesh container that is loaded without parsing. The file is mapped and the vertex and index blobs
+// go from the mapping to glBufferData (or into a mapped buffer) as they are, there is no CPU side copy.
+//
+//   Header            magic, version, the vertex layout and where everything else is
+//   Submesh[]         index ranges
+//   vertex blob       vertexCount * stride bytes, starts at a multiple of BLOB_ALIGNMENT
+//   index blob        indexCount indices of indexType, starts at a multiple of BLOB_ALIGNMENT
+//
+// Everything is little endian, like every machine this runs on. OBJ files are converted into the cache
+// directory the first time they are loaded (and again when the OBJ is newer than the converted file).
+namespace mesh_file {
+    const unsigned int MAX_ATTRIBUTES = 8;
+    // cache line size, the mapping itself starts at a page boundary
+    const size_t BLOB_ALIGNMENT = 64;
+
+    // one glVertexAttribPointer call
+    struct Attribute {
+        unsigned int location;
+        unsigned int type;
+        unsigned int components;
+        unsigned int normalized;
+        unsigned int offset;
+    };
+
+    struct Submesh {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        // index of the material in the source file, -1 for none
+        int material;
+        float diffuse[3];
+    };
+
+    struct Header {
+        unsigned int magic;
+        unsigned int version;
+        unsigned int attributeCount;
+        unsigned int stride;
+        Attribute attributes[MAX_ATTRIBUTES];
+        unsigned long long vertexCount;
+        unsigned long long vertexOffset;
+        unsigned int indexType;
+        unsigned int submeshCount;
+        unsigned long long indexCount;
+        unsigned long long indexOffset;
+        unsigned long long submeshOffset;
+        unsigned long long fileSize;
+    };
+
+    // an open mesh file, every pointer points into the mapping
+    struct Mesh {
+        mapped_file::File file;
+        const Header* header;
+        const Submesh* submeshes;
+        const void* vertices;
+        const void* indices;
+        size_t vertexBytes;
+        size_t indexBytes;
+    };
+
+    // what write() stores
+    struct Description {
+        const Attribute* attributes;
+        unsigned int attributeCount;
+        unsigned int stride;
+        const void* vertices;
+        size_t vertexCount;
+        const void* indices;
+        unsigned int indexType;
+        size_t indexCount;
+        const Submesh* submeshes;
+        unsigned int submeshCount;
+    };
+
+    enum UploadMode {
+        // glBufferData straight from the mapping
+        UPLOAD_BUFFER_DATA,
+        // glMapBufferRange and a memcpy from the mapping into it
+        UPLOAD_MAPPED
+    };
+
+    struct Stats {
+        // OBJ files converted because there was no up to date binary
+        unsigned long long conversions;
+        // binaries that were used as they were
+        unsigned long long hits;
+    };
+
+    // where converted OBJ files are stored, "mesh_cache" by default
+    void setDirectory(const char* path);
+
+    // writes the file, through a temporary file so there is never half a mesh under the real name
+    int write(const char* path, const Description& description);
+    // maps the file and checks that everything in the header fits into it
+    int open(Mesh& mesh, const char* path);
+    void close(Mesh& mesh);
+
+    // creates the VAO with its vertex and index buffer filled from the mapping
+    int upload(const Mesh& mesh, unsigned int& VAO, unsigned int& VBO, unsigned int& EBO, UploadMode mode = UPLOAD_BUFFER_DATA);
+    // points the attributes of the bound VAO into buffer
+    void setupAttributes(const Header& header, unsigned int buffer);
+
+    // Loads the OBJ with obj_loader, optimizes every submesh for the vertex cache and overdraw and the whole
+    // mesh for vertex fetch, packs the vertices (float position, 2_10_10_10 normal or color, half texture
+    // coordinates: 20 bytes instead of 32) and writes the result to meshPath.
+    int convertObj(const char* objPath, const char* meshPath);
+    // the converted file of the OBJ in the cache directory
+    std::string cachePath(const char* objPath);
+    // opens the converted OBJ, converts it first if the cache has no up to date version
+    int openObj(Mesh& mesh, const char* objPath);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,330 @@
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <glad/glad.h>
+#include "mesh_optimizer.h"
+
+namespace mesh_optimizer {
+
+	Stats stats = {};
+
+	size_t countCacheMisses(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+	{
+		// the time each vertex was put into the cache, a vertex is in the FIFO if it went in less than
+		// cacheSize misses ago
+		std::vector<size_t> cachedAt(vertexCount, 0);
+		size_t misses = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			unsigned int vertex = indices[i];
+			if (cachedAt[vertex] == 0 || misses - cachedAt[vertex] >= (size_t)cacheSize)
+			{
+				misses++;
+				cachedAt[vertex] = misses;
+			}
+		}
+		return misses;
+	}
+
+	CacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+	{
+		CacheStats result = { 0.0, 0.0 };
+		if (indexCount < 3 || vertexCount == 0) return result;
+
+		size_t misses = countCacheMisses(indices, indexCount, vertexCount, cacheSize);
+		result.acmr = (double)misses / (indexCount / 3);
+		result.atvr = (double)misses / vertexCount;
+		return result;
+	}
+
+	void optimizeVertexCache(unsigned int* out, const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) return;
+
+		// triangles of every vertex: the ones of vertex v are adjacency[offsets[v] .. offsets[v + 1])
+		std::vector<unsigned int> offsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < triangleCount * 3; i++) offsets[indices[i] + 1]++;
+		for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+		std::vector<unsigned int> adjacency(triangleCount * 3);
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			for (int corner = 0; corner < 3; corner++) adjacency[fill[indices[t * 3 + corner]]++] = (unsigned int)t;
+		}
+
+		// triangles of the vertex that are not emitted yet
+		std::vector<unsigned int> live(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++) live[v] = offsets[v + 1] - offsets[v];
+
+		std::vector<size_t> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<unsigned int> deadEnd;
+		std::vector<unsigned int> candidates;
+		size_t time = cacheSize + 1;
+		size_t cursor = 0;
+		size_t written = 0;
+
+		// start fanning around the first vertex that has triangles
+		long long fanning = 0;
+		while (fanning < (long long)vertexCount && live[fanning] == 0) fanning++;
+
+		while (fanning >= 0 && fanning < (long long)vertexCount)
+		{
+			candidates.clear();
+			// emit every triangle around the fanning vertex
+			for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+			{
+				unsigned int t = adjacency[a];
+				if (emitted[t]) continue;
+				emitted[t] = true;
+
+				for (int corner = 0; corner < 3; corner++)
+				{
+					unsigned int v = indices[t * 3 + corner];
+					out[written++] = v;
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					live[v]--;
+					// a miss puts the vertex into the cache
+					if (time - cacheTime[v] > (size_t)cacheSize)
+					{
+						cacheTime[v] = time;
+						time++;
+					}
+				}
+			}
+
+			// The next fanning vertex is the candidate that stays in the cache the longest after its remaining
+			// triangles are emitted. A candidate that would fall out of the cache in the meantime is worth 0.
+			long long next = -1;
+			long long bestPriority = -1;
+			for (unsigned int v : candidates)
+			{
+				if (live[v] == 0) continue;
+				long long priority = 0;
+				if (time - cacheTime[v] + 2 * live[v] <= (size_t)cacheSize) priority = (long long)(time - cacheTime[v]);
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = v;
+				}
+			}
+
+			if (next < 0)
+			{
+				// dead end: go back to a recently used vertex that still has triangles, or take the next one in order
+				while (!deadEnd.empty())
+				{
+					unsigned int v = deadEnd.back();
+					deadEnd.pop_back();
+					if (live[v] > 0)
+					{
+						next = v;
+						break;
+					}
+				}
+				while (next < 0 && cursor < vertexCount)
+				{
+					if (live[cursor] > 0) next = (long long)cursor;
+					cursor++;
+				}
+			}
+
+			fanning = next;
+		}
+	}
+
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		size_t positionStride, float threshold)
+	{
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2) return;
+
+		// split the triangle list into clusters where the cache starts over (all 3 vertices miss),
+		// and also where the ACMR of the cluster so far is good enough to afford a split
+		double meshAcmr = analyzeVertexCache(indices, indexCount, vertexCount).acmr;
+		std::vector<size_t> clusterStarts;
+		{
+			std::vector<size_t> cachedAt(vertexCount, 0);
+			size_t misses = 0, clusterMisses = 0, clusterStart = 0;
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				int triangleMisses = 0;
+				for (int corner = 0; corner < 3; corner++)
+				{
+					unsigned int v = indices[t * 3 + corner];
+					if (cachedAt[v] == 0 || misses - cachedAt[v] >= (size_t)CACHE_SIZE)
+					{
+						misses++;
+						cachedAt[v] = misses;
+						triangleMisses++;
+					}
+				}
+
+				bool hardBoundary = triangleMisses == 3;
+				bool softBoundary = t > clusterStart &&
+					(double)clusterMisses / (t - clusterStart) <= meshAcmr * threshold && t - clusterStart >= 32;
+				if (t == 0 || hardBoundary || softBoundary)
+				{
+					clusterStarts.push_back(t);
+					clusterStart = t;
+					clusterMisses = 0;
+				}
+				clusterMisses += triangleMisses;
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+		size_t clusterCount = clusterStarts.size() - 1;
+
+		auto position = [&](unsigned int vertex) { return positions + vertex * positionStride; };
+
+		// the center of the mesh, weighted by triangle area
+		float meshCenter[3] = { 0, 0, 0 };
+		float meshArea = 0;
+		struct Cluster { float center[3]; float normal[3]; float area; };
+		std::vector<Cluster> clusters(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			Cluster& cluster = clusters[c];
+			cluster = {};
+			for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+			{
+				const float* a = position(indices[t * 3]);
+				const float* b = position(indices[t * 3 + 1]);
+				const float* p = position(indices[t * 3 + 2]);
+				float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				float e2[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+				// the cross product is the normal scaled by twice the area
+				float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5f;
+				for (int i = 0; i < 3; i++)
+				{
+					cluster.center[i] += (a[i] + b[i] + p[i]) / 3.0f * area;
+					cluster.normal[i] += n[i];
+				}
+				cluster.area += area;
+			}
+			for (int i = 0; i < 3; i++) meshCenter[i] += cluster.center[i];
+			meshArea += cluster.area;
+			if (cluster.area > 0)
+			{
+				for (int i = 0; i < 3; i++) cluster.center[i] /= cluster.area;
+			}
+		}
+		if (meshArea > 0)
+		{
+			for (int i = 0; i < 3; i++) meshCenter[i] /= meshArea;
+		}
+
+		// Clusters that face away from the center occlude the others from most view directions,
+		// so they go first. The key does not depend on the camera, the order is computed once.
+		std::vector<float> keys(clusterCount);
+		std::vector<size_t> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			const Cluster& cluster = clusters[c];
+			float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+			float key = 0;
+			if (length > 0)
+			{
+				for (int i = 0; i < 3; i++) key += (cluster.center[i] - meshCenter[i]) * cluster.normal[i] / length;
+			}
+			keys[c] = key;
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+		std::vector<unsigned int> sorted;
+		sorted.reserve(triangleCount * 3);
+		for (size_t c : order)
+		{
+			sorted.insert(sorted.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+		}
+		std::memcpy(indices, sorted.data(), sorted.size() * sizeof(unsigned int));
+	}
+
+	size_t optimizeVertexFetch(void* out, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize)
+	{
+		const unsigned int unused = ~0u;
+		std::vector<unsigned int> remap(vertexCount, unused);
+		size_t next = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			unsigned int& target = remap[indices[i]];
+			if (target == unused)
+			{
+				target = (unsigned int)next++;
+				std::memcpy((unsigned char*)out + target * vertexSize, (const unsigned char*)vertices + indices[i] * vertexSize, vertexSize);
+			}
+			indices[i] = target;
+		}
+		return next;
+	}
+
+	unsigned int indexType(size_t vertexCount)
+	{
+		// Byte indices are the smallest, but some drivers convert them to 16 bit on the CPU before drawing.
+		// They only get picked for tiny meshes, where that copy does not matter.
+		if (vertexCount <= 0x100) return GL_UNSIGNED_BYTE;
+		if (vertexCount <= 0x10000) return GL_UNSIGNED_SHORT;
+		return GL_UNSIGNED_INT;
+	}
+
+	size_t indexSize(unsigned int type)
+	{
+		return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+	}
+
+	unsigned int narrowIndices(std::vector<unsigned char>& out, const unsigned int* indices, size_t indexCount, size_t vertexCount)
+	{
+		unsigned int type = indexType(vertexCount);
+		size_t size = indexSize(type);
+		out.resize(indexCount * size);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			if (size == 1) out[i] = (unsigned char)indices[i];
+			else if (size == 2)
+			{
+				unsigned short index = (unsigned short)indices[i];
+				std::memcpy(&out[i * 2], &index, 2);
+			}
+			else std::memcpy(&out[i * 4], &indices[i], 4);
+		}
+		return type;
+	}
+
+	void optimizeMesh(std::vector<unsigned char>& vertices, size_t& vertexCount, size_t vertexSize, std::vector<unsigned int>& indices)
+	{
+		size_t indexCount = indices.size();
+		stats.meshes++;
+		stats.triangles += indexCount / 3;
+		stats.vertices += vertexCount;
+		stats.missesBefore += countCacheMisses(indices.data(), indexCount, vertexCount, CACHE_SIZE);
+
+		std::vector<unsigned int> ordered(indexCount);
+		optimizeVertexCache(ordered.data(), indices.data(), indexCount, vertexCount);
+		// the positions are the first 3 floats of the vertex
+		optimizeOverdraw(ordered.data(), indexCount, (const float*)vertices.data(), vertexCount, vertexSize / sizeof(float));
+
+		std::vector<unsigned char> fetchOrdered(vertices.size());
+		vertexCount = optimizeVertexFetch(fetchOrdered.data(), ordered.data(), indexCount, vertices.data(), vertexCount, vertexSize);
+		fetchOrdered.resize(vertexCount * vertexSize);
+
+		vertices.swap(fetchOrdered);
+		indices.swap(ordered);
+		stats.missesAfter += countCacheMisses(indices.data(), indexCount, vertexCount, CACHE_SIZE);
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
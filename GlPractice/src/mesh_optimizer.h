@@ -0,0 +1,66 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+// Reorders indexed triangle meshes for the GPU:
+//  - vertex cache: triangles that share vertices are drawn close to each other, so the transformed vertices
+//    are still in the post-transform cache (Tipsify, Sander et al. 2007)
+//  - overdraw: the clusters of the cache ordering are sorted so the ones facing outwards are drawn first
+//  - vertex fetch: vertices are renumbered in the order they are first used, the vertex buffer is read
+//    front to back instead of jumping around
+//  - index width: the indices are stored in the smallest type that can address every vertex
+// The cache is measured with ACMR (average cache miss ratio, transformed vertices per triangle, 0.5 is
+// about the best a regular grid can do, 3 the worst) and ATVR (transformed vertices per vertex, 1 is ideal).
+namespace mesh_optimizer {
+    struct CacheStats {
+        double acmr;
+        double atvr;
+    };
+
+    // before and after optimizeMesh, summed over every optimized mesh since resetStats
+    struct Stats {
+        unsigned long long meshes;
+        unsigned long long triangles;
+        unsigned long long vertices;
+        unsigned long long missesBefore;
+        unsigned long long missesAfter;
+    };
+
+    // the cache size the optimizer and the analysis assume, most GPUs have somewhere between 16 and 32 entries
+    const int CACHE_SIZE = 16;
+
+    // simulates a FIFO post-transform cache over the triangle list
+    CacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize = CACHE_SIZE);
+
+    // reorders the triangles for the vertex cache, out gets indexCount indices (it can not be indices itself)
+    void optimizeVertexCache(unsigned int* out, const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize = CACHE_SIZE);
+
+    // Reorders the clusters of a vertex cache optimized triangle list to reduce overdraw, in place.
+    // positions has a vec3 every positionStride floats. threshold allows clusters to be split where it costs
+    // at most that much ACMR (1.05 = 5% worse), smaller clusters sort better.
+    void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+        size_t positionStride, float threshold = 1.05f);
+
+    // Renumbers the vertices in order of first use and writes them into out, unused vertices are dropped.
+    // indices are changed in place, returns the new vertex count.
+    size_t optimizeVertexFetch(void* out, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize);
+
+    // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the smallest one that can address vertexCount vertices
+    unsigned int indexType(size_t vertexCount);
+    // bytes of an index of the type
+    size_t indexSize(unsigned int type);
+    // stores the indices in the smallest possible type, returns the type
+    unsigned int narrowIndices(std::vector<unsigned char>& out, const unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+    // Runs the vertex cache, overdraw and vertex fetch passes on an interleaved mesh with the position as the
+    // first 3 floats of the vertex. Updates the Stats with the cache numbers before and after.
+    // vertices and indices are changed in place, vertexCount is set to the new count.
+    void optimizeMesh(std::vector<unsigned char>& vertices, size_t& vertexCount, size_t vertexSize, std::vector<unsigned int>& indices);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
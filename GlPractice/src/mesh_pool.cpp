@@ -0,0 +1,279 @@
+#include <iostream>
+#include <glad/glad.h>
+#include "mesh_pool.h"
+#include "mesh_optimizer.h"
+
+namespace mesh_pool {
+
+	Stats stats = {};
+
+	// Creates the buffer objects of the pool at their full size. The uploads go
+	// through GL_COPY_WRITE_BUFFER, binding GL_ELEMENT_ARRAY_BUFFER would change whatever VAO is bound.
+	void createBuffers(const Pool& pool, unsigned int& vertexBuffer, unsigned int& indexBuffer)
+	{
+		glGenBuffers(1, &vertexBuffer);
+		glGenBuffers(1, &indexBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, pool.vertexRanges.capacity * pool.stride, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, pool.indexRanges.capacity * pool.indexSize, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void setupVAO(const Pool& pool)
+	{
+		glBindVertexArray(pool.VAO);
+		pool.setup(pool.vertexBuffer, pool.vertexRanges.capacity, ~0u);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.indexBuffer);
+		glBindVertexArray(0);
+	}
+
+	int create(Pool& pool, SetupFunction setup, size_t stride, unsigned int indexType, size_t vertexCapacity, size_t indexCapacity)
+	{
+		pool = {};
+		pool.stride = stride;
+		pool.indexType = indexType;
+		pool.indexSize = mesh_optimizer::indexSize(indexType);
+		pool.setup = setup;
+		range_allocator::create(pool.vertexRanges, vertexCapacity);
+		range_allocator::create(pool.indexRanges, indexCapacity);
+		if (pool.vertexRanges.capacity == 0 || pool.indexRanges.capacity == 0)
+		{
+			std::cout << "ERROR::MESH_POOL::INVALID_CAPACITY" << std::endl;
+			return -1;
+		}
+
+		createBuffers(pool, pool.vertexBuffer, pool.indexBuffer);
+		glGenVertexArrays(1, &pool.VAO);
+		setupVAO(pool);
+		return 0;
+	}
+
+	void destroy(Pool& pool)
+	{
+		glDeleteVertexArrays(1, &pool.VAO);
+		glDeleteBuffers(1, &pool.vertexBuffer);
+		glDeleteBuffers(1, &pool.indexBuffer);
+		pool = {};
+	}
+
+	bool fits(const Pool& pool, size_t vertexCount, size_t indexCount)
+	{
+		return range_allocator::largestFree(pool.vertexRanges) >= vertexCount && range_allocator::largestFree(pool.indexRanges) >= indexCount;
+	}
+
+	// defragments the pool if that makes the ranges fit, false if they do not fit at all
+	bool makeRoom(Pool& pool, size_t vertexCount, size_t indexCount)
+	{
+		if (fits(pool, vertexCount, indexCount)) return true;
+		// there is enough space if the holes were one range
+		bool enough = pool.vertexRanges.capacity - pool.vertexRanges.used >= vertexCount
+			&& pool.indexRanges.capacity - pool.indexRanges.used >= indexCount;
+		if (!enough || defragment(pool) != 0 || !fits(pool, vertexCount, indexCount))
+		{
+			std::cout << "ERROR::MESH_POOL::FULL" << std::endl;
+			stats.failedAdds++;
+			return false;
+		}
+		return true;
+	}
+
+	range_allocator::Handle uploadIndices(Pool& pool, const void* indices, size_t indexCount)
+	{
+		range_allocator::Handle range = range_allocator::allocate(pool.indexRanges, indexCount);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, pool.indexBuffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, range_allocator::offset(pool.indexRanges, range) * pool.indexSize, indexCount * pool.indexSize, indices);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return range;
+	}
+
+	Handle add(Pool& pool, const void* vertices, size_t vertexCount, const void* indices, size_t indexCount)
+	{
+		if (!makeRoom(pool, vertexCount, indexCount)) return -1;
+
+		Mesh mesh;
+		mesh.vertices = range_allocator::allocate(pool.vertexRanges, vertexCount);
+		mesh.levels.push_back(uploadIndices(pool, indices, indexCount));
+		mesh.indexCounts.push_back((unsigned int)indexCount);
+		mesh.live = true;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vertexBuffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, range_allocator::offset(pool.vertexRanges, mesh.vertices) * pool.stride, vertexCount * pool.stride, vertices);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		Handle handle;
+		if (!pool.freeHandles.empty())
+		{
+			handle = pool.freeHandles.back();
+			pool.freeHandles.pop_back();
+			pool.meshes[handle] = mesh;
+		}
+		else
+		{
+			handle = (Handle)pool.meshes.size();
+			pool.meshes.push_back(mesh);
+		}
+		stats.adds++;
+		return handle;
+	}
+
+	bool valid(const Pool& pool, Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)pool.meshes.size() || !pool.meshes[handle].live)
+		{
+			std::cout << "ERROR::MESH_POOL::INVALID_HANDLE " << handle << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	int addLevel(Pool& pool, Handle handle, const void* indices, size_t indexCount)
+	{
+		if (!valid(pool, handle) || !makeRoom(pool, 0, indexCount)) return -1;
+		Mesh& mesh = pool.meshes[handle];
+		mesh.levels.push_back(uploadIndices(pool, indices, indexCount));
+		mesh.indexCounts.push_back((unsigned int)indexCount);
+		return (int)mesh.levels.size() - 1;
+	}
+
+	void remove(Pool& pool, Handle handle)
+	{
+		if (!valid(pool, handle)) return;
+		Mesh& mesh = pool.meshes[handle];
+		// the data stays in the buffers until something else is put there
+		range_allocator::free(pool.vertexRanges, mesh.vertices);
+		for (range_allocator::Handle level : mesh.levels) range_allocator::free(pool.indexRanges, level);
+		mesh.levels.clear();
+		mesh.indexCounts.clear();
+		mesh.live = false;
+		pool.freeHandles.push_back(handle);
+		stats.removes++;
+	}
+
+	int baseVertex(const Pool& pool, Handle mesh)
+	{
+		return (int)range_allocator::offset(pool.vertexRanges, pool.meshes[mesh].vertices);
+	}
+
+	size_t firstIndex(const Pool& pool, Handle mesh, int level)
+	{
+		return range_allocator::offset(pool.indexRanges, pool.meshes[mesh].levels[level]);
+	}
+
+	unsigned int indexCount(const Pool& pool, Handle mesh, int level)
+	{
+		return pool.meshes[mesh].indexCounts[level];
+	}
+
+	int levelCount(const Pool& pool, Handle mesh)
+	{
+		return (int)pool.meshes[mesh].levels.size();
+	}
+
+	void bind(const Pool& pool)
+	{
+		glBindVertexArray(pool.VAO);
+	}
+
+	void draw(const Pool& pool, Handle mesh, int level)
+	{
+		glDrawElementsBaseVertex(GL_TRIANGLES, indexCount(pool, mesh, level), pool.indexType,
+			(void*)(firstIndex(pool, mesh, level) * pool.indexSize), baseVertex(pool, mesh));
+	}
+
+	void appendDraw(Pool& pool, Handle mesh, int level)
+	{
+		pool.counts.push_back((int)indexCount(pool, mesh, level));
+		pool.offsets.push_back((const void*)(firstIndex(pool, mesh, level) * pool.indexSize));
+		pool.baseVertices.push_back(baseVertex(pool, mesh));
+	}
+
+	void multiDraw(Pool& pool)
+	{
+		if (!pool.counts.empty())
+		{
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, pool.counts.data(), pool.indexType, pool.offsets.data(),
+				(GLsizei)pool.counts.size(), pool.baseVertices.data());
+		}
+		pool.counts.clear();
+		pool.offsets.clear();
+		pool.baseVertices.clear();
+	}
+
+	void draw(Pool& pool, const Handle* meshes, size_t count, const int* levels)
+	{
+		for (size_t i = 0; i < count; i++) appendDraw(pool, meshes[i], levels ? levels[i] : 0);
+		multiDraw(pool);
+	}
+
+	void drawAll(Pool& pool)
+	{
+		for (Handle mesh = 0; mesh < (Handle)pool.meshes.size(); mesh++)
+		{
+			if (pool.meshes[mesh].live) appendDraw(pool, mesh, 0);
+		}
+		multiDraw(pool);
+	}
+
+	// copies every range to where compact() put it, from one buffer into the other
+	void copyRanges(unsigned int from, unsigned int to, const std::vector<range_allocator::Move>& moves, size_t unitSize)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, from);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, to);
+		for (const range_allocator::Move& move : moves)
+		{
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from * unitSize, move.to * unitSize, move.size * unitSize);
+			stats.movedBytes += move.size * unitSize;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	int defragment(Pool& pool)
+	{
+		// A move inside one buffer would overlap with itself whenever a mesh slides down by less than its
+		// size, which glCopyBufferSubData does not allow. Copying into new buffers avoids that, the GPU
+		// does the copies in order with the draws, and for the moment the pool takes twice the memory.
+		std::vector<range_allocator::Move> vertexMoves, indexMoves;
+		range_allocator::compact(pool.vertexRanges, vertexMoves);
+		range_allocator::compact(pool.indexRanges, indexMoves);
+
+		unsigned int vertexBuffer, indexBuffer;
+		createBuffers(pool, vertexBuffer, indexBuffer);
+		copyRanges(pool.vertexBuffer, vertexBuffer, vertexMoves, pool.stride);
+		copyRanges(pool.indexBuffer, indexBuffer, indexMoves, pool.indexSize);
+
+		glDeleteBuffers(1, &pool.vertexBuffer);
+		glDeleteBuffers(1, &pool.indexBuffer);
+		pool.vertexBuffer = vertexBuffer;
+		pool.indexBuffer = indexBuffer;
+		setupVAO(pool);
+		stats.defragments++;
+		return 0;
+	}
+
+	double fragmentation(const Pool& pool)
+	{
+		double worst = 0.0;
+		const range_allocator::Allocator* allocators[] = { &pool.vertexRanges, &pool.indexRanges };
+		for (const range_allocator::Allocator* allocator : allocators)
+		{
+			size_t free = allocator->capacity - allocator->used;
+			if (free == 0) continue;
+			double fragmented = 1.0 - (double)range_allocator::largestFree(*allocator) / free;
+			if (fragmented > worst) worst = fragmented;
+		}
+		return worst;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,110 @@
+#ifndef MESH_POOL_H
+#define MESH_POOL_H
+
+#include <cstddef>
+#include <vector>
+#include "range_allocator.h"
+
+// Many meshes of one vertex layout in one vertex buffer, one index buffer and one VAO.
+// The buffers are allocated once at their full capacity, the meshes get ranges of them from a TLSF
+// allocator (range_allocator) counted in vertices and indices, so a mesh is drawn with the same VAO as
+// every other one, only with its own base vertex and first index. Removing meshes leaves holes,
+// defragment() packs the meshes to the front again by copying them into fresh buffers on the GPU.
+//
+// A mesh can have levels of detail, more index ranges into its vertices (mesh_simplifier only collapses
+// vertices onto other vertices, so every level uses the same ones). Level 0 is the mesh that was added.
+//
+//     mesh_pool::Pool pool;
+//     mesh_pool::create<Layout>(pool, GL_UNSIGNED_INT, 1 << 20, 1 << 22);
+//     mesh_pool::Handle mesh = mesh_pool::add(pool, vertices, vertexCount, indices, indexCount);
+//     mesh_pool::bind(pool);
+//     mesh_pool::drawAll(pool);
+//
+// Only interleaved layouts, a mesh has to be one contiguous range of the vertex buffer.
+namespace mesh_pool {
+    typedef int Handle;
+
+    // VertexLayout::setup, points the attributes of the bound VAO into buffer
+    typedef void (*SetupFunction)(unsigned int buffer, size_t vertexCount, unsigned int attributeMask);
+
+    struct Mesh {
+        range_allocator::Handle vertices;
+        // one index range per level of detail, the finest first
+        std::vector<range_allocator::Handle> levels;
+        std::vector<unsigned int> indexCounts;
+        bool live;
+    };
+
+    struct Pool {
+        unsigned int VAO;
+        unsigned int vertexBuffer;
+        unsigned int indexBuffer;
+        size_t stride;
+        unsigned int indexType;
+        size_t indexSize;
+        SetupFunction setup;
+        range_allocator::Allocator vertexRanges;
+        range_allocator::Allocator indexRanges;
+        std::vector<Mesh> meshes;
+        std::vector<Handle> freeHandles;
+        // the arguments of the last multi-draw, kept so they are not allocated every frame
+        std::vector<int> counts;
+        std::vector<const void*> offsets;
+        std::vector<int> baseVertices;
+    };
+
+    struct Stats {
+        unsigned long long adds;
+        unsigned long long removes;
+        // adds that did not fit, even after defragmenting
+        unsigned long long failedAdds;
+        unsigned long long defragments;
+        // bytes copied by the defragments
+        unsigned long long movedBytes;
+    };
+
+    // Creates the buffers, vertexCapacity vertices of stride bytes and indexCapacity indices of indexType.
+    int create(Pool& pool, SetupFunction setup, size_t stride, unsigned int indexType, size_t vertexCapacity, size_t indexCapacity);
+    template <typename Layout>
+    int create(Pool& pool, unsigned int indexType, size_t vertexCapacity, size_t indexCapacity)
+    {
+        static_assert(Layout::interleaved, "a mesh pool needs an interleaved layout");
+        return create(pool, &Layout::setup, Layout::vertexSize(), indexType, vertexCapacity, indexCapacity);
+    }
+    void destroy(Pool& pool);
+
+    // Copies the mesh into the buffers, the indices are of the pool's index type and start at 0 for the first
+    // vertex of the mesh. Defragments the pool if that makes it fit, returns -1 if it does not fit at all.
+    Handle add(Pool& pool, const void* vertices, size_t vertexCount, const void* indices, size_t indexCount);
+    // Adds the next coarser level of detail, the indices refer to the vertices of the mesh like the ones given
+    // to add(). Returns the number of the level, -1 if it does not fit.
+    int addLevel(Pool& pool, Handle mesh, const void* indices, size_t indexCount);
+    // frees the vertices and every level
+    void remove(Pool& pool, Handle mesh);
+
+    // where the mesh is, for glDrawElementsBaseVertex
+    int baseVertex(const Pool& pool, Handle mesh);
+    size_t firstIndex(const Pool& pool, Handle mesh, int level = 0);
+    unsigned int indexCount(const Pool& pool, Handle mesh, int level = 0);
+    int levelCount(const Pool& pool, Handle mesh);
+
+    void bind(const Pool& pool);
+    // draws one mesh, the pool has to be bound
+    void draw(const Pool& pool, Handle mesh, int level = 0);
+    // draws the meshes with one glMultiDrawElementsBaseVertex, the pool has to be bound.
+    // levels has the level of detail of every mesh, NULL draws them all at level 0.
+    void draw(Pool& pool, const Handle* meshes, size_t count, const int* levels = NULL);
+    void drawAll(Pool& pool);
+
+    // Packs the meshes to the front of new buffers, the free space becomes one range at the end.
+    // The handles stay valid.
+    int defragment(Pool& pool);
+    // how much of the free vertex and index space can not be used for a mesh of the largest size that fits,
+    // 0 when all of it is one range
+    double fragmentation(const Pool& pool);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
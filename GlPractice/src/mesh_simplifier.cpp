@@ -0,0 +1,378 @@
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <cstring>
+#include "mesh_simplifier.h"
+
+namespace mesh_simplifier {
+
+	// symmetric 4x4 matrix of the plane equations, error(p) = p'Ap + 2b'p + c
+	struct Quadric {
+		double a00, a11, a22, a01, a02, a12;
+		double b0, b1, b2;
+		double c;
+		// area of the triangles it was built from
+		double weight;
+	};
+
+	struct Collapse {
+		unsigned int from;
+		unsigned int to;
+		double cost;
+	};
+
+	void add(Quadric& q, const Quadric& other)
+	{
+		q.a00 += other.a00; q.a11 += other.a11; q.a22 += other.a22;
+		q.a01 += other.a01; q.a02 += other.a02; q.a12 += other.a12;
+		q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+		q.c += other.c;
+		q.weight += other.weight;
+	}
+
+	double evaluate(const Quadric& q, const double* p)
+	{
+		double x = p[0], y = p[1], z = p[2];
+		double error = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z
+			+ 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z)
+			+ 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+		// rounding can take it slightly below 0
+		return error < 0.0 ? 0.0 : error;
+	}
+
+	// the plane through the triangle, weighted by its area
+	Quadric planeQuadric(const double* p0, const double* p1, const double* p2)
+	{
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		Quadric q = {};
+		if (length == 0.0) return q;
+		double area = length * 0.5;
+		n[0] /= length; n[1] /= length; n[2] /= length;
+		double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+		q.a00 = area * n[0] * n[0]; q.a11 = area * n[1] * n[1]; q.a22 = area * n[2] * n[2];
+		q.a01 = area * n[0] * n[1]; q.a02 = area * n[0] * n[2]; q.a12 = area * n[1] * n[2];
+		q.b0 = area * n[0] * d; q.b1 = area * n[1] * d; q.b2 = area * n[2] * d;
+		q.c = area * d * d;
+		q.weight = area;
+		return q;
+	}
+
+	// twice the area over the squared longest edge, 0.87 for an equilateral triangle, 0 for a sliver
+	double shape(const double* p0, const double* p1, const double* p2)
+	{
+		const double* p[3] = { p0, p1, p2 };
+		double longest = 0.0;
+		for (int k = 0; k < 3; k++)
+		{
+			double e[3] = { p[(k + 1) % 3][0] - p[k][0], p[(k + 1) % 3][1] - p[k][1], p[(k + 1) % 3][2] - p[k][2] };
+			longest = std::max(longest, e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+		}
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		return longest > 0.0 ? std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) / longest : 0.0;
+	}
+
+	// the unit normal, returns false for a triangle without area
+	bool normal(const double* p0, const double* p1, const double* p2, double* n)
+	{
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0) return false;
+		n[0] /= length; n[1] /= length; n[2] /= length;
+		return true;
+	}
+
+	// A moved triangle may turn by less than about 75 degrees, against what it was and against the input
+	// surface around its vertices, so small turns do not add up to a fold over the passes. It may also not
+	// become thinner than minShape (see shape): three vertices along a straight locked border make a
+	// triangle that stands on its edge, but only turns as far as the surface slopes.
+	const double minNormalDot = 0.25;
+	const double minShape = 0.1;
+
+	// Marks the vertices that must not move: the ones on an open border (an edge only one triangle uses)
+	// and the ones that have the same position as another vertex.
+	void findLockedVertices(std::vector<bool>& locked, const unsigned int* indices, size_t indexCount, const std::vector<double>& positions, size_t vertexCount)
+	{
+		locked.assign(vertexCount, false);
+
+		// vertices at the same position are welded into the first of them for the border search
+		struct PositionHash {
+			const std::vector<double>* positions;
+			size_t operator()(unsigned int v) const
+			{
+				unsigned long long h = 0;
+				for (int i = 0; i < 3; i++)
+				{
+					double value = (*positions)[v * 3 + i];
+					unsigned long long bits;
+					std::memcpy(&bits, &value, sizeof(bits));
+					h = (h ^ bits) * 0x100000001b3ull;
+				}
+				return (size_t)(h ^ (h >> 32));
+			}
+		};
+		struct PositionEqual {
+			const std::vector<double>* positions;
+			bool operator()(unsigned int a, unsigned int b) const
+			{
+				return std::memcmp(&(*positions)[a * 3], &(*positions)[b * 3], 3 * sizeof(double)) == 0;
+			}
+		};
+		std::unordered_map<unsigned int, unsigned int, PositionHash, PositionEqual> firstAtPosition(vertexCount,
+			PositionHash{ &positions }, PositionEqual{ &positions });
+		std::vector<unsigned int> welded(vertexCount);
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			auto found = firstAtPosition.emplace(v, v);
+			welded[v] = found.first->second;
+			if (!found.second)
+			{
+				locked[v] = true;
+				locked[found.first->second] = true;
+			}
+		}
+
+		// the edges between welded vertices, counted in both directions
+		std::unordered_map<unsigned long long, int> edges(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				unsigned long long a = welded[indices[i + e]], b = welded[indices[i + (e + 1) % 3]];
+				edges[a < b ? (a << 32 | b) : (b << 32 | a)]++;
+			}
+		}
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				unsigned long long a = welded[indices[i + e]], b = welded[indices[i + (e + 1) % 3]];
+				if (edges[a < b ? (a << 32 | b) : (b << 32 | a)] == 1)
+				{
+					locked[indices[i + e]] = true;
+					locked[indices[i + (e + 1) % 3]] = true;
+				}
+			}
+		}
+	}
+
+	size_t simplify(unsigned int* out, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount,
+		size_t vertexStride, size_t targetIndexCount, float targetError, float* resultError,
+		const float* attributeWeights, size_t attributeCount)
+	{
+		std::copy(indices, indices + indexCount, out);
+		if (resultError != NULL) *resultError = 0.0f;
+		if (indexCount == 0 || vertexCount == 0) return indexCount;
+
+		// the positions scaled into a unit box, so the errors do not depend on the size of the mesh
+		double minimum[3] = { 1e300, 1e300, 1e300 }, maximum[3] = { -1e300, -1e300, -1e300 };
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				minimum[i] = std::min(minimum[i], (double)vertices[v * vertexStride + i]);
+				maximum[i] = std::max(maximum[i], (double)vertices[v * vertexStride + i]);
+			}
+		}
+		double extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+		double scale = extent > 0.0 ? 1.0 / extent : 1.0;
+		std::vector<double> positions(vertexCount * 3);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			for (int i = 0; i < 3; i++) positions[v * 3 + i] = (vertices[v * vertexStride + i] - minimum[i]) * scale;
+		}
+
+		std::vector<bool> locked;
+		findLockedVertices(locked, indices, indexCount, positions, vertexCount);
+
+		std::vector<Quadric> quadrics(vertexCount, Quadric{});
+		// the area weighted normal of the input triangles around every vertex, a collapse adds from's to to's
+		// like the quadrics, so the folds are judged against the mesh and not against what earlier passes left
+		std::vector<double> surfaceNormals(vertexCount * 3, 0.0);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const double* p[3] = { &positions[indices[i] * 3], &positions[indices[i + 1] * 3], &positions[indices[i + 2] * 3] };
+			Quadric q = planeQuadric(p[0], p[1], p[2]);
+			double n[3];
+			normal(p[0], p[1], p[2], n);
+			for (int k = 0; k < 3; k++)
+			{
+				add(quadrics[indices[i + k]], q);
+				for (int j = 0; j < 3; j++) surfaceNormals[indices[i + k] * 3 + j] += n[j] * q.weight;
+			}
+		}
+
+		// the errors are squared distances, so is the limit
+		double errorLimit = (double)targetError * targetError;
+		double maxError = 0.0;
+		size_t count = indexCount;
+		std::vector<unsigned int> remap(vertexCount);
+		std::vector<unsigned int> triangleOffsets(vertexCount + 1), vertexTriangles;
+		std::vector<bool> touched(vertexCount);
+		// the last link test that found the vertex around its from, and the opposite vertices of that test
+		std::vector<unsigned int> neighbourMark(vertexCount, 0);
+		unsigned int linkTest = 0;
+		std::vector<unsigned int> opposite;
+		std::vector<Collapse> collapses;
+
+		while (count > targetIndexCount)
+		{
+			// the triangles around every vertex
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+			for (size_t i = 0; i < count; i++) triangleOffsets[out[i] + 1]++;
+			for (size_t v = 0; v < vertexCount; v++) triangleOffsets[v + 1] += triangleOffsets[v];
+			vertexTriangles.resize(count);
+			std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (size_t i = 0; i < count; i++) vertexTriangles[fill[out[i]]++] = (unsigned int)(i / 3);
+
+			// every edge in the direction(s) it may collapse
+			collapses.clear();
+			for (size_t i = 0; i < count; i += 3)
+			{
+				for (int e = 0; e < 3; e++)
+				{
+					unsigned int a = out[i + e], b = out[i + (e + 1) % 3];
+					unsigned int ends[2][2] = { { a, b }, { b, a } };
+					for (auto& end : ends)
+					{
+						unsigned int from = end[0], to = end[1];
+						if (locked[from]) continue;
+						Quadric q = quadrics[from];
+						add(q, quadrics[to]);
+						// divided by the area, the cost is the mean squared distance to the planes
+						double cost = q.weight > 0.0 ? evaluate(q, &positions[to * 3]) / q.weight : 0.0;
+						for (size_t k = 0; k < attributeCount; k++)
+						{
+							double difference = (double)vertices[from * vertexStride + 3 + k] - vertices[to * vertexStride + 3 + k];
+							cost += attributeWeights[k] * difference * difference;
+						}
+						collapses.push_back({ from, to, cost });
+					}
+				}
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			// Collapse the cheapest edges that do not share a triangle with a collapse of this pass, then rebuild.
+			// A collapse removes about two triangles.
+			size_t collapseLimit = (count - targetIndexCount) / 6 + 1;
+			size_t collapsed = 0;
+			for (unsigned int v = 0; v < vertexCount; v++) remap[v] = v;
+			std::fill(touched.begin(), touched.end(), false);
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.cost > errorLimit || collapsed >= collapseLimit) break;
+				if (touched[collapse.from] || touched[collapse.to]) continue;
+
+				// The link condition: the only vertices from and to may both be connected to are the third vertices
+				// of the triangles on their edge, otherwise the collapse glues two sheets of the mesh together
+				// and leaves an edge that more than two triangles use (a fin).
+				bool manifold = true;
+				linkTest++;
+				opposite.clear();
+				for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++)
+				{
+					const unsigned int* triangle = &out[vertexTriangles[t] * 3];
+					bool hasTo = triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to;
+					for (int k = 0; k < 3; k++)
+					{
+						if (triangle[k] == collapse.from || triangle[k] == collapse.to) continue;
+						if (hasTo) opposite.push_back(triangle[k]);
+						neighbourMark[triangle[k]] = linkTest;
+					}
+				}
+				// an edge of more than two triangles is not manifold already
+				if (opposite.size() > 2) manifold = false;
+				for (unsigned int t = triangleOffsets[collapse.to]; t < triangleOffsets[collapse.to + 1] && manifold; t++)
+				{
+					const unsigned int* triangle = &out[vertexTriangles[t] * 3];
+					for (int k = 0; k < 3 && manifold; k++)
+					{
+						unsigned int v = triangle[k];
+						if (v == collapse.from || v == collapse.to || neighbourMark[v] != linkTest) continue;
+						manifold = std::find(opposite.begin(), opposite.end(), v) != opposite.end();
+					}
+				}
+				if (!manifold) continue;
+
+				// the triangles around from must not flip or fold when it moves to to
+				bool flips = false;
+				for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++)
+				{
+					const unsigned int* triangle = &out[vertexTriangles[t] * 3];
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) continue;
+					const double* before[3];
+					const double* after[3];
+					for (int k = 0; k < 3; k++)
+					{
+						before[k] = &positions[triangle[k] * 3];
+						after[k] = triangle[k] == collapse.from ? &positions[collapse.to * 3] : before[k];
+					}
+					double n0[3], n1[3];
+					bool hadArea = normal(before[0], before[1], before[2], n0);
+					bool hasArea = normal(after[0], after[1], after[2], n1);
+					// one without area (at a pole, where the vertices are at the same place) may not get some,
+					// it would face any direction
+					if (!hadArea)
+					{
+						flips = hasArea;
+						continue;
+					}
+					// the surface of the input around its vertices, from's part already belongs to to
+					double surface[3] = {};
+					for (int k = 0; k < 3; k++)
+					{
+						for (int j = 0; j < 3; j++) surface[j] += surfaceNormals[triangle[k] * 3 + j];
+						if (triangle[k] == collapse.from)
+						{
+							for (int j = 0; j < 3; j++) surface[j] += surfaceNormals[collapse.to * 3 + j];
+						}
+					}
+					double length = std::sqrt(surface[0] * surface[0] + surface[1] * surface[1] + surface[2] * surface[2]);
+					double shapeAfter = shape(after[0], after[1], after[2]);
+					flips = !hasArea || n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= minNormalDot
+						|| (length > 0.0 && (n1[0] * surface[0] + n1[1] * surface[1] + n1[2] * surface[2]) / length <= minNormalDot)
+						|| (shapeAfter < minShape && shapeAfter < shape(before[0], before[1], before[2]));
+				}
+				if (flips) continue;
+
+				// nothing around from may change again in this pass, the flip test above would be outdated
+				for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++)
+				{
+					const unsigned int* triangle = &out[vertexTriangles[t] * 3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+				}
+				remap[collapse.from] = collapse.to;
+				add(quadrics[collapse.to], quadrics[collapse.from]);
+				for (int j = 0; j < 3; j++) surfaceNormals[collapse.to * 3 + j] += surfaceNormals[collapse.from * 3 + j];
+				maxError = std::max(maxError, collapse.cost);
+				collapsed++;
+			}
+			if (collapsed == 0) break;
+
+			// move the collapsed vertices and drop the triangles that lost an edge
+			size_t kept = 0;
+			for (size_t i = 0; i < count; i += 3)
+			{
+				unsigned int a = remap[out[i]], b = remap[out[i + 1]], c = remap[out[i + 2]];
+				if (a == b || b == c || a == c) continue;
+				out[kept++] = a;
+				out[kept++] = b;
+				out[kept++] = c;
+			}
+			count = kept;
+		}
+
+		if (resultError != NULL) *resultError = (float)std::sqrt(maxError);
+		return count;
+	}
+
+}
@@ -0,0 +1,32 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+
+// Reduces the triangle count of an indexed mesh by collapsing edges (Garland & Heckbert 1997, quadric
+// error metrics). Every vertex gets the sum of the squared distances to the planes of its triangles
+// (a quadric), a collapse moves a vertex onto a neighbour and costs the quadric error at the neighbour's
+// position, the cheapest collapses go first. Vertices are only ever moved onto other vertices, so the
+// result is a new index buffer for the same vertex buffer and every level of detail can share it.
+//
+// Attribute aware: the change of the attributes (the floats after the position, weighted) is added to
+// the cost, so a collapse across a color or texture coordinate change is more expensive than one
+// across a flat area. Vertices on an open border and vertices that share their position with another
+// vertex (uv seams, material boundaries) never move, the outline and the seams stay where they are.
+//
+// A collapse is skipped when it would change the topology (from and to share a neighbour that is not on
+// one of their common triangles, the result would have an edge of more than two triangles), or when a
+// triangle around from would fold over, turn too far from the input surface or become a sliver.
+namespace mesh_simplifier {
+    // Writes the simplified triangles into out (room for indexCount indices, it can not be indices itself) and
+    // returns how many indices it wrote. Stops at targetIndexCount indices or when the next collapse would cost
+    // more than targetError, relative to the size of the mesh (0.01 = 1% of its largest extent).
+    // vertices has vertexStride floats per vertex, the position first; attributeCount floats after the
+    // position are weighted by attributeWeights (can be NULL if attributeCount is 0).
+    // resultError, if not NULL, gets the error of the result in the same units as targetError.
+    size_t simplify(unsigned int* out, const unsigned int* indices, size_t indexCount, const float* vertices, size_t vertexCount,
+        size_t vertexStride, size_t targetIndexCount, float targetError, float* resultError = NULL,
+        const float* attributeWeights = NULL, size_t attributeCount = 0);
+}
+
+#endif
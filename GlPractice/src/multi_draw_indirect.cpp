@@ -0,0 +1,293 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <glad/glad.h>
+#include "multi_draw_indirect.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "program_cache.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
+#include "instance_buffer.h"
+#include "mesh_pool.h"
+#include "indirect_draw.h"
+
+namespace multi_draw_indirect {
+
+	const int gridSize = 64;
+	const int minSides = 3;
+	const int maxSides = 48;
+	// threads of one compute work group, the shader has the same number
+	const int groupSize = 64;
+
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 2>> VertexLayout;
+
+	// the per-draw data, std430 lays it out the same way for the compute shader
+	struct Draw {
+		// position, scale and rotation of the polygon
+		float x, y, scale, phase;
+		float r, g, b, a;
+	};
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	mesh_pool::Pool pool;
+	indirect_draw::Buffer draws;
+	// the per-draw data, an instance buffer for the vertex shader and a storage buffer for the compute shader
+	unsigned int drawBuffer;
+	// the commands as written at init, the compute shader copies them with its own instance counts
+	unsigned int sourceBuffer;
+	unsigned int cullProgram;
+	float elapsedTime;
+	unsigned int randomState;
+	uniform_table::Table uniformTable;
+	uniform_table::FloatHandle timeHandle = { -1 };
+	uniform_table::Table cullTable;
+	uniform_table::FloatHandle cullTimeHandle = { -1 };
+	uniform_table::IntHandle drawCountHandle = { -1 };
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+// per draw, instanced attributes read at the baseInstance of the command
+layout (location = 1) in vec4 aTransform;
+layout (location = 2) in vec4 aColor;
+
+uniform float time;
+
+out vec4 vtxColor;
+
+void main()
+{
+    float angle = aTransform.w + time;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    gl_Position = vec4(rotation * aPos * aTransform.z + aTransform.xy, 0.0, 1.0);
+    vtxColor = aColor;
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+
+in vec4 vtxColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vtxColor;
+}
+)";
+	const char* cullShaderSrc = R"(
+#version 430 core
+
+layout (local_size_x = 64) in;
+
+struct Command {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+struct Draw {
+    vec4 transform;
+    vec4 color;
+};
+
+layout (std430, binding = 0) readonly buffer Source { Command source[]; };
+layout (std430, binding = 1) writeonly buffer Commands { Command commands[]; };
+layout (std430, binding = 2) readonly buffer Draws { Draw draws[]; };
+
+uniform float time;
+uniform int drawCount;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= uint(drawCount)) return;
+    Command command = source[id];
+    vec2 center = 0.5 * vec2(cos(time * 0.7), sin(time));
+    command.instanceCount = distance(draws[id].transform.xy, center) < 0.6 ? 1u : 0u;
+    commands[id] = command;
+}
+)";
+
+	void registerScene()
+	{
+		scene::registerScene({ "multi_draw_indirect", init, update, render, shutdown });
+		scene::registerScene({ "multi_draw_indirect_gpu", initGpu, update, renderGpu, shutdown });
+	}
+
+	unsigned int nextRandom()
+	{
+		randomState = randomState * 1664525u + 1013904223u;
+		return randomState >> 8;
+	}
+
+	int init()
+	{
+		if (initShaders() != 0) return -1;
+		return initMeshes();
+	}
+
+	int initGpu()
+	{
+		if (init() != 0) return -1;
+		unsigned int shader = program_cache::compileShader(GL_COMPUTE_SHADER, cullShaderSrc);
+		if (shader == 0) return -1;
+		cullProgram = glCreateProgram();
+		glAttachShader(cullProgram, shader);
+		int linked = program_cache::linkProgram(cullProgram);
+		glDeleteShader(shader);
+		if (linked != 0) return -1;
+		uniform_table::build(cullTable, cullProgram);
+		cullTimeHandle = uniform_table::getFloat(cullTable, "time");
+		drawCountHandle = uniform_table::getInt(cullTable, "drawCount");
+
+		glGenBuffers(1, &sourceBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, sourceBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, draws.commands.size() * sizeof(indirect_draw::Command), draws.commands.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return 0;
+	}
+
+	int initMeshes()
+	{
+		if (!indirect_draw::supported())
+		{
+			std::cout << "ERROR::MULTI_DRAW_INDIRECT::NOT_SUPPORTED" << std::endl;
+			return -1;
+		}
+
+		// one polygon of every number of sides, a fan around the center
+		size_t meshCount = maxSides - minSides + 1;
+		size_t vertexCapacity = 0, indexCapacity = 0;
+		for (int sides = minSides; sides <= maxSides; sides++)
+		{
+			vertexCapacity += sides + 1;
+			indexCapacity += sides * 3;
+		}
+		if (mesh_pool::create<VertexLayout>(pool, GL_UNSIGNED_SHORT, vertexCapacity, indexCapacity) != 0) return -1;
+		std::vector<mesh_pool::Handle> meshes(meshCount);
+		for (int sides = minSides; sides <= maxSides; sides++)
+		{
+			std::vector<float> positions = { 0.0f, 0.0f };
+			std::vector<unsigned short> indices;
+			for (int i = 0; i < sides; i++)
+			{
+				float angle = 6.2831853f * i / sides;
+				positions.insert(positions.end(), { std::cos(angle), std::sin(angle) });
+				indices.insert(indices.end(), { 0, (unsigned short)(1 + i), (unsigned short)(1 + (i + 1) % sides) });
+			}
+			size_t vertexCount = sides + 1;
+			std::vector<unsigned char> vertices(VertexLayout::bufferSize(vertexCount));
+			VertexLayout::fill<0>(vertices.data(), vertexCount, positions.data());
+			meshes[sides - minSides] = mesh_pool::add(pool, vertices.data(), vertexCount, indices.data(), indices.size());
+			if (meshes[sides - minSides] < 0) return -1;
+		}
+
+		// a command and the per-draw data for every cell, the draw ID ties them together
+		size_t drawCount = gridSize * gridSize;
+		if (indirect_draw::create(draws, drawCount) != 0) return -1;
+		std::vector<Draw> drawData(drawCount);
+		randomState = 12345;
+		const float cellSize = 2.0f / gridSize;
+		for (size_t cell = 0; cell < drawCount; cell++)
+		{
+			int id = indirect_draw::add(draws, pool, meshes[nextRandom() % meshCount]);
+			Draw& draw = drawData[id];
+			draw.x = -1.0f + (cell % gridSize + 0.5f) * cellSize;
+			draw.y = -1.0f + (cell / gridSize + 0.5f) * cellSize;
+			draw.scale = cellSize * 0.45f;
+			draw.phase = (nextRandom() % 628) / 100.0f;
+			draw.r = (nextRandom() % 256) / 255.0f;
+			draw.g = (nextRandom() % 256) / 255.0f;
+			draw.b = (nextRandom() % 256) / 255.0f;
+			draw.a = 1.0f;
+		}
+		indirect_draw::upload(draws);
+
+		drawBuffer = instance_buffer::createStatic(drawData.data(), drawData.size() * sizeof(Draw));
+		if (drawBuffer == 0) return -1;
+		instance_buffer::Layout drawLayout;
+		instance_buffer::addAttribute(drawLayout, 1, 4, offsetof(Draw, x));
+		instance_buffer::addAttribute(drawLayout, 2, 4, offsetof(Draw, r));
+		drawLayout.stride = sizeof(Draw);
+		glBindVertexArray(pool.VAO);
+		instance_buffer::setAttributes(drawLayout, drawBuffer, 0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return 0;
+	}
+
+	void update(double time)
+	{
+		elapsedTime = (float)time;
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		uniform_table::setFloat(uniformTable, timeHandle, elapsedTime);
+
+		mesh_pool::bind(pool);
+		indirect_draw::draw(draws, pool);
+		glBindVertexArray(0);
+	}
+
+	void renderGpu()
+	{
+		glUseProgram(cullProgram);
+		uniform_table::setFloat(cullTable, cullTimeHandle, elapsedTime);
+		uniform_table::setInt(cullTable, drawCountHandle, (int)draws.count);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sourceBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, draws.buffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawBuffer);
+		glDispatchCompute((GLuint)((draws.count + groupSize - 1) / groupSize), 1, 1);
+		// the draw reads the commands as indirect arguments, not through a storage buffer
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+		for (unsigned int binding = 0; binding < 3; binding++) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+
+		render();
+	}
+
+	void shutdown()
+	{
+		// the VAO goes with the pool, the attributes pointing into drawBuffer with it
+		mesh_pool::destroy(pool);
+		indirect_draw::destroy(draws);
+		glDeleteBuffers(1, &drawBuffer);
+		glDeleteBuffers(1, &sourceBuffer);
+		glDeleteProgram(cullProgram);
+		drawBuffer = sourceBuffer = cullProgram = 0;
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		shaderProgram = 0;
+		programJob = -1;
+		timeHandle = cullTimeHandle = { -1 };
+		drawCountHandle = { -1 };
+	}
+
+	int initShaders()
+	{
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		timeHandle = uniform_table::getFloat(uniformTable, "time");
+	}
+
+}
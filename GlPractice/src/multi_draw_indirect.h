@@ -0,0 +1,27 @@
+#ifndef MULTI_DRAW_INDIRECT_H
+#define MULTI_DRAW_INDIRECT_H
+
+// 4096 spinning polygons of 46 different meshes, all in one mesh pool, drawn with one
+// glMultiDrawElementsIndirect. The position, size and color of every polygon are per-draw data, an
+// instanced attribute read at the draw ID (baseInstance of its command).
+// "multi_draw_indirect" writes the commands once at init, a frame costs the CPU one call whatever the count.
+// "multi_draw_indirect_gpu" has a compute shader rewrite the commands every frame, it hides the polygons
+// outside a moving circle by giving their commands no instances, the CPU never sees which ones.
+namespace multi_draw_indirect {
+    // adds the demos to the scene registry
+    void registerScene();
+    int init();
+    // init, plus the compute shader that writes the commands
+    int initGpu();
+    void update(double time);
+    void render();
+    // runs the compute shader, then draws
+    void renderGpu();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initMeshes();
+}
+
+#endif
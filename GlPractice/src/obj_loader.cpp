@@ -0,0 +1,588 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include "obj_loader.h"
+#include "mapped_file.h"
+
+namespace obj_loader {
+
+	// a reference that is not there, like the texture coordinates of "f 1//1"
+	const int NONE = INT_MIN;
+	// a chunk is not worth a thread below this
+	const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+	// the v/vt/vn of one face corner, 0 based
+	struct Corner {
+		int position, texCoord, normal;
+		// Negative references count back from the last element, they are stored relative to the
+		// start of their chunk until the counts of the chunks before are known. Bit 0 position, 1 texCoord, 2 normal.
+		unsigned int relative;
+	};
+
+	struct MaterialSwitch {
+		// the first face that uses the material
+		size_t face;
+		std::string name;
+	};
+
+	// what a thread parsed out of its part of the file
+	struct Chunk {
+		const char* begin;
+		const char* end;
+		std::vector<float> positions, texCoords, normals;
+		std::vector<Corner> corners;
+		// how many corners every face has
+		std::vector<unsigned int> faceSizes;
+		std::vector<MaterialSwitch> materialSwitches;
+		std::vector<std::string> materialLibraries;
+		size_t badLines;
+	};
+
+	// a vertex of the output, the material is only part of it when location 1 is the diffuse color
+	struct Key {
+		int position, texCoord, normal, material;
+
+		bool operator==(const Key& other) const
+		{
+			return position == other.position && texCoord == other.texCoord && normal == other.normal && material == other.material;
+		}
+	};
+
+	Stats stats = {};
+
+	// exact powers of ten a double can hold
+	const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	inline bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	const char* skipSpaces(const char* p, const char* end)
+	{
+		while (p < end && isSpace(*p)) p++;
+		return p;
+	}
+
+	const char* parseFloat(const char* text, const char* end, float& value)
+	{
+		// strtod handles locales, hex floats and exact rounding of any number of digits, none of which an OBJ needs.
+		// The digits go into a 64 bit integer, the ones past 18 only move the exponent.
+		const char* p = text;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		bool digits = false;
+		for (; p < end && isDigit(*p); p++, digits = true)
+		{
+			if (mantissa < 100000000000000000ull) mantissa = mantissa * 10 + (*p - '0');
+			else exponent++;
+		}
+		if (p < end && *p == '.')
+		{
+			for (p++; p < end && isDigit(*p); p++, digits = true)
+			{
+				if (mantissa < 100000000000000000ull)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					exponent--;
+				}
+			}
+		}
+		if (!digits)
+		{
+			value = 0.0f;
+			return text;
+		}
+		if (p + 1 < end && (*p == 'e' || *p == 'E'))
+		{
+			const char* e = p + 1;
+			bool negativeExponent = false;
+			if (*e == '-' || *e == '+') negativeExponent = *e++ == '-';
+			if (e < end && isDigit(*e))
+			{
+				int power = 0;
+				for (; e < end && isDigit(*e); e++)
+				{
+					if (power < 10000) power = power * 10 + (*e - '0');
+				}
+				exponent += negativeExponent ? -power : power;
+				p = e;
+			}
+		}
+
+		double result = (double)mantissa;
+		if (exponent < 0) result = exponent >= -22 ? result / powersOfTen[-exponent] : result * std::pow(10.0, exponent);
+		else if (exponent > 0) result = exponent <= 22 ? result * powersOfTen[exponent] : result * std::pow(10.0, exponent);
+		value = (float)(negative ? -result : result);
+		return p;
+	}
+
+	const char* parseInt(const char* p, const char* end, int& value)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		long long result = 0;
+		const char* first = p;
+		for (; p < end && isDigit(*p); p++)
+		{
+			if (result < INT_MAX) result = result * 10 + (*p - '0');
+		}
+		if (p == first)
+		{
+			value = 0;
+			return p;
+		}
+		if (result > INT_MAX) result = INT_MAX;
+		value = (int)(negative ? -result : result);
+		return p;
+	}
+
+	// reads count floats into out, false if the line has less
+	bool parseFloats(const char*& p, const char* end, std::vector<float>& out, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			p = skipSpaces(p, end);
+			float value;
+			const char* next = parseFloat(p, end, value);
+			if (next == p) return false;
+			out.push_back(value);
+			p = next;
+		}
+		return true;
+	}
+
+	// the rest of the line without the whitespace around it
+	std::string parseName(const char* p, const char* end)
+	{
+		p = skipSpaces(p, end);
+		while (end > p && isSpace(end[-1])) end--;
+		return std::string(p, end);
+	}
+
+	// Turns the 1 based (or negative) OBJ reference into a 0 based one, sets the relative bit for negative
+	// ones. count is how many of the elements the chunk has read so far.
+	int reference(int value, size_t count, unsigned int bit, unsigned int& relative)
+	{
+		if (value > 0) return value - 1;
+		if (value == 0) return NONE;
+		relative |= bit;
+		return (int)count + value;
+	}
+
+	bool parseFace(const char* p, const char* end, Chunk& chunk)
+	{
+		size_t first = chunk.corners.size();
+		while (true)
+		{
+			p = skipSpaces(p, end);
+			if (p >= end) break;
+
+			Corner corner = { NONE, NONE, NONE, 0 };
+			int value;
+			const char* next = parseInt(p, end, value);
+			corner.position = reference(value, chunk.positions.size() / 3, 1, corner.relative);
+			if (next == p || corner.position == NONE)
+			{
+				chunk.corners.resize(first);
+				return false;
+			}
+			p = next;
+			if (p < end && *p == '/')
+			{
+				p++;
+				// v//vn has no texture coordinates
+				if (p < end && *p != '/')
+				{
+					p = parseInt(p, end, value);
+					corner.texCoord = reference(value, chunk.texCoords.size() / 2, 2, corner.relative);
+				}
+				if (p < end && *p == '/')
+				{
+					p = parseInt(p + 1, end, value);
+					corner.normal = reference(value, chunk.normals.size() / 3, 4, corner.relative);
+				}
+			}
+			chunk.corners.push_back(corner);
+		}
+		if (chunk.corners.size() - first < 3)
+		{
+			chunk.corners.resize(first);
+			return false;
+		}
+		chunk.faceSizes.push_back((unsigned int)(chunk.corners.size() - first));
+		return true;
+	}
+
+	bool startsWith(const char* p, const char* end, const char* keyword)
+	{
+		size_t length = std::strlen(keyword);
+		return (size_t)(end - p) > length && std::memcmp(p, keyword, length) == 0 && isSpace(p[length]);
+	}
+
+	// runs on a worker thread, touches nothing but the chunk
+	void parseChunk(Chunk* chunk)
+	{
+		const char* p = chunk->begin;
+		const char* end = chunk->end;
+		while (p < end)
+		{
+			const char* lineEnd = (const char*)std::memchr(p, '\n', end - p);
+			if (lineEnd == NULL) lineEnd = end;
+			p = skipSpaces(p, lineEnd);
+
+			bool valid = true;
+			if (p + 1 < lineEnd && p[0] == 'v' && isSpace(p[1]))
+			{
+				const char* q = p + 2;
+				valid = parseFloats(q, lineEnd, chunk->positions, 3);
+			}
+			else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 't' && isSpace(p[2]))
+			{
+				// a third (w) coordinate is ignored
+				const char* q = p + 3;
+				valid = parseFloats(q, lineEnd, chunk->texCoords, 2);
+				if (!valid && chunk->texCoords.size() % 2 != 0)
+				{
+					// "vt u" alone, v is 0
+					chunk->texCoords.push_back(0.0f);
+					valid = true;
+				}
+			}
+			else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && isSpace(p[2]))
+			{
+				const char* q = p + 3;
+				valid = parseFloats(q, lineEnd, chunk->normals, 3);
+			}
+			else if (p + 1 < lineEnd && p[0] == 'f' && isSpace(p[1]))
+			{
+				valid = parseFace(p + 2, lineEnd, *chunk);
+			}
+			else if (startsWith(p, lineEnd, "usemtl"))
+			{
+				chunk->materialSwitches.push_back({ chunk->faceSizes.size(), parseName(p + 6, lineEnd) });
+			}
+			else if (startsWith(p, lineEnd, "mtllib"))
+			{
+				chunk->materialLibraries.push_back(parseName(p + 6, lineEnd));
+			}
+			// comments, groups, objects, smoothing groups and lines are skipped
+
+			if (!valid)
+			{
+				chunk->badLines++;
+				// keep the arrays in step with the element count even if the line was cut short
+				chunk->positions.resize(chunk->positions.size() / 3 * 3);
+				chunk->texCoords.resize(chunk->texCoords.size() / 2 * 2);
+				chunk->normals.resize(chunk->normals.size() / 3 * 3);
+			}
+			p = lineEnd + 1;
+		}
+	}
+
+	// the chunk boundaries, every chunk but the last ends right after a line break
+	void splitChunks(std::vector<Chunk>& chunks, const char* data, size_t size, int threadCount)
+	{
+		size_t chunkCount = size / MIN_CHUNK_SIZE + 1;
+		if (chunkCount > (size_t)threadCount) chunkCount = threadCount;
+
+		const char* begin = data;
+		const char* end = data + size;
+		for (size_t i = 0; i < chunkCount && begin < end; i++)
+		{
+			const char* chunkEnd = i + 1 == chunkCount ? end : data + size / chunkCount * (i + 1);
+			if (chunkEnd < begin) chunkEnd = begin;
+			const char* lineBreak = (const char*)std::memchr(chunkEnd, '\n', end - chunkEnd);
+			chunkEnd = lineBreak == NULL ? end : lineBreak + 1;
+
+			Chunk chunk = {};
+			chunk.begin = begin;
+			chunk.end = chunkEnd;
+			chunks.push_back(chunk);
+			begin = chunkEnd;
+		}
+	}
+
+	std::string directoryOf(const char* path)
+	{
+		std::string directory = path;
+		size_t slash = directory.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+	}
+
+	int loadMaterials(std::vector<Material>& materials, const char* path, const std::string& directory)
+	{
+		mapped_file::File file;
+		if (mapped_file::open(file, path) != 0) return -1;
+
+		const char* p = file.data;
+		const char* end = file.data + file.size;
+		Material* material = NULL;
+		while (p < end)
+		{
+			const char* lineEnd = (const char*)std::memchr(p, '\n', end - p);
+			if (lineEnd == NULL) lineEnd = end;
+			p = skipSpaces(p, lineEnd);
+
+			if (startsWith(p, lineEnd, "newmtl"))
+			{
+				materials.push_back({ parseName(p + 6, lineEnd), { 1.0f, 1.0f, 1.0f }, std::string() });
+				material = &materials.back();
+			}
+			else if (material != NULL && startsWith(p, lineEnd, "Kd"))
+			{
+				std::vector<float> color;
+				const char* q = p + 2;
+				if (parseFloats(q, lineEnd, color, 3)) std::memcpy(material->diffuse, color.data(), sizeof(material->diffuse));
+			}
+			else if (material != NULL && startsWith(p, lineEnd, "map_Kd"))
+			{
+				// options like -bm come before the file name, the name is the last word
+				std::string name = parseName(p + 6, lineEnd);
+				size_t space = name.find_last_of(" \t");
+				if (space != std::string::npos) name = name.substr(space + 1);
+				material->diffuseMap = directory + name;
+			}
+			p = lineEnd + 1;
+		}
+
+		mapped_file::close(file);
+		return 0;
+	}
+
+	inline size_t hashKey(const Key& key)
+	{
+		uint64_t h = (uint64_t)(uint32_t)key.position * 0x9E3779B97F4A7C15ull;
+		h ^= ((uint64_t)(uint32_t)key.texCoord + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+		h ^= ((uint64_t)(uint32_t)key.normal + (h << 6) + (h >> 2)) * 0x165667B19E3779F9ull;
+		h ^= (uint64_t)(uint32_t)key.material * 0x27D4EB2F165667C5ull;
+		return (size_t)(h ^ (h >> 29));
+	}
+
+	// a slot of the vertex table without a vertex
+	const unsigned int EMPTY = ~0u;
+
+	// Open addressing with linear probing, the slots hold indices into keys (the vertices made so far).
+	struct VertexTable {
+		std::vector<unsigned int> slots;
+		std::vector<Key> keys;
+		size_t mask;
+
+		void reserve(size_t expected)
+		{
+			size_t capacity = 64;
+			while (capacity < expected * 2) capacity *= 2;
+			slots.assign(capacity, EMPTY);
+			mask = capacity - 1;
+			keys.reserve(expected);
+		}
+
+		void grow()
+		{
+			slots.assign(slots.size() * 2, EMPTY);
+			mask = slots.size() - 1;
+			for (unsigned int i = 0; i < keys.size(); i++)
+			{
+				size_t slot = hashKey(keys[i]) & mask;
+				while (slots[slot] != EMPTY) slot = (slot + 1) & mask;
+				slots[slot] = i;
+			}
+		}
+
+		// the vertex of the key, a new one if it was not seen before
+		unsigned int insert(const Key& key)
+		{
+			size_t slot = hashKey(key) & mask;
+			while (slots[slot] != EMPTY)
+			{
+				if (keys[slots[slot]] == key) return slots[slot];
+				slot = (slot + 1) & mask;
+			}
+			// keep the table at most half full, the probes stay short
+			if ((keys.size() + 1) * 2 > slots.size())
+			{
+				grow();
+				return insert(key);
+			}
+			slots[slot] = (unsigned int)keys.size();
+			keys.push_back(key);
+			return slots[slot];
+		}
+	};
+
+	int load(Mesh& mesh, const char* path, int threadCount)
+	{
+		stats = {};
+		mesh = {};
+		auto start = std::chrono::steady_clock::now();
+
+		mapped_file::File file;
+		if (mapped_file::open(file, path) != 0) return -1;
+
+		if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+
+		std::vector<Chunk> chunks;
+		splitChunks(chunks, file.data, file.size, threadCount);
+
+		// the first chunk is parsed on this thread
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < chunks.size(); i++) threads.emplace_back(parseChunk, &chunks[i]);
+		if (!chunks.empty()) parseChunk(&chunks[0]);
+		for (std::thread& thread : threads) thread.join();
+
+		size_t bytes = file.size;
+		mapped_file::close(file);
+		auto parsed = std::chrono::steady_clock::now();
+
+		// where the elements of every chunk start in the whole file
+		size_t positionCount = 0, texCoordCount = 0, normalCount = 0, badLines = 0;
+		std::vector<size_t> positionBase, texCoordBase, normalBase;
+		for (const Chunk& chunk : chunks)
+		{
+			positionBase.push_back(positionCount);
+			texCoordBase.push_back(texCoordCount);
+			normalBase.push_back(normalCount);
+			positionCount += chunk.positions.size() / 3;
+			texCoordCount += chunk.texCoords.size() / 2;
+			normalCount += chunk.normals.size() / 3;
+			badLines += chunk.badLines;
+		}
+		if (badLines > 0) std::cout << "ERROR::OBJ_LOADER::SKIPPED_LINES " << badLines << " in " << path << std::endl;
+
+		std::string directory = directoryOf(path);
+		std::vector<std::string> libraries;
+		for (const Chunk& chunk : chunks)
+		{
+			for (const std::string& library : chunk.materialLibraries)
+			{
+				if (std::find(libraries.begin(), libraries.end(), library) != libraries.end()) continue;
+				libraries.push_back(library);
+				// a missing MTL only costs the colors, the geometry is still fine
+				loadMaterials(mesh.materials, (directory + library).c_str(), directory);
+			}
+		}
+		std::unordered_map<std::string, int> materialIndices;
+		for (size_t i = 0; i < mesh.materials.size(); i++) materialIndices.emplace(mesh.materials[i].name, (int)i);
+
+		mesh.hasNormals = normalCount > 0;
+
+		// the triangles of every material, [0] holds the ones without a material
+		std::vector<std::vector<unsigned int>> materialTriangles(mesh.materials.size() + 1);
+		VertexTable table;
+		table.reserve(positionCount + positionCount / 4);
+
+		int material = -1;
+		size_t triangleCount = 0;
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			const Chunk& chunk = chunks[c];
+			const Corner* corner = chunk.corners.data();
+			size_t nextSwitch = 0;
+			std::vector<unsigned int> face;
+			// one more round than there are faces, for a usemtl after the last face of the chunk (or in a chunk
+			// without faces), it holds for the faces of the next chunk
+			for (size_t f = 0; f <= chunk.faceSizes.size(); f++)
+			{
+				while (nextSwitch < chunk.materialSwitches.size() && chunk.materialSwitches[nextSwitch].face == f)
+				{
+					auto found = materialIndices.find(chunk.materialSwitches[nextSwitch].name);
+					material = found == materialIndices.end() ? -1 : found->second;
+					nextSwitch++;
+				}
+				if (f == chunk.faceSizes.size()) break;
+
+				face.clear();
+				for (unsigned int i = 0; i < chunk.faceSizes[f]; i++, corner++)
+				{
+					Key key;
+					key.position = corner->position + ((corner->relative & 1) ? (int)positionBase[c] : 0);
+					key.texCoord = corner->texCoord == NONE ? NONE : corner->texCoord + ((corner->relative & 2) ? (int)texCoordBase[c] : 0);
+					key.normal = corner->normal == NONE ? NONE : corner->normal + ((corner->relative & 4) ? (int)normalBase[c] : 0);
+					key.material = mesh.hasNormals ? 0 : material;
+					if (key.position < 0 || (size_t)key.position >= positionCount
+						|| (key.texCoord != NONE && (key.texCoord < 0 || (size_t)key.texCoord >= texCoordCount))
+						|| (key.normal != NONE && (key.normal < 0 || (size_t)key.normal >= normalCount)))
+					{
+						std::cout << "ERROR::OBJ_LOADER::INDEX_OUT_OF_RANGE " << path << std::endl;
+						mesh = {};
+						return -1;
+					}
+					face.push_back(table.insert(key));
+				}
+
+				// fan triangulation, fine for the convex polygons exporters write
+				std::vector<unsigned int>& triangles = materialTriangles[material + 1];
+				for (size_t i = 1; i + 1 < face.size(); i++)
+				{
+					triangles.insert(triangles.end(), { face[0], face[i], face[i + 1] });
+				}
+				triangleCount += face.size() - 2;
+			}
+		}
+
+		// the attributes of the vertices, read from the chunks that parsed them
+		mesh.vertexCount = table.keys.size();
+		mesh.vertices.resize(mesh.vertexCount * FLOATS_PER_VERTEX);
+		std::vector<const float*> positions(positionCount), texCoords(texCoordCount), normals(normalCount);
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			for (size_t i = 0; i < chunks[c].positions.size() / 3; i++) positions[positionBase[c] + i] = &chunks[c].positions[i * 3];
+			for (size_t i = 0; i < chunks[c].texCoords.size() / 2; i++) texCoords[texCoordBase[c] + i] = &chunks[c].texCoords[i * 2];
+			for (size_t i = 0; i < chunks[c].normals.size() / 3; i++) normals[normalBase[c] + i] = &chunks[c].normals[i * 3];
+		}
+		const float white[3] = { 1.0f, 1.0f, 1.0f };
+		const float zero[3] = { 0.0f, 0.0f, 0.0f };
+		float* vertex = mesh.vertices.data();
+		for (const Key& key : table.keys)
+		{
+			const float* second = mesh.hasNormals ? (key.normal == NONE ? zero : normals[key.normal])
+				: (key.material < 0 ? white : mesh.materials[key.material].diffuse);
+			const float* texCoord = key.texCoord == NONE ? zero : texCoords[key.texCoord];
+			std::memcpy(vertex, positions[key.position], 3 * sizeof(float));
+			std::memcpy(vertex + 3, second, 3 * sizeof(float));
+			std::memcpy(vertex + 6, texCoord, 2 * sizeof(float));
+			vertex += FLOATS_PER_VERTEX;
+		}
+
+		mesh.indices.reserve(triangleCount * 3);
+		for (size_t m = 0; m < materialTriangles.size(); m++)
+		{
+			if (materialTriangles[m].empty()) continue;
+			mesh.submeshes.push_back({ (unsigned int)mesh.indices.size(), (unsigned int)materialTriangles[m].size(), (int)m - 1 });
+			mesh.indices.insert(mesh.indices.end(), materialTriangles[m].begin(), materialTriangles[m].end());
+		}
+		auto built = std::chrono::steady_clock::now();
+
+		stats.bytes = bytes;
+		stats.threads = (int)chunks.size();
+		stats.parseMs = std::chrono::duration<double, std::milli>(parsed - start).count();
+		stats.buildMs = std::chrono::duration<double, std::milli>(built - parsed).count();
+		stats.positions = positionCount;
+		stats.corners = triangleCount * 3;
+		stats.vertices = mesh.vertexCount;
+		stats.triangles = triangleCount;
+		return 0;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+}
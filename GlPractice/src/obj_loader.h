@@ -0,0 +1,73 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Wavefront OBJ (+ MTL) loader that produces indexed meshes ready for glBufferData.
+// The file is mapped, cut into chunks at line breaks and the chunks are parsed on a thread each. The
+// v/vt/vn references of the faces are then made absolute, and every distinct v/vt/vn combination becomes
+// one vertex of the output (the dedup goes through an open addressing hash table), so shared corners are
+// shared vertices in the index buffer. Polygons are triangulated as fans, the triangles are grouped by
+// material with one submesh per material.
+//
+// A vertex is FLOATS_PER_VERTEX floats, matching the attribute locations of the scenes:
+//   location 0: position (3 floats)
+//   location 1: normal (3 floats), or the diffuse color of the material if the file has no normals
+//   location 2: texture coordinates (2 floats)
+namespace obj_loader {
+    const int FLOATS_PER_VERTEX = 8;
+
+    struct Material {
+        std::string name;
+        // Kd
+        float diffuse[3];
+        // map_Kd, relative to the working directory (the directory of the OBJ is prepended), empty if there is none
+        std::string diffuseMap;
+    };
+
+    struct Submesh {
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        // index into Mesh::materials, -1 for faces without a (known) material
+        int material;
+    };
+
+    struct Mesh {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<Submesh> submeshes;
+        std::vector<Material> materials;
+        size_t vertexCount;
+        // location 1 holds normals, otherwise the diffuse colors
+        bool hasNormals;
+    };
+
+    // of the last load
+    struct Stats {
+        size_t bytes;
+        int threads;
+        // mapping the file and the parallel parse
+        double parseMs;
+        // resolving the references, the dedup and building the vertices and indices
+        double buildMs;
+        size_t positions;
+        // v/vt/vn references of the triangles, what the vertex count would be without the dedup
+        size_t corners;
+        size_t vertices;
+        size_t triangles;
+    };
+
+    // Loads the OBJ at path and the materials of its mtllib. threadCount 0 uses a thread per core.
+    int load(Mesh& mesh, const char* path, int threadCount = 0);
+    // parses an MTL file and appends its materials, the texture paths are prefixed with directory
+    int loadMaterials(std::vector<Material>& materials, const char* path, const std::string& directory);
+
+    // parses a float at text, stops at end, returns where the number ended (text if there is none)
+    const char* parseFloat(const char* text, const char* end, float& value);
+
+    const Stats& getStats();
+}
+
+#endif
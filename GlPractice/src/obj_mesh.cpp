@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include "obj_mesh.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "shader_preprocessor.h"
+#include "uniform_table.h"
+#include "mesh_file.h"
+
+namespace obj_mesh {
+
+	const char* meshPath = "assets/torus.obj";
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO, EBO;
+	int indexCount;
+	unsigned int indexType;
+
+	// uber mode only: the switches of the uber-shader
+	uniform_table::Table uniformTable;
+	uniform_table::IntHandle useVertexColorHandle = { -1 };
+	uniform_table::IntHandle useTextureHandle = { -1 };
+
+	void registerScene()
+	{
+		scene::registerScene({ "obj_mesh", init, NULL, render, shutdown });
+	}
+
+	int init()
+	{
+		if (initShaders() != 0) return -1;
+		return initVAOs();
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		uniform_table::setInt(uniformTable, useVertexColorHandle, 1);
+		uniform_table::setInt(uniformTable, useTextureHandle, 0);
+
+		// the material colors are in the vertices, so every submesh goes out in the same draw
+		glBindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+		glBindVertexArray(0);
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = EBO = shaderProgram = 0;
+		programJob = -1;
+		useVertexColorHandle = useTextureHandle = { -1 };
+	}
+
+	int initVAOs()
+	{
+		// the OBJ is converted into the binary format once (parsed, optimized and packed), after that the
+		// vertex and index blobs go from the mapped file straight into the buffers
+		mesh_file::Mesh mesh;
+		if (mesh_file::openObj(mesh, meshPath) != 0) return -1;
+
+		indexCount = (int)mesh.header->indexCount;
+		indexType = mesh.header->indexType;
+		int result = mesh_file::upload(mesh, VAO, VBO, EBO);
+		// the buffers have their own copy, the mapping is not needed anymore
+		mesh_file::close(mesh);
+		return result;
+	}
+
+	int initShaders()
+	{
+		std::vector<std::string> defines = { shader_preprocessor::uberShaders() ? "UBER_SHADER" : "USE_VERTEX_COLOR" };
+		const std::string* vertexShaderSrc = shader_preprocessor::variant("basic.vert", defines);
+		const std::string* fragmentShaderSrc = shader_preprocessor::variant("basic.frag", defines);
+		if (vertexShaderSrc == NULL || fragmentShaderSrc == NULL) return -1;
+
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc->c_str(), fragmentShaderSrc->c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		useVertexColorHandle = uniform_table::getInt(uniformTable, "useVertexColor");
+		useTextureHandle = uniform_table::getInt(uniformTable, "useTexture");
+	}
+
+}
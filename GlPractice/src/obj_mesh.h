@@ -0,0 +1,19 @@
+#ifndef OBJ_MESH_H
+#define OBJ_MESH_H
+
+// A mesh loaded from assets/torus.obj instead of a hardcoded vertex array, colored by the diffuse
+// colors of its materials. The OBJ is converted into the binary mesh format on the first run,
+// later runs map the converted file and upload it as it is.
+namespace obj_mesh {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initVAOs();
+}
+
+#endif
@@ -1,7 +1,8 @@
 #include <iostream>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include "practice.h"
+#include "scene.h"
+#include "shader_compiler.h"
 
 namespace practice {
 	// This is the source code of the vertex shader.
@@ -29,72 +30,39 @@ void main()
     FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);
 })";
 
-	GLFWwindow* window;
+	// 0 until the shader compiler finished the program
 	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
 	unsigned int VAO;
 	// id for the vertex buffer object (VBO)
 	unsigned int VBO;
 
+	void registerScene()
+	{
+		scene::registerScene({ "practice", init, NULL, draw, shutdown });
+	}
 
-	int main() {
-		int code = initWindow();
-		if (code != 0) return code;
-
-		code = initShaders();
+	int init() {
+		int code = initShaders();
 		if (code != 0) return code;
 
 		code = initVBO();
 		if (code != 0) return code;
 
-		code = initVAO();
-		if (code != 0) return code;
-
-		// Initialize viewport. (same as the window for now)
-		// Im guessing this is for you to be able to set different sections of the screen for different purposes.
-		// Ex.: you can have the top of the window for navigation bar and the bottom for displaying content which will 
-		// be 2 different viewports.
-		glViewport(0, 0, 800, 600);
-
-		// Tell GLFW to call framebuffer_size_callback when the window gets resized by the user. 
-		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-		// We need to create the render loop or else the application shuts down immediately.
-		while (!glfwWindowShouldClose(window))
-		{
-			processInput(window);
-
-			// put rendering commands in the middle of input processing and event polling
-			draw();
-
-			// Not sure what this does but according to the docs, this will swap a large 2D buffer that contains the pixel
-			// values for the provided window. This is probably the method that renders the modified screen buffer.
-			// OpenGl uses a double buffering technique, where the front buffer is the buffer that gets rendered to the user
-			// while the back buffer is the one where current rendering tasks happen. When the framework finishes its work on
-			// the back buffer, the front buffer will get replaced by it. This is to avoid flickering issues.
-			glfwSwapBuffers(window);
-			// Poll for events. Important because the registered callbacks/event handlers gets notified by polling events.
-			glfwPollEvents();
-		}
-
-		// Free resources allocated by the framework upon closing the app.
-		glfwTerminate();
-
-		return 0;
-	}
-
-	void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-	{
-		// If the windows gets resized, reset the viewport to take up the whole screen.
-		glViewport(0, 0, width, height);
+		return initVAO();
 	}
 
-	void processInput(GLFWwindow* window)
+	void shutdown()
 	{
-		// check if the user pressed down the escape button
-		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		{
-			glfwSetWindowShouldClose(window, true);
-		}
+		// deleting an id of 0 is silently ignored, so this is safe after a failed init too
+		glDeleteVertexArrays(1, &VAO);
+		// This is here to prevent memory leaks.
+		// If we dont delete the memory allocated in the VBO, OpenGl wont free it automatically.
+		glDeleteBuffers(1, &VBO);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = shaderProgram = 0;
+		programJob = -1;
 	}
 
 	void draw()
@@ -110,8 +78,9 @@ void main()
 	void drawTriangle()
 	{
 		// use the already set-up shader
-		// comment out if youre expecting to have a default shader
-		// glUseProgram(shaderProgram);
+		// other scenes share the context, so we cant rely on it still being the default shader
+		// (this draws with the fallback shader while ours is still compiling)
+		shader_compiler::useProgram(shaderProgram);
 		// bind the VAO
 		glBindVertexArray(VAO);
 
@@ -125,105 +94,22 @@ void main()
 			//      triangle so we specify that we want to draw all 3)
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
-		// This is here to prevent memory leaks.
-		// If we dont delete the memory allocated in the VBO, OpenGl wont free it automatically.
-		// Commented out because if you are using a VAO, the VBO gets allocated only once, and if you free it
-		// OpenGl will only render it for one frame.
-		// glDeleteBuffers(1, &VBO);
-	}
-
-	int initWindow()
-	{
-		glfwInit();
-		// request client API with this version (3.3.?)
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-		// Telling GLFW we want to use the core-profile means we'll get access to a smaller subset of OpenGL
-		// features without backwards-compatible features we no longer need. 
-		// This might lead to errors so comment it if you need to use legacy code.
-		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-		//glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
-
-		// request GLFW to create a windows
-		window = glfwCreateWindow(800, 600, "GlPractice", NULL, NULL);
-		if (window == NULL)
-		{
-			std::cout << "Failed to create window" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-		glfwMakeContextCurrent(window);
-
-		// GLAD manages function pointers, so we need to initialize it too.
-		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-		{
-			std::cout << "Failed to initialize GLAD" << std::endl;
-			return -1;
-		}
-
-		return 0;
+		// Note that we dont delete the VBO here. If you are using a VAO, the VBO gets allocated only once,
+		// and if you free it OpenGl will only render it for one frame. shutdown() frees it instead.
 	}
 
 	int initShaders() {
-		// compile shaders and attach it to the shader program
-		// 1. create a shader object, get its id
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		// 2. attach the shader source code to the shader object
-		// it is possible to attach multiple strings that contain source code (2nd, 3rd, 4th parameter of the function)
-		glShaderSource(vertexShader, 1, &vertexShaderSrc, NULL);
-		// 3. compile shaders
-		glCompileShader(vertexShader);
-		// check if shader compilation was successful. If not, print it to the console.
-		int success;
-		char infoLog[512];
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			// copy compilation info into the 512 long char array
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-		// same for the fragment shader
-		unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragmentShader, 1, &fragmentShaderSrc, NULL);
-		glCompileShader(fragmentShader);
-		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		// create the shader program and link the compiled shaders.
+		// compile the shaders and link them into the shader program
 		// the shader program links the shader outputs to the next shader's input on the pipeline
 		// if we made an error, the linker will not be able to link the inputs and outputs so we will get an error
-		// first, create the program object
-		shaderProgram = glCreateProgram();
-		// attach the compiled shaders to the program
-		glAttachShader(shaderProgram, vertexShader);
-		glAttachShader(shaderProgram, fragmentShader);
-		// now link the shaders outputs and inputs
-		glLinkProgram(shaderProgram);
-		// we can also check for errors here
-		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-		// now we need to tell which shader program to use
-		// after this call, this shader program will be used until told otherwise
-		// comment this to not have a default shader
-		glUseProgram(shaderProgram);
-
-		// finally, delete the shader objects, we dont need them after linking
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
+		// the shader compiler does this in the background and calls onProgramReady when it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
 
-		return 0;
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
 	}
 
 	int initVBO()
@@ -262,7 +148,9 @@ void main()
 			// GL_STREAM_DRAW: the data is set only once and used by the GPU at most a few times.
 			// GL_STATIC_DRAW : the data is set only once and used many times.
 			// GL_DYNAMIC_DRAW : the data is changed a lot and used many times.
-		glBufferData(GL_ARRAY_BUFFER, sizeof(trianglePoints), trianglePoints, GL_DYNAMIC_DRAW);
+		// The triangle never changes, so it is static. Geometry that is rewritten every frame should go
+		// through stream_buffer instead (see the streaming scene), re-uploading it with glBufferData would stall.
+		glBufferData(GL_ARRAY_BUFFER, sizeof(trianglePoints), trianglePoints, GL_STATIC_DRAW);
 		// now we need to tell opengl how to interpret the VBO data
 		// the parameters:
 			// 1st: which vertex attribute we want to specify. Since layout = 0 in vertex shader for the position
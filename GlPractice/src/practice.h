@@ -1,23 +1,22 @@
 #ifndef PRACTICE_H
 #define PRACTICE_H
 
-struct GLFWwindow;
-
 namespace practice {
-    int main();
-	// Prototype for a method that gets called if the user resizes the window.
-	void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-	// Method signature for a callback that gets invoked when the user presses a button.
-	void processInput(GLFWwindow* window);
+	// adds the demo to the scene registry
+	void registerScene();
+	// creates the shaders and buffers of the demo
+	int init();
+	// frees every GL object created by init
+	void shutdown();
 	// Handles drawing onto the screen.
 	void draw();
 	void drawTriangle();
-	// initializes the window
-	int initWindow();
 	// initializes shaders
 	int initShaders();
+	// called by the shader compiler once the program is linked
+	void onProgramReady(unsigned int program);
 	int initVBO();
 	int initVAO();
 }
 
-#endif
\ No newline at end of file
+#endif
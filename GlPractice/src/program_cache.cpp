@@ -0,0 +1,271 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <glad/glad.h>
+#include "program_cache.h"
+
+namespace program_cache {
+
+	// "GLPB" in little endian
+	const unsigned int fileMagic = 0x42504c47;
+	// bump this if the layout of the file changes
+	const unsigned int fileVersion = 1;
+
+	// what precedes the binary in a cache file
+	struct FileHeader {
+		unsigned int magic;
+		unsigned int version;
+		// the full key, the file name only has room for it in hex but this way a truncated name can not collide
+		unsigned long long key;
+		unsigned int binaryFormat;
+		unsigned int binaryLength;
+	};
+
+	std::string directory = "shader_cache";
+	bool enabled = true;
+	Stats stats = {};
+
+	void setDirectory(const char* path)
+	{
+		directory = path;
+	}
+
+	void setEnabled(bool value)
+	{
+		enabled = value;
+	}
+
+	bool binariesSupported()
+	{
+		// program binaries are core since 4.1, below that the extension is needed
+		if (!GLAD_GL_ARB_get_program_binary || glGetProgramBinary == NULL || glProgramBinary == NULL) return false;
+
+		// a driver can expose the extension but support zero formats, in which case nothing can be cached
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	unsigned long long hash(const void* data, size_t size, unsigned long long seed)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		unsigned long long h = seed;
+		for (size_t i = 0; i < size; i++)
+		{
+			h ^= bytes[i];
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	unsigned long long hashString(const char* str, unsigned long long seed)
+	{
+		// the terminating zero is hashed too, so "ab" + "c" and "a" + "bc" give different keys
+		if (str == NULL) str = "";
+		return hash(str, std::strlen(str) + 1, seed);
+	}
+
+	unsigned long long programKey(const char* vertexSrc, const char* fragmentSrc)
+	{
+		unsigned long long key = hash(&fileVersion, sizeof(fileVersion));
+		key = hashString((const char*)glGetString(GL_VENDOR), key);
+		key = hashString((const char*)glGetString(GL_RENDERER), key);
+		key = hashString((const char*)glGetString(GL_VERSION), key);
+		key = hashString(vertexSrc, key);
+		key = hashString(fragmentSrc, key);
+		return key;
+	}
+
+	std::string cachePath(unsigned long long key)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", key);
+		return directory + "/" + name;
+	}
+
+	// returns 0 if the program was loaded from the cache and linked successfully
+	int loadBinary(unsigned int program, unsigned long long key)
+	{
+		std::ifstream file(cachePath(key), std::ios::binary);
+		if (!file) return -1;
+
+		FileHeader header;
+		if (!file.read((char*)&header, sizeof(header))) return -1;
+		if (header.magic != fileMagic || header.version != fileVersion || header.key != key) return -1;
+
+		std::vector<char> binary(header.binaryLength);
+		if (!file.read(binary.data(), binary.size())) return -1;
+
+		glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+		// the driver is free to reject any binary, e.g. after a driver update, it reports that as a failed link
+		int success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			stats.rejected++;
+			// remove it so we dont try to load it again on every start
+			std::error_code error;
+			std::filesystem::remove(cachePath(key), error);
+			return -1;
+		}
+
+		return 0;
+	}
+
+	void storeBinary(unsigned int program, unsigned long long key)
+	{
+		int length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		GLsizei written = 0;
+		glGetProgramBinary(program, length, &written, &format, binary.data());
+		if (written <= 0) return;
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			std::cout << "ERROR::PROGRAM_CACHE::CANT_CREATE_DIRECTORY " << directory << std::endl;
+			return;
+		}
+
+		// write into a temporary file first, so a crash can not leave half a binary under the real name
+		std::string path = cachePath(key);
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file) return;
+
+			FileHeader header = { fileMagic, fileVersion, key, format, (unsigned int)written };
+			file.write((const char*)&header, sizeof(header));
+			file.write(binary.data(), written);
+			if (!file) return;
+		}
+		std::filesystem::rename(tempPath, path, error);
+	}
+
+	unsigned int compileShader(unsigned int type, const char* src)
+	{
+		// 1. create a shader object, get its id
+		unsigned int shader = glCreateShader(type);
+		// 2. attach the shader source code to the shader object
+		glShaderSource(shader, 1, &src, NULL);
+		// 3. compile shaders
+		glCompileShader(shader);
+		// check if shader compilation was successful. If not, print it to the console.
+		int success;
+		char infoLog[512];
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			const char* stage = type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : type == GL_COMPUTE_SHADER ? "COMPUTE" : "UNKNOWN";
+			std::cout << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+			glDeleteShader(shader);
+			return 0;
+		}
+		return shader;
+	}
+
+	int linkProgram(unsigned int program)
+	{
+		glLinkProgram(program);
+
+		int success;
+		char infoLog[512];
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	int loadCached(unsigned int program, const char* vertexSrc, const char* fragmentSrc, unsigned long long& key)
+	{
+		key = 0;
+		if (!enabled || !binariesSupported())
+		{
+			stats.misses++;
+			return -1;
+		}
+
+		key = programKey(vertexSrc, fragmentSrc);
+		if (loadBinary(program, key) == 0)
+		{
+			stats.hits++;
+			return 0;
+		}
+		stats.misses++;
+
+		// tell the driver up front that we will ask for the binary, some drivers only keep it around if we do
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		// a rejected glProgramBinary leaves the program object usable for a normal link
+		return -1;
+	}
+
+	void storeCached(unsigned int program, unsigned long long key)
+	{
+		if (key == 0) return;
+		storeBinary(program, key);
+	}
+
+	int buildProgram(unsigned int& program, const char* vertexSrc, const char* fragmentSrc)
+	{
+		program = glCreateProgram();
+
+		unsigned long long key = 0;
+		if (loadCached(program, vertexSrc, fragmentSrc, key) == 0) return 0;
+
+		unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSrc);
+		unsigned int fragmentShader = vertexShader != 0 ? compileShader(GL_FRAGMENT_SHADER, fragmentSrc) : 0;
+		if (vertexShader == 0 || fragmentShader == 0)
+		{
+			glDeleteShader(vertexShader);
+			glDeleteProgram(program);
+			program = 0;
+			return -1;
+		}
+
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		int code = linkProgram(program);
+
+		// the program keeps working without the shader objects, we dont need them after linking
+		glDetachShader(program, vertexShader);
+		glDetachShader(program, fragmentShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		if (code != 0)
+		{
+			glDeleteProgram(program);
+			program = 0;
+			return -1;
+		}
+
+		storeCached(program, key);
+
+		return 0;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,49 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <string>
+
+// Caches linked programs on disk with glGetProgramBinary, so the next start can skip compiling and linking.
+// The cache key is a hash of the shader sources and the driver (vendor, renderer, version), since a binary
+// is only valid for the exact driver that produced it.
+namespace program_cache {
+    struct Stats {
+        // programs loaded from the cache
+        unsigned long long hits;
+        // programs compiled from source because there was no cached binary
+        unsigned long long misses;
+        // cached binaries the driver refused to load (driver update, corrupt file, ...)
+        unsigned long long rejected;
+    };
+
+    // where the binaries are stored, "shader_cache" by default
+    void setDirectory(const char* path);
+    // turns the disk cache on or off, everything is compiled from source while it is off
+    void setEnabled(bool enabled);
+    // true if the driver can return program binaries (ARB_get_program_binary with at least one format)
+    bool binariesSupported();
+
+    // Loads the program from the cache or compiles and links it from the sources, then stores the binary.
+    // Returns 0 on success, the new program is written into program.
+    int buildProgram(unsigned int& program, const char* vertexSrc, const char* fragmentSrc);
+
+    // The two halves of buildProgram, for callers that compile the program themselves.
+    // loadCached returns 0 if the program was loaded from the cache. Otherwise the program is left
+    // unlinked and key is set to what storeCached needs after a successful link (0 if caching is off).
+    int loadCached(unsigned int program, const char* vertexSrc, const char* fragmentSrc, unsigned long long& key);
+    // stores the binary of a freshly linked program, does nothing if key is 0
+    void storeCached(unsigned int program, unsigned long long key);
+
+    // compiles a single stage and prints the info log if it fails, returns 0 on failure
+    unsigned int compileShader(unsigned int type, const char* src);
+    // links the program and prints the info log if it fails, returns 0 on success
+    int linkProgram(unsigned int program);
+
+    // 64 bit FNV-1a, the hash used for the cache keys
+    unsigned long long hash(const void* data, size_t size, unsigned long long seed = 14695981039346656037ull);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,287 @@
+#include <iostream>
+#include "range_allocator.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace range_allocator {
+
+	int lowestBit(unsigned long long value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return (int)index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+	int highestBit(unsigned long long value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return (int)index;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	// the free list of blocks of the size, below SL_COUNT every size has a list of its own
+	void mapping(size_t size, int& firstLevel, int& secondLevel)
+	{
+		if (size < (size_t)SL_COUNT)
+		{
+			firstLevel = 0;
+			secondLevel = (int)size;
+			return;
+		}
+		int bit = highestBit(size);
+		firstLevel = bit - SL_BITS + 1;
+		secondLevel = (int)(size >> (bit - SL_BITS)) - SL_COUNT;
+	}
+
+	void insertFree(Allocator& allocator, int index)
+	{
+		Block& block = allocator.blocks[index];
+		int firstLevel, secondLevel;
+		mapping(block.size, firstLevel, secondLevel);
+		int& head = allocator.freeLists[firstLevel][secondLevel];
+		block.free = true;
+		block.previousFree = -1;
+		block.nextFree = head;
+		if (head >= 0) allocator.blocks[head].previousFree = index;
+		head = index;
+		allocator.firstLevelMap |= 1ull << firstLevel;
+		allocator.secondLevelMap[firstLevel] |= 1u << secondLevel;
+	}
+
+	void removeFree(Allocator& allocator, int index)
+	{
+		Block& block = allocator.blocks[index];
+		int firstLevel, secondLevel;
+		mapping(block.size, firstLevel, secondLevel);
+		if (block.previousFree >= 0) allocator.blocks[block.previousFree].nextFree = block.nextFree;
+		else allocator.freeLists[firstLevel][secondLevel] = block.nextFree;
+		if (block.nextFree >= 0) allocator.blocks[block.nextFree].previousFree = block.previousFree;
+		if (allocator.freeLists[firstLevel][secondLevel] < 0)
+		{
+			allocator.secondLevelMap[firstLevel] &= ~(1u << secondLevel);
+			if (allocator.secondLevelMap[firstLevel] == 0) allocator.firstLevelMap &= ~(1ull << firstLevel);
+		}
+		block.free = false;
+	}
+
+	int newBlock(Allocator& allocator)
+	{
+		if (!allocator.unusedBlocks.empty())
+		{
+			int index = allocator.unusedBlocks.back();
+			allocator.unusedBlocks.pop_back();
+			allocator.blocks[index] = {};
+			return index;
+		}
+		allocator.blocks.push_back({});
+		return (int)allocator.blocks.size() - 1;
+	}
+
+	void releaseBlock(Allocator& allocator, int index)
+	{
+		allocator.blocks[index].unused = true;
+		allocator.unusedBlocks.push_back(index);
+	}
+
+	void clearFreeLists(Allocator& allocator)
+	{
+		allocator.firstLevelMap = 0;
+		for (int i = 0; i < FL_COUNT; i++)
+		{
+			allocator.secondLevelMap[i] = 0;
+			for (int j = 0; j < SL_COUNT; j++) allocator.freeLists[i][j] = -1;
+		}
+	}
+
+	void create(Allocator& allocator, size_t capacity)
+	{
+		allocator = {};
+		clearFreeLists(allocator);
+		allocator.capacity = capacity;
+		allocator.first = -1;
+		if (capacity == 0) return;
+		if (highestBit(capacity) - SL_BITS + 1 >= FL_COUNT)
+		{
+			std::cout << "ERROR::RANGE_ALLOCATOR::CAPACITY_TOO_LARGE" << std::endl;
+			allocator.capacity = 0;
+			return;
+		}
+
+		int index = newBlock(allocator);
+		allocator.blocks[index] = { 0, capacity, -1, -1, -1, -1, false, false };
+		allocator.first = index;
+		insertFree(allocator, index);
+	}
+
+	// a free block of at least size units, -1 if there is none
+	int findFree(const Allocator& allocator, size_t size)
+	{
+		// round up to the next size class, every block in that class (and above) is big enough,
+		// so the first block of the first non-empty list will do
+		if (size >= (size_t)SL_COUNT) size += (1ull << (highestBit(size) - SL_BITS)) - 1;
+		int firstLevel, secondLevel;
+		mapping(size, firstLevel, secondLevel);
+		if (firstLevel >= FL_COUNT) return -1;
+
+		unsigned int secondLevelMap = allocator.secondLevelMap[firstLevel] & (~0u << secondLevel);
+		if (secondLevelMap == 0)
+		{
+			unsigned long long firstLevelMap = firstLevel + 1 < FL_COUNT ? allocator.firstLevelMap & (~0ull << (firstLevel + 1)) : 0;
+			if (firstLevelMap == 0) return -1;
+			firstLevel = lowestBit(firstLevelMap);
+			secondLevelMap = allocator.secondLevelMap[firstLevel];
+		}
+		return allocator.freeLists[firstLevel][lowestBit(secondLevelMap)];
+	}
+
+	// The rounding in findFree skips the blocks of the size's own class, some of which may be big enough.
+	// Only looked at when nothing else fits, it walks the list.
+	int findFreeInClass(const Allocator& allocator, size_t size)
+	{
+		int firstLevel, secondLevel;
+		mapping(size, firstLevel, secondLevel);
+		if (firstLevel >= FL_COUNT) return -1;
+		for (int index = allocator.freeLists[firstLevel][secondLevel]; index >= 0; index = allocator.blocks[index].nextFree)
+		{
+			if (allocator.blocks[index].size >= size) return index;
+		}
+		return -1;
+	}
+
+	Handle allocate(Allocator& allocator, size_t size)
+	{
+		if (size == 0) size = 1;
+		int index = findFree(allocator, size);
+		if (index < 0) index = findFreeInClass(allocator, size);
+		if (index < 0) return -1;
+		removeFree(allocator, index);
+
+		// the rest of the block goes back into the free lists
+		if (allocator.blocks[index].size > size)
+		{
+			int rest = newBlock(allocator);
+			Block& block = allocator.blocks[index];
+			allocator.blocks[rest] = { block.offset + size, block.size - size, index, block.next, -1, -1, false, false };
+			if (block.next >= 0) allocator.blocks[block.next].previous = rest;
+			block.next = rest;
+			block.size = size;
+			insertFree(allocator, rest);
+		}
+
+		allocator.used += size;
+		allocator.allocations++;
+		return index;
+	}
+
+	// joins the block with its next neighbour, which is released
+	void merge(Allocator& allocator, int index)
+	{
+		Block& block = allocator.blocks[index];
+		int next = block.next;
+		block.size += allocator.blocks[next].size;
+		block.next = allocator.blocks[next].next;
+		if (block.next >= 0) allocator.blocks[block.next].previous = index;
+		releaseBlock(allocator, next);
+	}
+
+	void free(Allocator& allocator, Handle handle)
+	{
+		if (handle < 0 || handle >= (int)allocator.blocks.size() || allocator.blocks[handle].free || allocator.blocks[handle].unused)
+		{
+			std::cout << "ERROR::RANGE_ALLOCATOR::INVALID_HANDLE " << handle << std::endl;
+			return;
+		}
+		allocator.used -= allocator.blocks[handle].size;
+		allocator.allocations--;
+
+		int index = handle;
+		int next = allocator.blocks[index].next;
+		if (next >= 0 && allocator.blocks[next].free)
+		{
+			removeFree(allocator, next);
+			merge(allocator, index);
+		}
+		int previous = allocator.blocks[index].previous;
+		if (previous >= 0 && allocator.blocks[previous].free)
+		{
+			removeFree(allocator, previous);
+			merge(allocator, previous);
+			index = previous;
+		}
+		insertFree(allocator, index);
+	}
+
+	size_t offset(const Allocator& allocator, Handle handle)
+	{
+		return allocator.blocks[handle].offset;
+	}
+
+	size_t size(const Allocator& allocator, Handle handle)
+	{
+		return allocator.blocks[handle].size;
+	}
+
+	size_t largestFree(const Allocator& allocator)
+	{
+		if (allocator.firstLevelMap == 0) return 0;
+		// the blocks of the highest non-empty list are the biggest, but a list holds a range of sizes
+		int firstLevel = highestBit(allocator.firstLevelMap);
+		int secondLevel = highestBit(allocator.secondLevelMap[firstLevel]);
+		size_t largest = 0;
+		for (int index = allocator.freeLists[firstLevel][secondLevel]; index >= 0; index = allocator.blocks[index].nextFree)
+		{
+			if (allocator.blocks[index].size > largest) largest = allocator.blocks[index].size;
+		}
+		return largest;
+	}
+
+	void compact(Allocator& allocator, std::vector<Move>& moves)
+	{
+		moves.clear();
+		size_t packed = 0;
+		int previous = -1;
+		int first = -1;
+		for (int index = allocator.first; index >= 0;)
+		{
+			int next = allocator.blocks[index].next;
+			Block& block = allocator.blocks[index];
+			if (block.free)
+			{
+				releaseBlock(allocator, index);
+			}
+			else
+			{
+				moves.push_back({ index, block.offset, packed, block.size });
+				block.offset = packed;
+				block.previous = previous;
+				block.next = -1;
+				if (previous >= 0) allocator.blocks[previous].next = index;
+				else first = index;
+				packed += block.size;
+				previous = index;
+			}
+			index = next;
+		}
+
+		clearFreeLists(allocator);
+		if (packed < allocator.capacity)
+		{
+			int rest = newBlock(allocator);
+			allocator.blocks[rest] = { packed, allocator.capacity - packed, previous, -1, -1, -1, false, false };
+			if (previous >= 0) allocator.blocks[previous].next = rest;
+			else first = rest;
+			insertFree(allocator, rest);
+		}
+		allocator.first = first;
+	}
+
+}
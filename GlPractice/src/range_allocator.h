@@ -0,0 +1,69 @@
+#ifndef RANGE_ALLOCATOR_H
+#define RANGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+// TLSF (two level segregated fit, Masmano et al. 2004) allocator of ranges of [0, capacity).
+// It never touches the memory it manages, so it works for GPU buffers: the ranges are offsets into a
+// buffer object and the block bookkeeping lives on the CPU. The unit is up to the caller (bytes,
+// vertices, indices). Free blocks are kept in lists by size class, the first level is the power of two,
+// the second level splits it into SL_COUNT linear steps. Two bitmaps say which lists have blocks, so
+// allocate and free are constant time, free merges a block with its free neighbours right away.
+namespace range_allocator {
+    typedef int Handle;
+
+    const int SL_BITS = 4;
+    const int SL_COUNT = 1 << SL_BITS;
+    const int FL_COUNT = 48;
+
+    struct Block {
+        size_t offset;
+        size_t size;
+        // the blocks next to it in the range, -1 at the ends
+        int previous, next;
+        // the free list the block is in, if it is free
+        int previousFree, nextFree;
+        bool free;
+        // the record is not used by any block and can be reused
+        bool unused;
+    };
+
+    struct Allocator {
+        size_t capacity;
+        size_t used;
+        size_t allocations;
+        std::vector<Block> blocks;
+        std::vector<int> unusedBlocks;
+        // the block at offset 0
+        int first;
+        unsigned long long firstLevelMap;
+        unsigned int secondLevelMap[FL_COUNT];
+        int freeLists[FL_COUNT][SL_COUNT];
+    };
+
+    // where compact() put an allocation
+    struct Move {
+        Handle handle;
+        size_t from;
+        size_t to;
+        size_t size;
+    };
+
+    void create(Allocator& allocator, size_t capacity);
+    // returns -1 if there is no free block of at least size units
+    Handle allocate(Allocator& allocator, size_t size);
+    void free(Allocator& allocator, Handle handle);
+
+    size_t offset(const Allocator& allocator, Handle handle);
+    size_t size(const Allocator& allocator, Handle handle);
+    // the biggest allocation that would succeed right now
+    size_t largestFree(const Allocator& allocator);
+
+    // Packs every allocation to the front of the range in the order they are in, the free space becomes one
+    // block at the end. The handles stay valid. moves gets every allocation, moved or not, with its old and
+    // new offset, so the caller can copy the data into a new buffer.
+    void compact(Allocator& allocator, std::vector<Move>& moves);
+}
+
+#endif
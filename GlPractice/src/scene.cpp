@@ -0,0 +1,77 @@
+#include <vector>
+#include <cstring>
+#include "scene.h"
+#include "practice.h"
+#include "hello_triangle_excercise.h"
+#include "uniforms.h"
+#include "shader_data.h"
+#include "texture.h"
+#include "streaming.h"
+#include "batching.h"
+#include "instancing.h"
+#include "vertex_fetch.h"
+#include "obj_mesh.h"
+#include "suballocation.h"
+#include "level_of_detail.h"
+#include "multi_draw_indirect.h"
+#include "texture_streaming.h"
+#include "texture_eviction.h"
+
+namespace scene {
+
+	std::vector<Scene> scenes;
+
+	void registerScene(const Scene& scene)
+	{
+		// registering the same name twice would make the scenes unreachable by name
+		if (findScene(scene.name) != NULL) return;
+		scenes.push_back(scene);
+	}
+
+	void registerAll()
+	{
+		// the order here is the order of the number keys in the runner
+		practice::registerScene();
+		hello_triangle::registerScene();
+		uniforms::registerScene();
+		shader_data::registerScene();
+		texture::registerScene();
+		streaming::registerScene();
+		batching::registerScene();
+		instancing::registerScene();
+		vertex_fetch::registerScene();
+		obj_mesh::registerScene();
+		suballocation::registerScene();
+		level_of_detail::registerScene();
+		multi_draw_indirect::registerScene();
+		texture_streaming::registerScene();
+		texture_eviction::registerScene();
+	}
+
+	const Scene* findScene(const char* name)
+	{
+		int index = findSceneIndex(name);
+		if (index < 0) return NULL;
+		return &scenes[index];
+	}
+
+	int findSceneIndex(const char* name)
+	{
+		for (size_t i = 0; i < scenes.size(); i++)
+		{
+			if (std::strcmp(scenes[i].name, name) == 0) return (int)i;
+		}
+		return -1;
+	}
+
+	int sceneCount()
+	{
+		return (int)scenes.size();
+	}
+
+	const Scene& sceneAt(int index)
+	{
+		return scenes[index];
+	}
+
+}
@@ -0,0 +1,30 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+// A scene is one demo that can be started and stopped inside an already existing GL context.
+// The demos register themselves here and the runner (or the benchmark) switches between them by name.
+namespace scene {
+    struct Scene {
+        const char* name;
+        // creates the GL objects of the scene, returns 0 on success
+        int (*init)();
+        // advances the animations, time is in seconds. Can be NULL for static scenes.
+        void (*update)(double time);
+        // draws one frame into the currently bound framebuffer
+        void (*render)();
+        // deletes every GL object created by init
+        void (*shutdown)();
+    };
+
+    void registerScene(const Scene& scene);
+    // registers every demo of the project, safe to call more than once
+    void registerAll();
+    // returns NULL if there is no scene with the given name
+    const Scene* findScene(const char* name);
+    // returns -1 if there is no scene with the given name
+    int findSceneIndex(const char* name);
+    int sceneCount();
+    const Scene& sceneAt(int index);
+}
+
+#endif
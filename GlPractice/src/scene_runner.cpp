@@ -0,0 +1,214 @@
+#include <iostream>
+#include <string>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "scene_runner.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "texture_loader.h"
+
+namespace runner {
+
+	GLFWwindow* window = NULL;
+	int current = -1;
+	// scene requested from the key callback, switched at the start of the next frame
+	int pending = -1;
+
+	int main(int argc, char** argv) {
+		scene::registerAll();
+
+		// the default matches the demo that was hard-coded before the scenes could be switched
+		const char* sceneName = argc > 1 ? argv[1] : "texture";
+		int index = scene::findSceneIndex(sceneName);
+		if (index < 0)
+		{
+			std::cout << "ERROR::RUNNER::UNKNOWN_SCENE " << sceneName << "\navailable scenes:" << std::endl;
+			for (int i = 0; i < scene::sceneCount(); i++)
+			{
+				std::cout << "  " << (i + 1) << ": " << scene::sceneAt(i).name << std::endl;
+			}
+			return -1;
+		}
+
+		if (initContext(800, 800, true) != 0) return -1;
+
+		// Tell GLFW to call framebuffer_size_callback when the window gets resized by the user. 
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+		glfwSetKeyCallback(window, key_callback);
+
+		if (switchScene(index) != 0)
+		{
+			terminate();
+			return -1;
+		}
+
+		// We need to create the render loop or else the application shuts down immediately.
+		while (!glfwWindowShouldClose(window))
+		{
+			if (pending >= 0 && pending != current)
+			{
+				// a failing scene leaves nothing running, the previous one is already shut down
+				switchScene(pending);
+			}
+			pending = -1;
+
+			// hand over the programs that finished compiling since the last frame
+			shader_compiler::poll();
+			// and upload some of the textures that finished decoding
+			texture_loader::update();
+
+			if (current >= 0)
+			{
+				const scene::Scene& active = scene::sceneAt(current);
+				if (active.update != NULL) active.update(glfwGetTime());
+				active.render();
+			}
+			else
+			{
+				glClearColor(.0f, .0f, .0f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+			}
+
+			// OpenGl uses a double buffering technique, where the front buffer is the buffer that gets rendered to the user
+			// while the back buffer is the one where current rendering tasks happen. When the framework finishes its work on
+			// the back buffer, the front buffer will get replaced by it. This is to avoid flickering issues.
+			glfwSwapBuffers(window);
+			// Poll for events. Important because the registered callbacks/event handlers gets notified by polling events.
+			glfwPollEvents();
+		}
+
+		terminate();
+
+		return 0;
+	}
+
+	int initContext(int width, int height, bool visible) {
+		if (window != NULL) return 0;
+
+		// init glfw
+		glfwInit();
+		// hint window for OpenGl version 3.3
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		// Telling GLFW we want to use the core-profile means we'll get access to a smaller subset of OpenGL
+		// features without backwards-compatible features we no longer need.
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+		// request glfw to create a window
+		window = glfwCreateWindow(width, height, "GlPractice", NULL, NULL);
+		// check for error during window creation
+		if (window == NULL)
+		{
+			std::cout << "ERROR::WINDOW::FAILED_TO_CREATE" << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		// set the current context to the created window
+		glfwMakeContextCurrent(window);
+		// initialize glad
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			std::cout << "ERROR::GLAD::FAILED_TO_INITIALIZE" << std::endl;
+			glfwDestroyWindow(window);
+			window = NULL;
+			glfwTerminate();
+			return -1;
+		}
+
+		glViewport(0, 0, width, height);
+
+		if (shader_compiler::init() != 0 || texture_loader::init() != 0)
+		{
+			terminate();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	GLFWwindow* getWindow()
+	{
+		return window;
+	}
+
+	int switchScene(int index)
+	{
+		if (index < 0 || index >= scene::sceneCount()) return -1;
+
+		stopScene();
+
+		const scene::Scene& next = scene::sceneAt(index);
+		if (next.init() != 0)
+		{
+			std::cout << "ERROR::RUNNER::SCENE_INIT_FAILED " << next.name << std::endl;
+			// init can fail halfway, let the scene clean up whatever it managed to create
+			next.shutdown();
+			return -1;
+		}
+		current = index;
+
+		if (window != NULL)
+		{
+			glfwSetWindowTitle(window, (std::string("GlPractice - ") + next.name).c_str());
+		}
+
+		return 0;
+	}
+
+	void stopScene()
+	{
+		if (current < 0) return;
+
+		scene::sceneAt(current).shutdown();
+		current = -1;
+
+		// dont let the state of one scene leak into the next one
+		glUseProgram(0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	int currentScene()
+	{
+		return current;
+	}
+
+	void terminate()
+	{
+		if (window == NULL) return;
+
+		stopScene();
+		texture_loader::shutdown();
+		shader_compiler::shutdown();
+		// Free resources allocated by the framework upon closing the app.
+		glfwTerminate();
+		window = NULL;
+	}
+
+	void framebuffer_size_callback(GLFWwindow*, int width, int height)
+	{
+		// If the windows gets resized, reset the viewport to take up the whole screen.
+		glViewport(0, 0, width, height);
+	}
+
+	void key_callback(GLFWwindow* window, int key, int, int action, int)
+	{
+		if (action != GLFW_PRESS) return;
+
+		if (key == GLFW_KEY_ESCAPE)
+		{
+			glfwSetWindowShouldClose(window, true);
+		}
+		else if (key >= GLFW_KEY_1 && key <= GLFW_KEY_9)
+		{
+			int index = key - GLFW_KEY_1;
+			if (index < scene::sceneCount()) pending = index;
+		}
+		else if (key == GLFW_KEY_TAB && scene::sceneCount() > 0)
+		{
+			pending = (current + 1) % scene::sceneCount();
+		}
+	}
+
+}
@@ -0,0 +1,27 @@
+#ifndef SCENE_RUNNER_H
+#define SCENE_RUNNER_H
+
+struct GLFWwindow;
+
+// Owns the only window and GL context of the process and switches between the registered scenes.
+namespace runner {
+    // usage: GlPractice [scene name]
+    int main(int argc, char** argv);
+    // creates the window and loads GL, only the first call does any work
+    int initContext(int width, int height, bool visible);
+    GLFWwindow* getWindow();
+    // shuts down the current scene and starts the given one, returns 0 on success
+    int switchScene(int index);
+    // shuts down the current scene, if there is one
+    void stopScene();
+    // index of the running scene, -1 if none
+    int currentScene();
+    // stops the current scene and destroys the context
+    void terminate();
+    // Prototype for a method that gets called if the user resizes the window.
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    // number keys select a scene, tab steps to the next one, escape quits
+    void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+}
+
+#endif
@@ -0,0 +1,260 @@
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include "shader_compiler.h"
+#include "program_cache.h"
+#include "stage_cache.h"
+
+namespace shader_compiler {
+
+	struct Job {
+		JobState state;
+		unsigned int program;
+		unsigned int vertexShader, fragmentShader;
+		// program cache key, 0 if the binary should not be stored
+		unsigned long long cacheKey;
+		ReadyCallback onReady;
+	};
+
+	const char* fallbackVertexSrc = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+void main()
+{
+    gl_Position = vec4(aPos.xyz, 1.0);
+}
+)";
+	const char* fallbackFragmentSrc = R"(
+#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.5f, 0.5f, 0.5f, 1.0f);
+}
+)";
+
+	std::vector<Job> jobs;
+	// slots of released jobs, submit() reuses them so the scenes can be switched forever
+	std::vector<Handle> freeJobs;
+	int pending = 0;
+	Handle fallbackJob = -1;
+	unsigned int fallback = 0;
+
+	void onFallbackReady(unsigned int program)
+	{
+		fallback = program;
+	}
+
+	int init()
+	{
+		if (fallbackJob >= 0) return 0;
+
+		if (parallelSupported())
+		{
+			// let the driver pick how many threads it wants to use
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		}
+
+		// The fallback is needed before anything else is ready, so we wait for it right away.
+		// It still goes through submit, so its vertex shader is shared with scenes using the same one.
+		fallbackJob = submit(fallbackVertexSrc, fallbackFragmentSrc, onFallbackReady);
+		waitAll();
+		return fallback != 0 ? 0 : -1;
+	}
+
+	void shutdown()
+	{
+		for (size_t i = 0; i < jobs.size(); i++) release((Handle)i);
+		jobs.clear();
+		freeJobs.clear();
+		pending = 0;
+		fallbackJob = -1;
+		fallback = 0;
+	}
+
+	bool parallelSupported()
+	{
+		return GLAD_GL_KHR_parallel_shader_compile && glMaxShaderCompilerThreadsKHR != NULL;
+	}
+
+	// The stages stay attached until the program is released. That keeps their reference in the stage cache
+	// alive, so a program submitted later with the same stage does not have to compile it again.
+	void releaseShaders(Job& job)
+	{
+		if (job.vertexShader != 0)
+		{
+			glDetachShader(job.program, job.vertexShader);
+			stage_cache::release(job.vertexShader);
+		}
+		if (job.fragmentShader != 0)
+		{
+			glDetachShader(job.program, job.fragmentShader);
+			stage_cache::release(job.fragmentShader);
+		}
+		job.vertexShader = job.fragmentShader = 0;
+	}
+
+	// hands the program to the owner, or reports why it could not be linked
+	void finish(Job& job)
+	{
+		int success;
+		glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+		if (success)
+		{
+			program_cache::storeCached(job.program, job.cacheKey);
+			job.state = JOB_READY;
+			if (job.onReady != NULL) job.onReady(job.program);
+			return;
+		}
+
+		// the link failed, find out if it was because one of the stages did not compile
+		char infoLog[512];
+		unsigned int stages[] = { job.vertexShader, job.fragmentShader };
+		const char* stageNames[] = { "VERTEX", "FRAGMENT" };
+		bool compileFailed = false;
+		for (int i = 0; i < 2; i++)
+		{
+			glGetShaderiv(stages[i], GL_COMPILE_STATUS, &success);
+			if (!success)
+			{
+				glGetShaderInfoLog(stages[i], 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::" << stageNames[i] << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+				compileFailed = true;
+			}
+		}
+		if (!compileFailed)
+		{
+			glGetProgramInfoLog(job.program, 512, NULL, infoLog);
+			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+
+		releaseShaders(job);
+		glDeleteProgram(job.program);
+		job.program = 0;
+		job.state = JOB_FAILED;
+	}
+
+	Handle submit(const char* vertexSrc, const char* fragmentSrc, ReadyCallback onReady)
+	{
+		Job job = {};
+		job.state = JOB_PENDING;
+		job.onReady = onReady;
+		job.program = glCreateProgram();
+		if (job.program == 0) return -1;
+
+		Handle handle = (Handle)jobs.size();
+		if (!freeJobs.empty())
+		{
+			handle = freeJobs.back();
+			freeJobs.pop_back();
+		}
+		else jobs.push_back(Job());
+
+		if (program_cache::loadCached(job.program, vertexSrc, fragmentSrc, job.cacheKey) == 0)
+		{
+			// the binary came from the cache, writing it back would only rewrite the same file
+			job.cacheKey = 0;
+			jobs[handle] = job;
+			finish(jobs[handle]);
+			return handle;
+		}
+
+		// Issue everything and dont look at the result. The link is queued behind the compiles,
+		// a stage that fails to compile simply makes the link fail, which finish() sorts out.
+		// Stages that are already alive for another program are reused instead of compiled again.
+		job.vertexShader = stage_cache::acquire(GL_VERTEX_SHADER, vertexSrc);
+		job.fragmentShader = stage_cache::acquire(GL_FRAGMENT_SHADER, fragmentSrc);
+		glAttachShader(job.program, job.vertexShader);
+		glAttachShader(job.program, job.fragmentShader);
+		glLinkProgram(job.program);
+
+		jobs[handle] = job;
+		pending++;
+
+		return handle;
+	}
+
+	int poll()
+	{
+		if (pending == 0) return 0;
+
+		bool parallel = parallelSupported();
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			Job& job = jobs[i];
+			if (job.state != JOB_PENDING) continue;
+
+			if (parallel)
+			{
+				// the one query that does not wait for the driver
+				int done = 0;
+				glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &done);
+				if (!done) continue;
+			}
+
+			// Without the extension asking for the status blocks until that program is linked.
+			// The driver may still have compiled the rest in the meantime, but to keep frames short
+			// only one program is waited for per poll.
+			finish(job);
+			pending--;
+			if (!parallel) break;
+		}
+
+		return pending;
+	}
+
+	void waitAll()
+	{
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			if (jobs[i].state != JOB_PENDING) continue;
+			finish(jobs[i]);
+			pending--;
+		}
+	}
+
+	void release(Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)jobs.size()) return;
+
+		Job& job = jobs[handle];
+		if (job.state == JOB_RELEASED) return;
+		if (job.state == JOB_PENDING) pending--;
+
+		releaseShaders(job);
+		glDeleteProgram(job.program);
+		job.program = 0;
+		job.state = JOB_RELEASED;
+		freeJobs.push_back(handle);
+	}
+
+	JobState state(Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)jobs.size()) return JOB_FAILED;
+		return jobs[handle].state;
+	}
+
+	unsigned int program(Handle handle)
+	{
+		if (state(handle) != JOB_READY) return 0;
+		return jobs[handle].program;
+	}
+
+	int pendingCount()
+	{
+		return pending;
+	}
+
+	unsigned int fallbackProgram()
+	{
+		return fallback;
+	}
+
+	void useProgram(unsigned int program)
+	{
+		glUseProgram(program != 0 ? program : fallback);
+	}
+
+}
@@ -0,0 +1,55 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+// Compiles programs without waiting for them.
+// Asking for GL_COMPILE_STATUS or GL_LINK_STATUS right after glCompileShader / glLinkProgram forces the driver
+// to finish that one compilation before it returns, so compiling N programs takes the sum of N compile times.
+// Here every program is submitted first and only checked later: with KHR_parallel_shader_compile we ask
+// GL_COMPLETION_STATUS_KHR (which never blocks) every frame, so the driver can compile them all in parallel.
+// Until a program is done the scene can draw with the fallback program.
+namespace shader_compiler {
+    enum JobState {
+        JOB_PENDING,
+        JOB_READY,
+        JOB_FAILED,
+        // the owner released the program
+        JOB_RELEASED
+    };
+
+    // identifies a submitted program, -1 is never a valid handle
+    typedef int Handle;
+
+    // Gets called on the GL thread once the program linked. The program still belongs to the job,
+    // so it must not be deleted with glDeleteProgram, call release() instead.
+    typedef void (*ReadyCallback)(unsigned int program);
+
+    // compiles the fallback program and turns on the driver's compiler threads, returns 0 on success
+    int init();
+    // deletes the fallback program and releases every job that is still alive
+    void shutdown();
+
+    // Starts compiling and linking the program, returns a handle to it (-1 on failure).
+    // If the program is in the program cache it is ready right away and onReady is called before this returns.
+    Handle submit(const char* vertexSrc, const char* fragmentSrc, ReadyCallback onReady);
+    // Checks the pending programs without blocking and calls the callbacks of the finished ones.
+    // Returns how many are still pending. Call it once per frame.
+    int poll();
+    // blocks until every submitted program is done
+    void waitAll();
+    // Deletes the program of the job (pending or not) and drops its references to the shared stages.
+    // The handle may be given to a later submit, forget it (set it to -1) after releasing it.
+    void release(Handle handle);
+    JobState state(Handle handle);
+    // the linked program of the job, 0 while it is not ready
+    unsigned int program(Handle handle);
+    int pendingCount();
+    // true if the driver compiles in the background (KHR_parallel_shader_compile)
+    bool parallelSupported();
+
+    // a plain grey program with the position at location 0
+    unsigned int fallbackProgram();
+    // binds the program, or the fallback program if program is 0 (not compiled yet)
+    void useProgram(unsigned int program);
+}
+
+#endif
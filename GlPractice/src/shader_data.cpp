@@ -1,80 +1,71 @@
 #include <iostream>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include "shader_data.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "shader_preprocessor.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
 
 /// <summary>
 /// Custom shader data, not just the points coordinates
 /// </summary>
 namespace shader_data {
 
-	GLFWwindow* window;
 	// hint: could just attach and detach the yellow and orange shaders
 	unsigned int shaderProgram;
-	unsigned int VAO;
-
-	const char* vertexShaderSrc = R"(
-#version 330 core
-
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
-
-out vec4 vtxColor;
-
-void main()
-{
-    gl_Position = vec4(aPos.xyz, 1.0);
-    vtxColor = vec4(aColor, 1.0);
-}
-)";
-	const char* fragmentShaderSrc = R"(
-#version 330 core
-
-in vec4 vtxColor;
-
-out vec4 FragColor;
-
-void main()
-{
-    FragColor = vtxColor;
-}
-)";
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO;
+	// half float position, byte color: 12 bytes instead of the 24 of 6 floats
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, vertex_layout::half, 3>,
+		vertex_layout::Attr<1, vertex_layout::ubyte, 3, vertex_layout::normalized>> VertexLayout;
+
+	// uber mode only: the switches of the uber-shader, the specialized variant has no uniforms
+	uniform_table::Table uniformTable;
+	uniform_table::IntHandle useVertexColorHandle = { -1 };
+	uniform_table::IntHandle useTextureHandle = { -1 };
+
+	void registerScene()
+	{
+		scene::registerScene({ "shader_data", init, NULL, render, shutdown });
+	}
 
-	int main() {
-		// 1. create a window, initialize OpenGL
-		if (initContext() != 0) return -1;
-		// 2. black background color
-		glClearColor(.0f, .0f, .0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		// 3. initialize shaders
+	int init() {
+		// 1. initialize shaders
 		if (initShaders() != 0) return -1;
-		// 4. create two triangles
+		// 2. create the triangles
 		initVAOs();
 
-		// 5. create render loop
-		while (!glfwWindowShouldClose(window))
-		{
-			// 6. render the triangles
-			renderTriangles();
-
-			if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-			{
-				glfwSetWindowShouldClose(window, true);
-			}
-
-			glfwPollEvents();
-			glfwSwapBuffers(window);
-		}
+		return 0;
+	}
 
-		// 7. clean resources
-		glfwTerminate();
+	void render()
+	{
+		// black background color
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		// render the triangles
+		renderTriangles();
+	}
 
-		return 0;
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = shaderProgram = 0;
+		programJob = -1;
+		useVertexColorHandle = useTextureHandle = { -1 };
 	}
 
 	void renderTriangles()
 	{
-		glUseProgram(shaderProgram);
+		shader_compiler::useProgram(shaderProgram);
+		// the handles are only valid for the uber-shader, otherwise these do nothing
+		uniform_table::setInt(uniformTable, useVertexColorHandle, 1);
+		uniform_table::setInt(uniformTable, useTextureHandle, 0);
 
 		glBindVertexArray(VAO);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
@@ -83,16 +74,24 @@ void main()
 	}
 
 	void initVAOs() {
-		// create the two triangles in RAM
-		float vertices[] = {
-			// positions          // colors
-			-.5f, -.5f, .0f,      1.f, .0f, .0f,
-			.5f, -.5f, .0f,       .0f, 1.f, .0f,
-			.0f, .5f, .0f,        .0f, .0f, 1.f
+		// create the triangle in RAM
+		float positions[] = {
+			-.5f, -.5f, .0f,
+			.5f, -.5f, .0f,
+			.0f, .5f, .0f
+		};
+		float colors[] = {
+			1.f, .0f, .0f,
+			.0f, 1.f, .0f,
+			.0f, .0f, 1.f
 		};
 
+		// convert the floats into the vertex layout
+		unsigned char vertices[VertexLayout::bufferSize(3)];
+		VertexLayout::fill<0>(vertices, 3, positions);
+		VertexLayout::fill<1>(vertices, 3, colors);
+
 		// create VBO
-		unsigned int VBO;
 		glGenBuffers(1, &VBO);
 
 		// create VAO
@@ -105,99 +104,33 @@ void main()
 		// copy the vertices into VBO
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 		// tell OpenGl how to interpret the data in VBO
-		// since position isnt the only thing in the VBO, we need to configure the attribute pointers
-		// [layout=0], [the data type is float], [do not normalize], [stride is 6 times of float], [first byte of the data]
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		// [layout=1], [the data type is float], [do not normalize], [stride is 6 times of float], [start byte of the data]
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
+		// the layout knows every attribute's type, normalize flag, stride and offset:
+		// [layout=0], [half floats], [not normalized], [stride is 12 bytes], [first byte of the data]
+		// [layout=1], [unsigned bytes], [normalized, 255 is 1.0 in the shader], [stride is 12 bytes], [9th byte of the data, offset 8]
+		VertexLayout::setup(VBO, 3);
 		// unbind VAO
 		glBindVertexArray(0);
 	}
 
 	int initShaders() {
-		// compile shaders by creating a shader object and attaching the shader sources to them
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-		glShaderSource(vertexShader, 1, &vertexShaderSrc, NULL);
-		glShaderSource(fragmentShader, 1, &fragmentShaderSrc, NULL);
-
-		glCompileShader(vertexShader);
-		glCompileShader(fragmentShader);
-
-		int success;
-		char infoLog[512];
-
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		shaderProgram = glCreateProgram();
-
-		glAttachShader(shaderProgram, vertexShader);
-		glAttachShader(shaderProgram, fragmentShader);
-
-		glLinkProgram(shaderProgram);
-
-		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
-
-		return 0;
+		// the shaders are built from the files in the shaders directory, only with the vertex colors switched on
+		std::vector<std::string> defines = { shader_preprocessor::uberShaders() ? "UBER_SHADER" : "USE_VERTEX_COLOR" };
+		const std::string* vertexShaderSrc = shader_preprocessor::variant("basic.vert", defines);
+		const std::string* fragmentShaderSrc = shader_preprocessor::variant("basic.frag", defines);
+		if (vertexShaderSrc == NULL || fragmentShaderSrc == NULL) return -1;
+
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc->c_str(), fragmentShaderSrc->c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
 	}
 
-	int initContext() {
-		int width = 800, height = 800;
-		// init glfw
-		glfwInit();
-		// hint window for OpenGl version 3.3
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-		// hint window to use core profile
-		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-		// request glfw to create a window
-		window = glfwCreateWindow(width, height, "Hello triangle excercise", NULL, NULL);
-		// check for error during window creation
-		if (window == NULL)
-		{
-			std::cout << "ERROR::WINDOW::FAILED_TO_CREATE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-		// set the current context to the created window
-		glfwMakeContextCurrent(window);
-		// initialize glad
-		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-		{
-			std::cout << "ERROR::GLAD::FAILED_TO_INITIALIZE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-
-		glViewport(0, 0, width, height);
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
 
-		return 0;
+		uniform_table::build(uniformTable, shaderProgram);
+		useVertexColorHandle = uniform_table::getInt(uniformTable, "useVertexColor");
+		useTextureHandle = uniform_table::getInt(uniformTable, "useTexture");
 	}
 
 }
\ No newline at end of file
@@ -2,9 +2,15 @@
 #define SHADER_DATA_H
 
 namespace shader_data {
-    int main();
-    int initContext();
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // clears the screen and draws the triangles
+    void render();
+    void shutdown();
     int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
     void initVAOs();
     void renderTriangles();
 }
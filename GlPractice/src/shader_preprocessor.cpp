@@ -0,0 +1,212 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include "shader_preprocessor.h"
+#include "program_cache.h"
+
+namespace shader_preprocessor {
+
+	std::string directory = "shaders";
+	bool uber = false;
+	Stats stats = {};
+	// file name -> content, files are only read from the disk once
+	std::map<std::string, std::string> files;
+	// variant key -> generated source, a map so the returned pointers stay valid
+	std::map<unsigned long long, std::string> variants;
+
+	void setDirectory(const char* path)
+	{
+		directory = path;
+		clearVariants();
+	}
+
+	const std::string* readFile(const std::string& name)
+	{
+		auto found = files.find(name);
+		if (found != files.end()) return &found->second;
+
+		std::ifstream file(directory + "/" + name, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "ERROR::SHADER_PREPROCESSOR::FILE_NOT_FOUND " << directory << "/" << name << std::endl;
+			return NULL;
+		}
+		std::stringstream content;
+		content << file.rdbuf();
+		return &(files[name] = content.str());
+	}
+
+	// returns the file name of an #include line, or an empty string if the line is something else
+	std::string includeTarget(const std::string& line)
+	{
+		size_t pos = line.find_first_not_of(" \t");
+		if (pos == std::string::npos || line[pos] != '#') return "";
+		pos = line.find_first_not_of(" \t", pos + 1);
+		if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) return "";
+		size_t open = line.find('"', pos + 7);
+		size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+		if (close == std::string::npos) return "";
+		return line.substr(open + 1, close - open - 1);
+	}
+
+	bool isVersionLine(const std::string& line)
+	{
+		size_t pos = line.find_first_not_of(" \t");
+		return pos != std::string::npos && line.compare(pos, 8, "#version") == 0;
+	}
+
+	// Makes the line after the directive line number line of the source string. Up to GLSL 4.10 "#line N"
+	// means the next line is N + 1, since 4.20 it is N like in C.
+	std::string lineDirective(int line, int sourceNumber, int version)
+	{
+		if (version < 420) line--;
+		return "#line " + std::to_string(line) + " " + std::to_string(sourceNumber) + "\n";
+	}
+
+	// Appends the file to out with its includes expanded. Every included file gets its own source string
+	// number in the #line directives, so compile errors can still be traced back to the right file.
+	int expand(const std::string& name, std::vector<std::string>& included, std::vector<std::string>& stack,
+		const std::vector<std::string>& defines, int& version, std::string& out)
+	{
+		if (std::find(stack.begin(), stack.end(), name) != stack.end())
+		{
+			std::cout << "ERROR::SHADER_PREPROCESSOR::CIRCULAR_INCLUDE " << name << std::endl;
+			return -1;
+		}
+		const std::string* content = readFile(name);
+		if (content == NULL) return -1;
+
+		stack.push_back(name);
+		int sourceNumber = (int)(std::find(included.begin(), included.end(), name) - included.begin());
+
+		std::istringstream lines(*content);
+		std::string line;
+		int lineNumber = 0;
+		while (std::getline(lines, line))
+		{
+			lineNumber++;
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+
+			std::string target = includeTarget(line);
+			if (!target.empty())
+			{
+				// like #pragma once, a file that was already pasted in is skipped
+				if (std::find(included.begin(), included.end(), target) == included.end())
+				{
+					included.push_back(target);
+					out += lineDirective(1, (int)included.size() - 1, version);
+					if (expand(target, included, stack, defines, version, out) != 0) return -1;
+					out += lineDirective(lineNumber + 1, sourceNumber, version);
+				}
+				continue;
+			}
+
+			out += line;
+			out += '\n';
+
+			// the defines have to come after #version, which has to be the first thing in the source
+			if (stack.size() == 1 && isVersionLine(line))
+			{
+				version = std::atoi(line.c_str() + line.find("#version") + 8);
+				for (const std::string& define : defines)
+				{
+					size_t equals = define.find('=');
+					if (equals == std::string::npos) out += "#define " + define + "\n";
+					else out += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
+				}
+				out += lineDirective(lineNumber + 1, 0, version);
+			}
+		}
+
+		stack.pop_back();
+		return 0;
+	}
+
+	int preprocess(const char* file, const std::vector<std::string>& defines, std::string& out)
+	{
+		out.clear();
+		std::vector<std::string> included = { file };
+		std::vector<std::string> stack;
+		// without a #version line the source is GLSL 1.10
+		int version = 110;
+		return expand(file, included, stack, defines, version, out);
+	}
+
+	// Hashes the content of the file and of everything it includes, in the order expand() pastes them in,
+	// so a variant is generated again when one of its includes changed. Returns -1 if a file is missing.
+	int hashContents(const std::string& name, std::vector<std::string>& included, unsigned long long& key)
+	{
+		const std::string* content = readFile(name);
+		if (content == NULL) return -1;
+		key = program_cache::hash(content->data(), content->size(), key);
+
+		std::istringstream lines(*content);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			std::string target = includeTarget(line);
+			if (target.empty() || std::find(included.begin(), included.end(), target) != included.end()) continue;
+			included.push_back(target);
+			if (hashContents(target, included, key) != 0) return -1;
+		}
+		return 0;
+	}
+
+	const std::string* variant(const char* file, const std::vector<std::string>& defines)
+	{
+		// the same set of defines in a different order is the same variant
+		std::vector<std::string> sorted = defines;
+		std::sort(sorted.begin(), sorted.end());
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+		unsigned long long key = program_cache::hash(file, std::char_traits<char>::length(file) + 1);
+		std::vector<std::string> included = { file };
+		if (hashContents(file, included, key) != 0) return NULL;
+		for (const std::string& define : sorted)
+		{
+			key = program_cache::hash(define.c_str(), define.size() + 1, key);
+		}
+
+		auto found = variants.find(key);
+		if (found != variants.end())
+		{
+			stats.reused++;
+			return &found->second;
+		}
+
+		std::string source;
+		if (preprocess(file, sorted, source) != 0) return NULL;
+		stats.generated++;
+		return &(variants[key] = source);
+	}
+
+	void clearVariants()
+	{
+		variants.clear();
+		files.clear();
+	}
+
+	void setUberShaders(bool enabled)
+	{
+		uber = enabled;
+	}
+
+	bool uberShaders()
+	{
+		return uber;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,40 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+
+// Builds shader sources from the files in the shader directory.
+// #include "file" is resolved against the directory (every file is included at most once per source),
+// and permutation defines are injected right after #version. Each (source, define set) variant is
+// generated only once, later requests return the same string.
+namespace shader_preprocessor {
+    struct Stats {
+        // variants that had to be generated
+        unsigned long long generated;
+        // variants returned from the cache
+        unsigned long long reused;
+    };
+
+    // where the shader files are, "shaders" by default
+    void setDirectory(const char* path);
+
+    // Reads the file and resolves its includes, then adds a #define for every entry of defines
+    // ("NAME" or "NAME=VALUE"). Returns 0 on success.
+    int preprocess(const char* file, const std::vector<std::string>& defines, std::string& out);
+    // Same as preprocess, but every variant is generated once and kept, the order of the defines does
+    // not matter. Returns NULL on failure. The returned string lives until clearVariants is called.
+    const std::string* variant(const char* file, const std::vector<std::string>& defines);
+    // forgets the generated variants and the cached file contents
+    void clearVariants();
+
+    // When on, scenes build their uber-shader (UBER_SHADER, features switched by uniforms at runtime)
+    // instead of a variant specialized to the features they use. Used to compare the two.
+    void setUberShaders(bool enabled);
+    bool uberShaders();
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include <vector>
+#include <glad/glad.h>
+#include "stage_cache.h"
+#include "program_cache.h"
+
+namespace stage_cache {
+
+	struct Stage {
+		unsigned int type;
+		unsigned long long hash;
+		unsigned int shader;
+		int references;
+	};
+
+	// there are only ever a few dozen stages alive, a linear search is fine
+	std::vector<Stage> stages;
+	Stats stats = {};
+
+	std::string normalize(const char* src)
+	{
+		std::string out;
+		out.reserve(std::char_traits<char>::length(src));
+
+		// pending whitespace is only written once we know something follows it on the same line
+		bool space = false;
+		for (const char* c = src; *c != '\0'; c++)
+		{
+			if (c[0] == '/' && c[1] == '/')
+			{
+				while (*c != '\0' && *c != '\n') c++;
+				if (*c == '\0') break;
+			}
+			else if (c[0] == '/' && c[1] == '*')
+			{
+				c += 2;
+				while (*c != '\0' && !(c[0] == '*' && c[1] == '/')) c++;
+				if (*c == '\0') break;
+				c++;
+				// a block comment separates tokens like a space does
+				space = true;
+				continue;
+			}
+
+			if (*c == '\n')
+			{
+				// newlines matter for the preprocessor, but empty lines dont
+				if (!out.empty() && out.back() != '\n') out += '\n';
+				space = false;
+			}
+			else if (*c == ' ' || *c == '\t' || *c == '\r')
+			{
+				space = true;
+			}
+			else
+			{
+				if (space && !out.empty() && out.back() != '\n') out += ' ';
+				space = false;
+				out += *c;
+			}
+		}
+		if (!out.empty() && out.back() == '\n') out.pop_back();
+		return out;
+	}
+
+	unsigned int acquire(unsigned int type, const char* src)
+	{
+		std::string normalized = normalize(src);
+		unsigned long long hash = program_cache::hash(normalized.data(), normalized.size());
+
+		for (Stage& stage : stages)
+		{
+			if (stage.type == type && stage.hash == hash)
+			{
+				stage.references++;
+				stats.reuses++;
+				return stage.shader;
+			}
+		}
+
+		// the original source is compiled, not the normalized one, so line numbers in errors stay right
+		unsigned int shader = glCreateShader(type);
+		glShaderSource(shader, 1, &src, NULL);
+		glCompileShader(shader);
+		stats.compiles++;
+
+		stages.push_back({ type, hash, shader, 1 });
+		return shader;
+	}
+
+	void release(unsigned int shader)
+	{
+		if (shader == 0) return;
+
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			if (stages[i].shader != shader) continue;
+
+			if (--stages[i].references == 0)
+			{
+				glDeleteShader(shader);
+				stages.erase(stages.begin() + i);
+			}
+			return;
+		}
+	}
+
+	int liveCount()
+	{
+		return (int)stages.size();
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
@@ -0,0 +1,33 @@
+#ifndef STAGE_CACHE_H
+#define STAGE_CACHE_H
+
+#include <string>
+
+// Shares compiled shader objects between programs.
+// A stage is keyed by its type and a hash of its normalized source (comments and extra whitespace removed),
+// so the same vertex shader written out in two scenes is only compiled once per context.
+// Every program holding a stage counts as one reference, the shader object is deleted with the last one.
+namespace stage_cache {
+    struct Stats {
+        // stages that had to be compiled
+        unsigned long long compiles;
+        // stages handed out again without compiling
+        unsigned long long reuses;
+    };
+
+    // Returns a shader object for the source and adds a reference to it. A new object is only created
+    // (and glCompileShader issued, without waiting for it) if no identical stage is alive.
+    unsigned int acquire(unsigned int type, const char* src);
+    // drops a reference, the shader object is deleted when nobody uses it anymore
+    void release(unsigned int shader);
+    // number of shader objects currently alive
+    int liveCount();
+
+    // the source without comments, with whitespace collapsed, this is what gets hashed
+    std::string normalize(const char* src);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
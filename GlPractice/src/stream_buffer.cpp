@@ -0,0 +1,174 @@
+#include <iostream>
+#include <chrono>
+#include <glad/glad.h>
+#include "stream_buffer.h"
+
+namespace stream_buffer {
+
+	bool persistentEnabled = true;
+	Stats stats = {};
+
+	// the buffer is only ever bound here, binding it to GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+	// could change the state of the VAO that happens to be bound
+	const GLenum target = GL_COPY_WRITE_BUFFER;
+
+	bool persistentSupported()
+	{
+		return persistentEnabled && GLAD_GL_ARB_buffer_storage && glBufferStorage != NULL;
+	}
+
+	void setPersistentEnabled(bool enabled)
+	{
+		persistentEnabled = enabled;
+	}
+
+	int create(Buffer& buffer, size_t frameSize)
+	{
+		buffer = {};
+		buffer.frameSize = frameSize;
+		buffer.persistent = persistentSupported();
+		// the first beginFrame moves to region 0
+		buffer.frame = FRAME_COUNT - 1;
+
+		glGenBuffers(1, &buffer.id);
+		glBindBuffer(target, buffer.id);
+		if (buffer.persistent)
+		{
+			// immutable storage, mapped once for the whole life of the buffer
+			// coherent: the writes are visible to the GPU without flushing
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(target, frameSize * FRAME_COUNT, NULL, flags);
+			buffer.mapped = (unsigned char*)glMapBufferRange(target, 0, frameSize * FRAME_COUNT, flags);
+			if (buffer.mapped == NULL)
+			{
+				std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+				glBindBuffer(target, 0);
+				glDeleteBuffers(1, &buffer.id);
+				buffer.id = 0;
+				return -1;
+			}
+		}
+		else
+		{
+			glBufferData(target, frameSize * FRAME_COUNT, NULL, GL_STREAM_DRAW);
+		}
+		glBindBuffer(target, 0);
+
+		return 0;
+	}
+
+	void waitFence(Buffer& buffer, int frame)
+	{
+		GLsync fence = (GLsync)buffer.fences[frame];
+		if (fence == NULL) return;
+
+		// checking without a timeout first, so the usual case does not count as a wait
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			auto start = std::chrono::steady_clock::now();
+			// flush the commands the first time, otherwise the fence might never be submitted
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			do
+			{
+				result = glClientWaitSync(fence, flags, 1000000);
+				flags = 0;
+			} while (result == GL_TIMEOUT_EXPIRED);
+			auto end = std::chrono::steady_clock::now();
+			stats.fenceWaits++;
+			stats.fenceWaitMs += std::chrono::duration<double, std::milli>(end - start).count();
+		}
+		glDeleteSync(fence);
+		buffer.fences[frame] = NULL;
+	}
+
+	void destroy(Buffer& buffer)
+	{
+		if (buffer.id == 0) return;
+
+		for (int i = 0; i < FRAME_COUNT; i++)
+		{
+			waitFence(buffer, i);
+		}
+		if (buffer.mapped != NULL)
+		{
+			glBindBuffer(target, buffer.id);
+			glUnmapBuffer(target);
+			glBindBuffer(target, 0);
+		}
+		glDeleteBuffers(1, &buffer.id);
+		buffer = {};
+	}
+
+	void beginFrame(Buffer& buffer)
+	{
+		buffer.frame = (buffer.frame + 1) % FRAME_COUNT;
+		waitFence(buffer, buffer.frame);
+		buffer.offset = buffer.frame * buffer.frameSize;
+		stats.frames++;
+	}
+
+	void* allocate(Buffer& buffer, size_t size, size_t alignment, size_t& offset)
+	{
+		size_t start = buffer.offset;
+		if (alignment > 1 && start % alignment != 0) start += alignment - start % alignment;
+		size_t frameEnd = (buffer.frame + 1) * buffer.frameSize;
+		if (start + size > frameEnd)
+		{
+			std::cout << "ERROR::STREAM_BUFFER::OUT_OF_SPACE" << std::endl;
+			return NULL;
+		}
+
+		if (!buffer.persistent && buffer.mapped == NULL)
+		{
+			// Map the rest of the region. Unsynchronized means the driver does not wait for the GPU to stop
+			// using the buffer, the fences already made sure it does not use this part.
+			glBindBuffer(target, buffer.id);
+			buffer.mapped = (unsigned char*)glMapBufferRange(target, start, frameEnd - start,
+				GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+			glBindBuffer(target, 0);
+			if (buffer.mapped == NULL)
+			{
+				std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+				return NULL;
+			}
+			buffer.mappedOffset = start;
+			stats.maps++;
+		}
+
+		buffer.offset = start + size;
+		offset = start;
+		stats.bytes += size;
+		return buffer.mapped + (start - buffer.mappedOffset);
+	}
+
+	void flush(Buffer& buffer)
+	{
+		// the persistent mapping is coherent, there is nothing to do
+		if (buffer.persistent || buffer.mapped == NULL) return;
+
+		glBindBuffer(target, buffer.id);
+		// the flush range is relative to the mapped range
+		glFlushMappedBufferRange(target, 0, buffer.offset - buffer.mappedOffset);
+		glUnmapBuffer(target);
+		glBindBuffer(target, 0);
+		buffer.mapped = NULL;
+	}
+
+	void endFrame(Buffer& buffer)
+	{
+		flush(buffer);
+		buffer.fences[buffer.frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
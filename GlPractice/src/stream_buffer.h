@@ -0,0 +1,67 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+
+// A ring buffer for geometry that is rewritten every frame.
+// The buffer is split into FRAME_COUNT regions and every frame writes into its own one, so the CPU never
+// writes memory the GPU is still reading. A fence is placed at the end of each frame and the region is only
+// reused once its fence signaled, which usually already happened FRAME_COUNT - 1 frames ago.
+// With ARB_buffer_storage the whole buffer stays mapped (persistent, coherent), so writing vertices is a plain
+// memcpy into driver memory. Without it every write maps the range with GL_MAP_UNSYNCHRONIZED_BIT, which is
+// safe for the same reason, but costs a map/unmap per batch.
+namespace stream_buffer {
+    const int FRAME_COUNT = 3;
+
+    struct Buffer {
+        unsigned int id;
+        // size of one frame's region in bytes
+        size_t frameSize;
+        // the region being written, 0..FRAME_COUNT-1
+        int frame;
+        // next free byte, relative to the start of the buffer
+        size_t offset;
+        // start of the range mapped by the fallback, or of the whole buffer when persistent
+        unsigned char* mapped;
+        size_t mappedOffset;
+        bool persistent;
+        // one GLsync per region, NULL if the region is free
+        void* fences[FRAME_COUNT];
+    };
+
+    struct Stats {
+        unsigned long long frames;
+        unsigned long long bytes;
+        // times beginFrame had to wait for the GPU, should stay 0
+        unsigned long long fenceWaits;
+        double fenceWaitMs;
+        // map/unmap pairs of the fallback path
+        unsigned long long maps;
+    };
+
+    // true if the driver supports persistent mapping and it is not turned off
+    bool persistentSupported();
+    // forces the unsynchronized map fallback, for comparing the two paths
+    void setPersistentEnabled(bool enabled);
+
+    // creates the buffer with FRAME_COUNT regions of frameSize bytes, returns 0 on success
+    int create(Buffer& buffer, size_t frameSize);
+    // waits for the GPU and deletes the buffer
+    void destroy(Buffer& buffer);
+
+    // moves to the next region, waiting for the GPU only if it still reads it
+    void beginFrame(Buffer& buffer);
+    // Returns where size bytes can be written, offset is set to the position in the buffer (a multiple of
+    // alignment, which can be the vertex size so the offset can be used as the first vertex of a draw).
+    // Returns NULL if the frame's region is full.
+    void* allocate(Buffer& buffer, size_t size, size_t alignment, size_t& offset);
+    // makes the written data visible to the GPU, call it before drawing from the buffer
+    void flush(Buffer& buffer);
+    // flushes and fences the region of the frame
+    void endFrame(Buffer& buffer);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <cmath>
+#include <glad/glad.h>
+#include "streaming.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "shader_preprocessor.h"
+#include "stream_buffer.h"
+#include "uniform_table.h"
+
+namespace streaming {
+
+	// position + color
+	struct Vertex {
+		float x, y, z;
+		float r, g, b;
+	};
+
+	const int triangleCount = 10000;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO;
+	stream_buffer::Buffer streamBuffer = {};
+	float elapsedTime;
+	// uber mode only: the switches of the uber-shader
+	uniform_table::Table uniformTable;
+	uniform_table::IntHandle useVertexColorHandle = { -1 };
+	uniform_table::IntHandle useTextureHandle = { -1 };
+
+	void registerScene()
+	{
+		scene::registerScene({ "streaming", init, update, render, shutdown });
+	}
+
+	int init() {
+		if (initShaders() != 0) return -1;
+		return initVAOs();
+	}
+
+	void update(double time)
+	{
+		elapsedTime = (float)time;
+	}
+
+	void render()
+	{
+		// black background color
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		// render the triangles
+		renderTriangles();
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		stream_buffer::destroy(streamBuffer);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = shaderProgram = 0;
+		programJob = -1;
+		useVertexColorHandle = useTextureHandle = { -1 };
+	}
+
+	void renderTriangles()
+	{
+		stream_buffer::beginFrame(streamBuffer);
+
+		// the offset is aligned to the vertex size, so it can be turned into the first vertex of the draw
+		size_t offset;
+		Vertex* vertices = (Vertex*)stream_buffer::allocate(streamBuffer, triangleCount * 3 * sizeof(Vertex), sizeof(Vertex), offset);
+		if (vertices == NULL)
+		{
+			stream_buffer::endFrame(streamBuffer);
+			return;
+		}
+
+		// the triangles spin around the center on a spiral, each one also rotates around itself
+		const float size = 0.01f;
+		for (int i = 0; i < triangleCount; i++)
+		{
+			float t = (float)i / triangleCount;
+			float angle = t * 60.0f + elapsedTime * (0.2f + t);
+			float radius = 0.05f + 0.9f * t;
+			float cx = std::cos(angle) * radius;
+			float cy = std::sin(angle) * radius;
+			float spin = elapsedTime * 3.0f + i;
+
+			// written in order, the memory might be write-combined and reading it back would be very slow
+			for (int corner = 0; corner < 3; corner++)
+			{
+				float cornerAngle = spin + corner * 2.0943951f;
+				Vertex& vertex = vertices[i * 3 + corner];
+				vertex.x = cx + std::cos(cornerAngle) * size;
+				vertex.y = cy + std::sin(cornerAngle) * size;
+				vertex.z = 0.0f;
+				vertex.r = t;
+				vertex.g = 1.0f - t;
+				vertex.b = corner * 0.5f;
+			}
+		}
+		stream_buffer::flush(streamBuffer);
+
+		shader_compiler::useProgram(shaderProgram);
+		// the handles are only valid for the uber-shader, otherwise these do nothing
+		uniform_table::setInt(uniformTable, useVertexColorHandle, 1);
+		uniform_table::setInt(uniformTable, useTextureHandle, 0);
+
+		glBindVertexArray(VAO);
+		glDrawArrays(GL_TRIANGLES, (GLint)(offset / sizeof(Vertex)), triangleCount * 3);
+		glBindVertexArray(0);
+
+		// the region can be written again once the GPU passed this point
+		stream_buffer::endFrame(streamBuffer);
+	}
+
+	int initVAOs() {
+		if (stream_buffer::create(streamBuffer, triangleCount * 3 * sizeof(Vertex)) != 0) return -1;
+
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+		// the attributes always point at the start of the buffer, the frame's region is selected by the
+		// first vertex of the draw call, so the VAO never has to change
+		glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.id);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+
+		return 0;
+	}
+
+	int initShaders() {
+		std::vector<std::string> defines = { shader_preprocessor::uberShaders() ? "UBER_SHADER" : "USE_VERTEX_COLOR" };
+		const std::string* vertexShaderSrc = shader_preprocessor::variant("basic.vert", defines);
+		const std::string* fragmentShaderSrc = shader_preprocessor::variant("basic.frag", defines);
+		if (vertexShaderSrc == NULL || fragmentShaderSrc == NULL) return -1;
+
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc->c_str(), fragmentShaderSrc->c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		useVertexColorHandle = uniform_table::getInt(uniformTable, "useVertexColor");
+		useTextureHandle = uniform_table::getInt(uniformTable, "useTexture");
+	}
+
+}
@@ -0,0 +1,21 @@
+#ifndef STREAMING_H
+#define STREAMING_H
+
+// Thousands of small triangles whose vertices are computed on the CPU and streamed to the GPU every frame.
+namespace streaming {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // moves the triangles
+    void update(double time);
+    // writes the vertices of the frame into the stream buffer and draws them
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initVAOs();
+    void renderTriangles();
+}
+
+#endif
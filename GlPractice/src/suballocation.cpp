@@ -0,0 +1,161 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <glad/glad.h>
+#include "suballocation.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "shader_preprocessor.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
+#include "mesh_pool.h"
+
+namespace suballocation {
+
+	const int gridSize = 32;
+	const int minSides = 3;
+	const int maxSides = 48;
+	// polygons replaced per frame
+	const int replacesPerFrame = 32;
+	// defragment once this much of the free space is in holes too small for the biggest polygon
+	const double defragmentThreshold = 0.75;
+
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 3>,
+		vertex_layout::Attr<1, vertex_layout::ubyte, 3, vertex_layout::normalized>> VertexLayout;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	mesh_pool::Pool pool;
+	// the polygon in every cell of the grid
+	std::vector<mesh_pool::Handle> cells;
+	// the polygons change the same way on every run
+	unsigned int randomState;
+	// uber mode only: the switches of the uber-shader
+	uniform_table::Table uniformTable;
+	uniform_table::IntHandle useVertexColorHandle = { -1 };
+	uniform_table::IntHandle useTextureHandle = { -1 };
+
+	void registerScene()
+	{
+		scene::registerScene({ "suballocation", init, update, render, shutdown });
+	}
+
+	unsigned int nextRandom()
+	{
+		randomState = randomState * 1664525u + 1013904223u;
+		return randomState >> 8;
+	}
+
+	// adds a polygon with a random number of sides in the cell to the pool
+	mesh_pool::Handle addPolygon(int cell)
+	{
+		int sides = minSides + (int)(nextRandom() % (maxSides - minSides + 1));
+		const float cellSize = 2.0f / gridSize;
+		float centerX = -1.0f + (cell % gridSize + 0.5f) * cellSize;
+		float centerY = -1.0f + (cell / gridSize + 0.5f) * cellSize;
+		float radius = cellSize * 0.45f;
+		float color[3] = { (nextRandom() % 256) / 255.0f, (nextRandom() % 256) / 255.0f, (nextRandom() % 256) / 255.0f };
+
+		// a fan around the center vertex
+		std::vector<float> positions = { centerX, centerY, 0.0f };
+		std::vector<float> colors(color, color + 3);
+		std::vector<unsigned short> indices;
+		for (int i = 0; i < sides; i++)
+		{
+			float angle = 6.2831853f * i / sides;
+			positions.insert(positions.end(), { centerX + radius * std::cos(angle), centerY + radius * std::sin(angle), 0.0f });
+			colors.insert(colors.end(), color, color + 3);
+			indices.insert(indices.end(), { 0, (unsigned short)(1 + i), (unsigned short)(1 + (i + 1) % sides) });
+		}
+
+		size_t vertexCount = sides + 1;
+		std::vector<unsigned char> vertices(VertexLayout::bufferSize(vertexCount));
+		VertexLayout::fill<0>(vertices.data(), vertexCount, positions.data());
+		VertexLayout::fill<1>(vertices.data(), vertexCount, colors.data());
+		return mesh_pool::add(pool, vertices.data(), vertexCount, indices.data(), indices.size());
+	}
+
+	int init()
+	{
+		if (initShaders() != 0) return -1;
+		return initMeshes();
+	}
+
+	int initMeshes()
+	{
+		// room for every cell to have the biggest polygon, plus a quarter, the holes need somewhere to be
+		size_t cellCount = gridSize * gridSize;
+		size_t vertexCapacity = cellCount * (maxSides + 1) * 5 / 4;
+		size_t indexCapacity = cellCount * maxSides * 3 * 5 / 4;
+		if (mesh_pool::create<VertexLayout>(pool, GL_UNSIGNED_SHORT, vertexCapacity, indexCapacity) != 0) return -1;
+
+		randomState = 12345;
+		cells.assign(cellCount, -1);
+		for (size_t cell = 0; cell < cellCount; cell++)
+		{
+			cells[cell] = addPolygon((int)cell);
+			if (cells[cell] < 0) return -1;
+		}
+		return 0;
+	}
+
+	void update(double)
+	{
+		for (int i = 0; i < replacesPerFrame; i++)
+		{
+			int cell = (int)(nextRandom() % cells.size());
+			mesh_pool::remove(pool, cells[cell]);
+			cells[cell] = addPolygon(cell);
+		}
+		if (mesh_pool::fragmentation(pool) > defragmentThreshold) mesh_pool::defragment(pool);
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		// the handles are only valid for the uber-shader, otherwise these do nothing
+		uniform_table::setInt(uniformTable, useVertexColorHandle, 1);
+		uniform_table::setInt(uniformTable, useTextureHandle, 0);
+
+		mesh_pool::bind(pool);
+		mesh_pool::drawAll(pool);
+		glBindVertexArray(0);
+	}
+
+	void shutdown()
+	{
+		mesh_pool::destroy(pool);
+		cells.clear();
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		shaderProgram = 0;
+		programJob = -1;
+		useVertexColorHandle = useTextureHandle = { -1 };
+	}
+
+	int initShaders()
+	{
+		std::vector<std::string> defines = { shader_preprocessor::uberShaders() ? "UBER_SHADER" : "USE_VERTEX_COLOR" };
+		const std::string* vertexShaderSrc = shader_preprocessor::variant("basic.vert", defines);
+		const std::string* fragmentShaderSrc = shader_preprocessor::variant("basic.frag", defines);
+		if (vertexShaderSrc == NULL || fragmentShaderSrc == NULL) return -1;
+
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc->c_str(), fragmentShaderSrc->c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		useVertexColorHandle = uniform_table::getInt(uniformTable, "useVertexColor");
+		useTextureHandle = uniform_table::getInt(uniformTable, "useTexture");
+	}
+
+}
@@ -0,0 +1,22 @@
+#ifndef SUBALLOCATION_H
+#define SUBALLOCATION_H
+
+// A grid of polygons that all live in one mesh pool: one vertex buffer, one index buffer, one VAO.
+// Every frame some of them are removed and replaced by polygons with a different number of sides, so
+// the pool keeps getting holes of odd sizes, it is defragmented if the free space gets too scattered.
+// All of them are drawn with one glMultiDrawElementsBaseVertex.
+namespace suballocation {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // replaces some of the polygons
+    void update(double time);
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    int initMeshes();
+}
+
+#endif
@@ -2,9 +2,15 @@
 #define TEXTURE_H
 
 namespace texture {
-    int main();
-    int initContext();
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // clears the screen and draws the textured quad
+    void render();
+    void shutdown();
     int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
     void initTextures();
     void initVAOs();
     void renderTriangles();
@@ -0,0 +1,902 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <cstdint>
+#include <glad/glad.h>
+#include "texture_compressor.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_COMPRESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace texture_compressor {
+
+	// the texels of one block as floats, channels the format does not use are ignored
+	typedef float Block[16][4];
+
+	// the colors an index can pick, stored by channel so four entries are compared at once
+	struct Palette {
+		int count;
+		alignas(16) float values[4][16];
+	};
+
+	int qualities[FORMAT_COUNT] = { 0, 1, 1, 1, 1, 1 };
+	Stats stats = {};
+	// compress() runs on the texture loader's threads too
+	std::mutex statsMutex;
+
+	void setQuality(Format format, int quality)
+	{
+		if (quality < 0) quality = 0;
+		if (quality > MAX_QUALITY) quality = MAX_QUALITY;
+		qualities[format] = quality;
+	}
+
+	int getQuality(Format format)
+	{
+		return qualities[format];
+	}
+
+	const char* name(Format format)
+	{
+		static const char* const names[] = { "none", "bc1", "bc3", "bc4", "bc5", "bc7" };
+		return names[format];
+	}
+
+	size_t blockSize(Format format)
+	{
+		static const size_t sizes[] = { 0, 8, 16, 8, 16, 16 };
+		return sizes[format];
+	}
+
+	unsigned int glFormat(Format format)
+	{
+		// BC1 without the punch-through alpha, the encoder never writes it
+		static const unsigned int formats[] = { 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+			GL_COMPRESSED_RED_RGTC1, GL_COMPRESSED_RG_RGTC2, GL_COMPRESSED_RGBA_BPTC_UNORM };
+		return formats[format];
+	}
+
+	bool supported(Format format)
+	{
+		switch (format)
+		{
+		case FORMAT_BC1:
+		case FORMAT_BC3:
+			return GLAD_GL_EXT_texture_compression_s3tc != 0;
+		case FORMAT_BC4:
+		case FORMAT_BC5:
+			return GLAD_GL_VERSION_3_0 != 0;
+		case FORMAT_BC7:
+			return GLAD_GL_VERSION_4_2 != 0;
+		default:
+			return false;
+		}
+	}
+
+	// channels of the source the format keeps, for the PSNR
+	int storedChannels(Format format)
+	{
+		static const int channels[] = { 0, 3, 4, 1, 2, 4 };
+		return channels[format];
+	}
+
+	int clampByte(float value)
+	{
+		int rounded = (int)std::lround(value);
+		return rounded < 0 ? 0 : (rounded > 255 ? 255 : rounded);
+	}
+
+	// index of the palette entry closest to the pixel, over the first channels, error gets the squared distance
+	int closest(const Palette& palette, const float* pixel, int channels, float& error)
+	{
+#ifdef TEXTURE_COMPRESSOR_SSE2
+		__m128 best = _mm_set1_ps(FLT_MAX);
+		__m128i bestIndex = _mm_setzero_si128();
+		__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+		for (int i = 0; i < palette.count; i += 4)
+		{
+			__m128 distance = _mm_setzero_ps();
+			for (int c = 0; c < channels; c++)
+			{
+				__m128 difference = _mm_sub_ps(_mm_load_ps(&palette.values[c][i]), _mm_set1_ps(pixel[c]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+			}
+			__m128i better = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+			best = _mm_min_ps(distance, best);
+			bestIndex = _mm_or_si128(_mm_and_si128(better, index), _mm_andnot_si128(better, bestIndex));
+			index = _mm_add_epi32(index, _mm_set1_epi32(4));
+		}
+		alignas(16) float distances[4];
+		alignas(16) int indices[4];
+		_mm_store_ps(distances, best);
+		_mm_store_si128((__m128i*)indices, bestIndex);
+		int lane = 0;
+		for (int i = 1; i < 4; i++)
+		{
+			if (distances[i] < distances[lane] || (distances[i] == distances[lane] && indices[i] < indices[lane])) lane = i;
+		}
+		error = distances[lane];
+		return indices[lane];
+#else
+		int bestIndex = 0;
+		error = FLT_MAX;
+		for (int i = 0; i < palette.count; i++)
+		{
+			float distance = 0.0f;
+			for (int c = 0; c < channels; c++)
+			{
+				float difference = palette.values[c][i] - pixel[c];
+				distance += difference * difference;
+			}
+			if (distance < error)
+			{
+				error = distance;
+				bestIndex = i;
+			}
+		}
+		return bestIndex;
+#endif
+	}
+
+	// picks the closest entry for every texel, returns the summed squared error
+	float assignIndices(const Palette& palette, const Block& block, int channels, int* indices)
+	{
+		float total = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			float error;
+			indices[i] = closest(palette, block[i], channels, error);
+			total += error;
+		}
+		return total;
+	}
+
+	// The line through the colors of the block: their mean and the direction they spread the most in
+	// (power iteration on the covariance matrix). The endpoints go where the texels project to its ends.
+	void principalEndpoints(const Block& block, int channels, float* endpoint0, float* endpoint1)
+	{
+		float mean[4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < channels; c++) mean[c] += block[i][c] / 16.0f;
+		}
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++) covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+			}
+		}
+		// Start from the covariance row of the channel that varies most. A fixed start like (1,1,1) is orthogonal
+		// to the axis of a red/green or cyan/magenta block, the iteration would end at once and both endpoints
+		// at the mean.
+		int widest = 0;
+		for (int c = 1; c < channels; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest]) widest = c;
+		}
+		// every texel has the same color
+		if (covariance[widest][widest] <= 0.0f)
+		{
+			for (int c = 0; c < channels; c++) endpoint0[c] = endpoint1[c] = mean[c];
+			return;
+		}
+		float axis[4] = {};
+		for (int a = 0; a < channels; a++) axis[a] = covariance[widest][a];
+		bool converged = true;
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+				length += next[a] * next[a];
+			}
+			if (length < 1e-12f)
+			{
+				converged = false;
+				break;
+			}
+			length = std::sqrt(length);
+			for (int a = 0; a < channels; a++) axis[a] = next[a] / length;
+		}
+		// The iterate vanished (rounding), take the diagonal of the bounding box, the channels that fall while
+		// the widest one rises going the other way.
+		if (!converged)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				float lowest = FLT_MAX, highest = -FLT_MAX;
+				for (int i = 0; i < 16; i++)
+				{
+					lowest = std::min(lowest, block[i][c]);
+					highest = std::max(highest, block[i][c]);
+				}
+				axis[c] = covariance[widest][c] < 0.0f ? lowest - highest : highest - lowest;
+			}
+		}
+
+		float lowest = FLT_MAX, highest = -FLT_MAX;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++) t += (block[i][c] - mean[c]) * axis[c];
+			if (t < lowest) lowest = t;
+			if (t > highest) highest = t;
+		}
+		for (int c = 0; c < channels; c++)
+		{
+			endpoint0[c] = mean[c] + axis[c] * lowest;
+			endpoint1[c] = mean[c] + axis[c] * highest;
+		}
+	}
+
+	// The endpoints that fit the texels best for the indices they have now (least squares), weights has
+	// how far every index is from endpoint0 towards endpoint1. Leaves them alone if the system is singular.
+	void fitEndpoints(const Block& block, int channels, const int* indices, const float* weights, float* endpoint0, float* endpoint1)
+	{
+		float a = 0.0f, b = 0.0f, c = 0.0f;
+		float x0[4] = {}, x1[4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float w = weights[indices[i]];
+			a += (1.0f - w) * (1.0f - w);
+			b += (1.0f - w) * w;
+			c += w * w;
+			for (int k = 0; k < channels; k++)
+			{
+				x0[k] += (1.0f - w) * block[i][k];
+				x1[k] += w * block[i][k];
+			}
+		}
+		float determinant = a * c - b * b;
+		if (std::fabs(determinant) < 1e-6f) return;
+		for (int k = 0; k < channels; k++)
+		{
+			float e0 = (c * x0[k] - b * x1[k]) / determinant;
+			float e1 = (a * x1[k] - b * x0[k]) / determinant;
+			endpoint0[k] = e0 < 0.0f ? 0.0f : (e0 > 255.0f ? 255.0f : e0);
+			endpoint1[k] = e1 < 0.0f ? 0.0f : (e1 > 255.0f ? 255.0f : e1);
+		}
+	}
+
+	// rounds of least squares fitting per quality
+	int refinements(int quality)
+	{
+		static const int rounds[] = { 0, 2, 8 };
+		return rounds[quality];
+	}
+
+	// BC1
+
+	const float bc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	unsigned int to565(const float* color)
+	{
+		unsigned int r = (unsigned int)clampByte(color[0] * 31.0f / 255.0f);
+		unsigned int g = (unsigned int)clampByte(color[1] * 63.0f / 255.0f);
+		unsigned int b = (unsigned int)clampByte(color[2] * 31.0f / 255.0f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	void from565(unsigned int color, int* rgb)
+	{
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	void bc1Palette(unsigned int color0, unsigned int color1, Palette& palette)
+	{
+		int c0[3], c1[3];
+		from565(color0, c0);
+		from565(color1, c1);
+		palette.count = 4;
+		for (int c = 0; c < 3; c++)
+		{
+			palette.values[c][0] = (float)c0[c];
+			palette.values[c][1] = (float)c1[c];
+			palette.values[c][2] = (float)((2 * c0[c] + c1[c]) / 3);
+			palette.values[c][3] = (float)((c0[c] + 2 * c1[c]) / 3);
+		}
+	}
+
+	void encodeBC1(const Block& block, int quality, unsigned char* out)
+	{
+		float endpoint0[4], endpoint1[4];
+		principalEndpoints(block, 3, endpoint0, endpoint1);
+
+		float bestError = FLT_MAX;
+		unsigned int bestColors[2] = { 0, 0 };
+		int bestIndices[16] = {};
+		for (int round = 0; round <= refinements(quality); round++)
+		{
+			unsigned int color0 = to565(endpoint0), color1 = to565(endpoint1);
+			Palette palette;
+			bc1Palette(color0, color1, palette);
+			int indices[16];
+			float error = assignIndices(palette, block, 3, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestColors[0] = color0;
+				bestColors[1] = color1;
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+			if (error == 0.0f) break;
+			fitEndpoints(block, 3, indices, bc1Weights, endpoint0, endpoint1);
+		}
+
+		// color0 > color1 is the mode with four colors, swapping the endpoints swaps the indices too
+		static const int swapped[4] = { 1, 0, 3, 2 };
+		if (bestColors[0] < bestColors[1])
+		{
+			std::swap(bestColors[0], bestColors[1]);
+			for (int& index : bestIndices) index = swapped[index];
+		}
+		// the same color twice is the three color mode, where index 3 is black
+		else if (bestColors[0] == bestColors[1])
+		{
+			for (int& index : bestIndices) index = 0;
+		}
+		uint32_t bits = 0;
+		for (int i = 0; i < 16; i++) bits |= (uint32_t)bestIndices[i] << (2 * i);
+		out[0] = (unsigned char)bestColors[0];
+		out[1] = (unsigned char)(bestColors[0] >> 8);
+		out[2] = (unsigned char)bestColors[1];
+		out[3] = (unsigned char)(bestColors[1] >> 8);
+		std::memcpy(out + 4, &bits, 4);
+	}
+
+	// fourColors: the color block of BC3 is always read with four colors
+	void decodeBC1(const unsigned char* in, unsigned char* rgba, int stride, bool fourColors)
+	{
+		unsigned int color0 = in[0] | (in[1] << 8), color1 = in[2] | (in[3] << 8);
+		uint32_t bits;
+		std::memcpy(&bits, in + 4, 4);
+		Palette palette;
+		bc1Palette(color0, color1, palette);
+		if (!fourColors && color0 <= color1)
+		{
+			int c0[3], c1[3];
+			from565(color0, c0);
+			from565(color1, c1);
+			for (int c = 0; c < 3; c++)
+			{
+				palette.values[c][2] = (float)((c0[c] + c1[c]) / 2);
+				palette.values[c][3] = 0.0f;
+			}
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (bits >> (2 * i)) & 3;
+			unsigned char* texel = rgba + (i / 4) * stride + (i % 4) * 4;
+			for (int c = 0; c < 3; c++) texel[c] = (unsigned char)palette.values[c][index];
+		}
+	}
+
+	// BC4, one channel (also the alpha of BC3 and both halves of BC5)
+
+	const float bc4Weights[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+	// value0 > value1 interpolates 6 values between them, otherwise 4 and the last two are 0 and 255
+	void bc4Palette(int value0, int value1, Palette& palette)
+	{
+		palette.count = 8;
+		float* values = palette.values[0];
+		values[0] = (float)value0;
+		values[1] = (float)value1;
+		if (value0 > value1)
+		{
+			for (int k = 2; k < 8; k++) values[k] = (float)(((8 - k) * value0 + (k - 1) * value1) / 7);
+		}
+		else
+		{
+			for (int k = 2; k < 6; k++) values[k] = (float)(((6 - k) * value0 + (k - 1) * value1) / 5);
+			values[6] = 0.0f;
+			values[7] = 255.0f;
+		}
+	}
+
+	float encodeBC4Mode(const Block& block, int channel, int value0, int value1, int* indices)
+	{
+		Palette palette;
+		bc4Palette(value0, value1, palette);
+		float total = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			float error;
+			indices[i] = closest(palette, &block[i][channel], 1, error);
+			total += error;
+		}
+		return total;
+	}
+
+	void encodeBC4(const Block& block, int channel, int quality, unsigned char* out)
+	{
+		float lowest = 255.0f, highest = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			lowest = std::fmin(lowest, block[i][channel]);
+			highest = std::fmax(highest, block[i][channel]);
+		}
+
+		int bestValues[2] = { clampByte(highest), clampByte(lowest) };
+		int bestIndices[16];
+		float bestError = encodeBC4Mode(block, channel, bestValues[0], bestValues[1], bestIndices);
+
+		// least squares on the channel alone, the endpoints live in the first "channel" of a block of its own
+		Block values;
+		for (int i = 0; i < 16; i++) values[i][0] = block[i][channel];
+		float endpoint0 = highest, endpoint1 = lowest;
+		int indices[16];
+		std::memcpy(indices, bestIndices, sizeof(indices));
+		for (int round = 0; round < refinements(quality) && bestError > 0.0f; round++)
+		{
+			fitEndpoints(values, 1, indices, bc4Weights, &endpoint0, &endpoint1);
+			int value0 = clampByte(endpoint0), value1 = clampByte(endpoint1);
+			if (value0 < value1) std::swap(value0, value1);
+			// equal would be the other mode
+			if (value0 == value1)
+			{
+				if (value0 < 255) value0++;
+				else value1--;
+			}
+			float error = encodeBC4Mode(block, channel, value0, value1, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestValues[0] = value0;
+				bestValues[1] = value1;
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+			// the weights of the indices are for value0 > value1, refit from what the values are now
+			endpoint0 = (float)value0;
+			endpoint1 = (float)value1;
+		}
+
+		// the mode with 0 and 255 of their own, for blocks with a few texels at the extremes
+		if (quality >= MAX_QUALITY && bestError > 0.0f)
+		{
+			float inner0 = 255.0f, inner1 = 0.0f;
+			for (int i = 0; i < 16; i++)
+			{
+				float value = block[i][channel];
+				if (value <= 0.0f || value >= 255.0f) continue;
+				inner0 = std::fmin(inner0, value);
+				inner1 = std::fmax(inner1, value);
+			}
+			if (inner0 <= inner1)
+			{
+				float error = encodeBC4Mode(block, channel, clampByte(inner0), clampByte(inner1), indices);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestValues[0] = clampByte(inner0);
+					bestValues[1] = clampByte(inner1);
+					std::memcpy(bestIndices, indices, sizeof(indices));
+				}
+			}
+		}
+
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; i++) bits |= (uint64_t)bestIndices[i] << (3 * i);
+		out[0] = (unsigned char)bestValues[0];
+		out[1] = (unsigned char)bestValues[1];
+		for (int i = 0; i < 6; i++) out[2 + i] = (unsigned char)(bits >> (8 * i));
+	}
+
+	void decodeBC4(const unsigned char* in, unsigned char* rgba, int stride, int channel)
+	{
+		Palette palette;
+		bc4Palette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++) bits |= (uint64_t)in[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (int)((bits >> (3 * i)) & 7);
+			rgba[(i / 4) * stride + (i % 4) * 4 + channel] = (unsigned char)palette.values[0][index];
+		}
+	}
+
+	// BC7 mode 6
+
+	const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	const float bc7FitWeights[16] = { 0 / 64.0f, 4 / 64.0f, 9 / 64.0f, 13 / 64.0f, 17 / 64.0f, 21 / 64.0f, 26 / 64.0f, 30 / 64.0f,
+		34 / 64.0f, 38 / 64.0f, 43 / 64.0f, 47 / 64.0f, 51 / 64.0f, 55 / 64.0f, 60 / 64.0f, 64 / 64.0f };
+
+	// appends bits to a 128 bit block, the lowest bit first
+	struct BitWriter {
+		unsigned char* out;
+		int position;
+
+		void write(unsigned int value, int count)
+		{
+			for (int i = 0; i < count; i++, position++)
+			{
+				if ((value >> i) & 1) out[position / 8] |= (unsigned char)(1 << (position % 8));
+			}
+		}
+	};
+
+	struct BitReader {
+		const unsigned char* in;
+		int position;
+
+		unsigned int read(int count)
+		{
+			unsigned int value = 0;
+			for (int i = 0; i < count; i++, position++) value |= ((in[position / 8] >> (position % 8)) & 1u) << i;
+			return value;
+		}
+	};
+
+	// the 7 bit value of every channel for the endpoint with its p-bit, the endpoint is (value << 1) | pbit
+	void quantizeBC7(const float* endpoint, int pbit, int* quantized)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int value = (int)std::lround((endpoint[c] - pbit) / 2.0f);
+			quantized[c] = value < 0 ? 0 : (value > 127 ? 127 : value);
+		}
+	}
+
+	// the p-bit that loses the least when the endpoint is quantized
+	int bestPbit(const float* endpoint)
+	{
+		float errors[2] = {};
+		for (int pbit = 0; pbit < 2; pbit++)
+		{
+			int quantized[4];
+			quantizeBC7(endpoint, pbit, quantized);
+			for (int c = 0; c < 4; c++)
+			{
+				float difference = endpoint[c] - (float)((quantized[c] << 1) | pbit);
+				errors[pbit] += difference * difference;
+			}
+		}
+		return errors[1] < errors[0] ? 1 : 0;
+	}
+
+	void bc7Palette(const int* quantized0, int pbit0, const int* quantized1, int pbit1, Palette& palette)
+	{
+		palette.count = 16;
+		for (int c = 0; c < 4; c++)
+		{
+			int value0 = (quantized0[c] << 1) | pbit0, value1 = (quantized1[c] << 1) | pbit1;
+			for (int i = 0; i < 16; i++)
+			{
+				palette.values[c][i] = (float)(((64 - bc7Weights[i]) * value0 + bc7Weights[i] * value1 + 32) >> 6);
+			}
+		}
+	}
+
+	void encodeBC7(const Block& block, int quality, unsigned char* out)
+	{
+		float endpoint0[4], endpoint1[4];
+		principalEndpoints(block, 4, endpoint0, endpoint1);
+
+		float bestError = FLT_MAX;
+		int best0[4] = {}, best1[4] = {}, bestPbits[2] = { 0, 0 };
+		int bestIndices[16] = {};
+		for (int round = 0; round <= refinements(quality); round++)
+		{
+			// the best quality tries every p-bit combination, the others the ones closest to the endpoints
+			int pbitCombinations[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+			int combinationCount = 4;
+			if (quality < MAX_QUALITY)
+			{
+				pbitCombinations[0][0] = bestPbit(endpoint0);
+				pbitCombinations[0][1] = bestPbit(endpoint1);
+				combinationCount = 1;
+			}
+			int roundIndices[16];
+			float roundError = FLT_MAX;
+			for (int combination = 0; combination < combinationCount; combination++)
+			{
+				int pbit0 = pbitCombinations[combination][0], pbit1 = pbitCombinations[combination][1];
+				int quantized0[4], quantized1[4];
+				quantizeBC7(endpoint0, pbit0, quantized0);
+				quantizeBC7(endpoint1, pbit1, quantized1);
+				Palette palette;
+				bc7Palette(quantized0, pbit0, quantized1, pbit1, palette);
+				int indices[16];
+				float error = assignIndices(palette, block, 4, indices);
+				if (error < roundError)
+				{
+					roundError = error;
+					std::memcpy(roundIndices, indices, sizeof(indices));
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					std::memcpy(best0, quantized0, sizeof(best0));
+					std::memcpy(best1, quantized1, sizeof(best1));
+					bestPbits[0] = pbit0;
+					bestPbits[1] = pbit1;
+					std::memcpy(bestIndices, indices, sizeof(indices));
+				}
+			}
+			if (bestError == 0.0f) break;
+			fitEndpoints(block, 4, roundIndices, bc7FitWeights, endpoint0, endpoint1);
+		}
+
+		// the index of the first texel has no top bit, it has to be in the half towards endpoint 0
+		if (bestIndices[0] >= 8)
+		{
+			for (int c = 0; c < 4; c++) std::swap(best0[c], best1[c]);
+			std::swap(bestPbits[0], bestPbits[1]);
+			for (int& index : bestIndices) index = 15 - index;
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter writer = { out, 0 };
+		// mode 6 is six zero bits and a one
+		writer.write(1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.write(best0[c], 7);
+			writer.write(best1[c], 7);
+		}
+		writer.write(bestPbits[0], 1);
+		writer.write(bestPbits[1], 1);
+		writer.write(bestIndices[0], 3);
+		for (int i = 1; i < 16; i++) writer.write(bestIndices[i], 4);
+	}
+
+	// only mode 6, what encodeBC7 writes, the texels of other modes come out black
+	void decodeBC7(const unsigned char* in, unsigned char* rgba, int stride)
+	{
+		BitReader reader = { in, 0 };
+		bool mode6 = reader.read(7) == (1 << 6);
+		int quantized[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			quantized[0][c] = (int)reader.read(7);
+			quantized[1][c] = (int)reader.read(7);
+		}
+		int pbit0 = (int)reader.read(1), pbit1 = (int)reader.read(1);
+		Palette palette;
+		bc7Palette(quantized[0], pbit0, quantized[1], pbit1, palette);
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (int)reader.read(i == 0 ? 3 : 4);
+			unsigned char* texel = rgba + (i / 4) * stride + (i % 4) * 4;
+			for (int c = 0; c < 4; c++) texel[c] = mode6 ? (unsigned char)palette.values[c][index] : 0;
+		}
+	}
+
+	// the whole image
+
+	// the texels of the block at bx, by, the edge texels repeat where the image does not fill it
+	void gatherBlock(const unsigned char* rgba, int width, int height, int bx, int by, Block& block)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int sy = by * 4 + y < height ? by * 4 + y : height - 1;
+			for (int x = 0; x < 4; x++)
+			{
+				int sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+				const unsigned char* texel = rgba + ((size_t)sy * width + sx) * 4;
+				for (int c = 0; c < 4; c++) block[y * 4 + x][c] = texel[c];
+			}
+		}
+	}
+
+	void encodeBlock(const Block& block, Format format, int quality, unsigned char* out)
+	{
+		switch (format)
+		{
+		case FORMAT_BC1:
+			encodeBC1(block, quality, out);
+			break;
+		case FORMAT_BC3:
+			encodeBC4(block, 3, quality, out);
+			encodeBC1(block, quality, out + 8);
+			break;
+		case FORMAT_BC4:
+			encodeBC4(block, 0, quality, out);
+			break;
+		case FORMAT_BC5:
+			encodeBC4(block, 0, quality, out);
+			encodeBC4(block, 1, quality, out + 8);
+			break;
+		case FORMAT_BC7:
+			encodeBC7(block, quality, out);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void compressLevel(const unsigned char* rgba, int width, int height, Format format, int quality, unsigned char* out, int threadCount)
+	{
+		int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		size_t size = blockSize(format);
+		// the threads take rows of blocks until there are none left
+		std::atomic<int> nextRow(0);
+		auto work = [&]()
+		{
+			Block block;
+			for (int by = nextRow++; by < blocksY; by = nextRow++)
+			{
+				for (int bx = 0; bx < blocksX; bx++)
+				{
+					gatherBlock(rgba, width, height, bx, by, block);
+					encodeBlock(block, format, quality, out + ((size_t)by * blocksX + bx) * size);
+				}
+			}
+		};
+
+		if (threadCount > blocksY) threadCount = blocksY;
+		std::vector<std::thread> threads;
+		for (int i = 1; i < threadCount; i++) threads.emplace_back(work);
+		work();
+		for (std::thread& thread : threads) thread.join();
+	}
+
+	// the next mip level, the average of 2x2 texels (the last row or column repeats for odd sizes)
+	void downsample(const unsigned char* rgba, int width, int height, std::vector<unsigned char>& out)
+	{
+		int outWidth = width > 1 ? width / 2 : 1, outHeight = height > 1 ? height / 2 : 1;
+		out.resize((size_t)outWidth * outHeight * 4);
+		for (int y = 0; y < outHeight; y++)
+		{
+			int y0 = y * 2, y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+			for (int x = 0; x < outWidth; x++)
+			{
+				int x0 = x * 2, x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+				for (int c = 0; c < 4; c++)
+				{
+					int sum = rgba[((size_t)y0 * width + x0) * 4 + c] + rgba[((size_t)y0 * width + x1) * 4 + c]
+						+ rgba[((size_t)y1 * width + x0) * 4 + c] + rgba[((size_t)y1 * width + x1) * 4 + c];
+					out[((size_t)y * outWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	int compress(Image& image, const unsigned char* rgba, int width, int height, Format format, int threadCount)
+	{
+		image = {};
+		if (format <= FORMAT_NONE || format >= FORMAT_COUNT || width <= 0 || height <= 0)
+		{
+			std::cout << "ERROR::TEXTURE_COMPRESSOR::INVALID_IMAGE" << std::endl;
+			return -1;
+		}
+		auto start = std::chrono::steady_clock::now();
+		if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+		int quality = qualities[format];
+
+		image.format = format;
+		image.width = width;
+		image.height = height;
+		size_t size = 0;
+		for (int w = width, h = height;; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1)
+		{
+			Level level = { w, h, size, (size_t)((w + 3) / 4) * ((h + 3) / 4) * blockSize(format) };
+			image.levels.push_back(level);
+			size += level.size;
+			if (w == 1 && h == 1) break;
+		}
+		image.data.resize(size);
+
+		std::vector<unsigned char> mip, nextMip;
+		const unsigned char* source = rgba;
+		unsigned long long blocks = 0;
+		for (size_t i = 0; i < image.levels.size(); i++)
+		{
+			const Level& level = image.levels[i];
+			if (i > 0)
+			{
+				downsample(source, image.levels[i - 1].width, image.levels[i - 1].height, nextMip);
+				mip.swap(nextMip);
+				source = mip.data();
+			}
+			compressLevel(source, level.width, level.height, format, quality, image.data.data() + level.offset, threadCount);
+			blocks += level.size / blockSize(format);
+		}
+		image.psnr = psnr(image, rgba);
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats.images++;
+		stats.blocks += blocks;
+		stats.compressMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return 0;
+	}
+
+	void decompress(const Image& image, int levelIndex, unsigned char* rgba)
+	{
+		const Level& level = image.levels[levelIndex];
+		int blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+		size_t size = blockSize(image.format);
+		int stride = 16;
+		for (int by = 0; by < blocksY; by++)
+		{
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				const unsigned char* in = image.data.data() + level.offset + ((size_t)by * blocksX + bx) * size;
+				unsigned char block[64];
+				for (int i = 0; i < 16; i++)
+				{
+					block[i * 4 + 0] = block[i * 4 + 1] = block[i * 4 + 2] = 0;
+					block[i * 4 + 3] = 255;
+				}
+				switch (image.format)
+				{
+				case FORMAT_BC1:
+					decodeBC1(in, block, stride, false);
+					break;
+				case FORMAT_BC3:
+					decodeBC4(in, block, stride, 3);
+					decodeBC1(in + 8, block, stride, true);
+					break;
+				case FORMAT_BC4:
+					decodeBC4(in, block, stride, 0);
+					break;
+				case FORMAT_BC5:
+					decodeBC4(in, block, stride, 0);
+					decodeBC4(in + 8, block, stride, 1);
+					break;
+				case FORMAT_BC7:
+					decodeBC7(in, block, stride);
+					break;
+				default:
+					break;
+				}
+				// the parts of edge blocks outside the image are not written
+				for (int y = 0; y < 4 && by * 4 + y < level.height; y++)
+				{
+					for (int x = 0; x < 4 && bx * 4 + x < level.width; x++)
+					{
+						std::memcpy(rgba + ((size_t)(by * 4 + y) * level.width + bx * 4 + x) * 4, block + y * stride + x * 4, 4);
+					}
+				}
+			}
+		}
+	}
+
+	double psnr(const Image& image, const unsigned char* rgba)
+	{
+		std::vector<unsigned char> decoded((size_t)image.width * image.height * 4);
+		decompress(image, 0, decoded.data());
+		int channels = storedChannels(image.format);
+		double squaredError = 0.0;
+		for (size_t i = 0; i < (size_t)image.width * image.height; i++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				double difference = (double)decoded[i * 4 + c] - rgba[i * 4 + c];
+				squaredError += difference * difference;
+			}
+		}
+		double meanSquaredError = squaredError / ((double)image.width * image.height * channels);
+		if (meanSquaredError <= 0.0) return 100.0;
+		return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stats = {};
+	}
+
+}
@@ -0,0 +1,87 @@
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include <cstddef>
+#include <vector>
+
+// Compresses RGBA8 images into the block formats GPUs sample directly (BCn). Every 4x4 block of texels
+// becomes 8 or 16 bytes: two endpoint colors and an index per texel into the colors between them, so a
+// texture takes 4 (BC1, BC4) or 8 (BC3, BC5, BC7) bits per texel instead of 32 on the GPU, and sampling it
+// reads that much less memory.
+//
+//   BC1  RGB, 565 endpoints and 2 bit indices                                      (S3TC, an extension)
+//   BC3  BC1 for RGB and a BC4 block for alpha                                     (S3TC, an extension)
+//   BC4  one channel, 8 bit endpoints and 3 bit indices                            (RGTC, core since 3.0)
+//   BC5  two BC4 blocks, for two channels like the xy of a normal map              (RGTC, core since 3.0)
+//   BC7  RGBA, 7 bit endpoints with a shared low bit and 4 bit indices (mode 6)     (BPTC, core since 4.2)
+//
+// The endpoints come from the principal axis of the block's colors, the quality setting of the format
+// says how many rounds of least squares fitting (and p-bit combinations for BC7) follow. BC7 has eight
+// modes with partitions, this encoder only writes mode 6, the one for blocks with a single gradient.
+// The blocks are spread over threads, the search for the closest palette entry does four entries at a time
+// with SSE2 where it is available.
+namespace texture_compressor {
+    enum Format {
+        // not compressed, the loader uploads the pixels as they are
+        FORMAT_NONE,
+        FORMAT_BC1,
+        FORMAT_BC3,
+        FORMAT_BC4,
+        FORMAT_BC5,
+        FORMAT_BC7,
+        FORMAT_COUNT
+    };
+
+    const int MAX_QUALITY = 2;
+    // part of the cache keys, bump it when the encoder writes different blocks for the same pixels
+    const int ENCODER_VERSION = 2;
+
+    // one mip level in Image::data
+    struct Level {
+        int width, height;
+        size_t offset;
+        size_t size;
+    };
+
+    // a compressed mip chain, the finest level first
+    struct Image {
+        Format format;
+        int width, height;
+        std::vector<Level> levels;
+        std::vector<unsigned char> data;
+        // of level 0 against the source, over the channels the format stores (0 if it was read from a file)
+        double psnr;
+    };
+
+    struct Stats {
+        unsigned long long images;
+        unsigned long long blocks;
+        double compressMs;
+    };
+
+    // 0 is the fastest, MAX_QUALITY the best, 1 by default
+    void setQuality(Format format, int quality);
+    int getQuality(Format format);
+
+    // "bc1" and so on
+    const char* name(Format format);
+    // bytes of one 4x4 block
+    size_t blockSize(Format format);
+    // the GL internal format for glCompressedTexImage2D
+    unsigned int glFormat(Format format);
+    // if the driver can sample the format, call it on the GL thread
+    bool supported(Format format);
+
+    // Compresses the image (width * height RGBA8 texels) and a box filtered mip chain down to 1x1.
+    // threadCount 0 uses one thread per core. Returns 0 on success.
+    int compress(Image& image, const unsigned char* rgba, int width, int height, Format format, int threadCount = 0);
+    // decodes a level back into RGBA8, what the format does not store is 0 (alpha 255)
+    void decompress(const Image& image, int level, unsigned char* rgba);
+    // peak signal to noise ratio of the decoded level 0 in dB, higher is better, 100 for no error at all
+    double psnr(const Image& image, const unsigned char* rgba);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
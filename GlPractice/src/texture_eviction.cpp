@@ -0,0 +1,218 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "texture_eviction.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
+#include "texture_loader.h"
+
+namespace texture_eviction {
+
+	const char* const directory = "texture_cache";
+	const int imageSize = 128;
+	const int pageColumns = 8;
+	const int pageRows = 4;
+	const int pageSize = pageColumns * pageRows;
+	const int pageCount = 8;
+	const double pagesPerSecond = 4.0;
+	// RGB takes four bytes a texel on most drivers, the mipmaps add about a third
+	const size_t textureBytes = (size_t)imageSize * imageSize * 4 * 4 / 3;
+	// a page and a half, so the page of the last frame always fits but most of the others have to go
+	const size_t budget = textureBytes * (pageSize + pageSize / 2);
+
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 2>,
+		vertex_layout::Attr<1, float, 2>> VertexLayout;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO;
+	std::vector<texture_loader::Handle> textures;
+	// what the loader was allowed before the scene started
+	size_t previousBudget = 0;
+	int page = 0;
+	uniform_table::Table uniformTable;
+	uniform_table::Vec2Handle offsetHandle = { -1 };
+	uniform_table::IntHandle samplerHandle = { -1 };
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// the corner of the cell
+uniform vec2 offset;
+
+out vec2 texCoord;
+
+void main()
+{
+    gl_Position = vec4(aPos + offset, 0.0, 1.0);
+    texCoord = aTexCoord;
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+
+uniform sampler2D textureSampler;
+
+in vec2 texCoord;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = texture(textureSampler, texCoord);
+}
+)";
+
+	void registerScene()
+	{
+		scene::registerScene({ "texture_eviction", init, update, render, shutdown });
+	}
+
+	int init()
+	{
+		if (writeImages() != 0) return -1;
+		if (initShaders() != 0) return -1;
+		previousBudget = texture_loader::getBudget();
+		texture_loader::setBudget(budget);
+		initTextures();
+		initVAOs();
+		return 0;
+	}
+
+	std::string imagePath(int index)
+	{
+		return std::string(directory) + "/eviction" + std::to_string(index) + ".ppm";
+	}
+
+	int writeImages()
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			std::cout << "ERROR::TEXTURE_EVICTION::CANT_CREATE_DIRECTORY " << directory << std::endl;
+			return -1;
+		}
+
+		std::vector<unsigned char> pixels((size_t)imageSize * imageSize * 3);
+		for (int i = 0; i < pageSize * pageCount; i++)
+		{
+			std::string path = imagePath(i);
+			if (std::filesystem::exists(path, error)) continue;
+
+			// stripes of a different width and direction per image, the blue channel alone already tells them apart
+			for (int y = 0; y < imageSize; y++)
+			{
+				for (int x = 0; x < imageSize; x++)
+				{
+					unsigned char* pixel = &pixels[((size_t)y * imageSize + x) * 3];
+					pixel[0] = (unsigned char)(x * (i % 16 + 1));
+					pixel[1] = (unsigned char)(y * (i / 16 + 1));
+					pixel[2] = (unsigned char)i;
+				}
+			}
+
+			// binary PPM, stb_image reads it like any other file
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file << "P6\n" << imageSize << " " << imageSize << "\n255\n";
+			file.write((const char*)pixels.data(), pixels.size());
+			if (!file)
+			{
+				std::cout << "ERROR::TEXTURE_EVICTION::CANT_WRITE_IMAGE " << path << std::endl;
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	void initTextures()
+	{
+		for (int i = 0; i < pageSize * pageCount; i++) textures.push_back(texture_loader::load(imagePath(i).c_str()));
+	}
+
+	void initVAOs()
+	{
+		// one cell at the bottom left corner, the offset moves it, with a small gap to the next one
+		const float width = 2.0f / pageColumns * 0.9f;
+		const float height = 2.0f / pageRows * 0.9f;
+		float positions[] = { -1.0f, -1.0f, -1.0f + width, -1.0f, -1.0f + width, -1.0f + height, -1.0f, -1.0f + height };
+		float texCoords[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+		unsigned char vertices[VertexLayout::bufferSize(4)];
+		VertexLayout::fill<0>(vertices, 4, positions);
+		VertexLayout::fill<1>(vertices, 4, texCoords);
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		VertexLayout::setup(VBO, 4);
+		glBindVertexArray(0);
+	}
+
+	void update(double time)
+	{
+		page = (int)(time * pagesPerSecond) % pageCount;
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		uniform_table::setInt(uniformTable, samplerHandle, 0);
+		glBindVertexArray(VAO);
+		for (int i = 0; i < pageSize; i++)
+		{
+			uniform_table::setVec2(uniformTable, offsetHandle, (i % pageColumns) * 2.0f / pageColumns, (i / pageColumns) * 2.0f / pageRows);
+			// an evicted texture shows the placeholder until it is loaded again
+			glBindTexture(GL_TEXTURE_2D, texture_loader::texture(textures[page * pageSize + i]));
+			glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindVertexArray(0);
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		for (texture_loader::Handle texture : textures) texture_loader::release(texture);
+		textures.clear();
+		texture_loader::setBudget(previousBudget);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = shaderProgram = 0;
+		programJob = -1;
+		page = 0;
+		offsetHandle = { -1 };
+		samplerHandle = { -1 };
+	}
+
+	int initShaders()
+	{
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		offsetHandle = uniform_table::getVec2(uniformTable, "offset");
+		samplerHandle = uniform_table::getInt(uniformTable, "textureSampler");
+	}
+
+}
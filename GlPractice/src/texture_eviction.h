@@ -0,0 +1,28 @@
+#ifndef TEXTURE_EVICTION_H
+#define TEXTURE_EVICTION_H
+
+#include <string>
+
+// The texture_loader budget under pressure. There are 256 textures with a different pattern each (the
+// files are generated into texture_cache on the first run, so the loader can not share them), but the
+// budget only holds about 48 of them. Every frame draws one page of 32 and the pages take turns, so
+// the pages that were drawn longest ago are evicted and loaded again when it is their turn.
+namespace texture_eviction {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    void update(double time);
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    // where the image with the index is generated
+    std::string imagePath(int index);
+    // writes the images that are not in texture_cache yet, returns 0 on success
+    int writeImages();
+    void initTextures();
+    void initVAOs();
+}
+
+#endif
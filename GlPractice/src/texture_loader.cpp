@@ -0,0 +1,698 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <glad/glad.h>
+#include "texture_loader.h"
+#include "texture_upload.h"
+#include "program_cache.h"
+#include "dds_file.h"
+
+// stb_image allocates through these, so a decode can put its pixels straight into staging memory (decode())
+namespace texture_loader {
+	void* decodeMalloc(size_t size);
+	void* decodeRealloc(void* pointer, size_t oldSize, size_t newSize);
+	void decodeFree(void* pointer);
+}
+#define STBI_MALLOC(size) texture_loader::decodeMalloc(size)
+#define STBI_REALLOC_SIZED(pointer, oldSize, newSize) texture_loader::decodeRealloc(pointer, oldSize, newSize)
+#define STBI_FREE(pointer) texture_loader::decodeFree(pointer)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace texture_loader {
+
+	// what a handle stands for, one per path and format
+	struct Texture {
+		TextureState state;
+		std::string path;
+		// of handlesByPath, the path with the name of the format for compressed textures
+		std::string key;
+		texture_compressor::Format format;
+		// loads of the path that were not released yet
+		int refs;
+		// index into images, -1 until the first decode came back
+		int image;
+	};
+
+	// one per file content, the handles of files with the same content share it
+	struct Image {
+		unsigned long long hash;
+		// 0 while evicted
+		unsigned int texture;
+		// what the texture takes on the GPU with its mipmaps, while it is there
+		size_t bytes;
+		// the frame it was last bound in
+		unsigned long long lastUsed;
+		// handles that show it, the image is deleted when the last one is released
+		int users;
+		// evicted and queued for loading again
+		bool reloading;
+	};
+
+	// what a worker is asked to load
+	struct Job {
+		Handle handle;
+		std::string path;
+		texture_compressor::Format format;
+	};
+
+	// what a worker hands back to the render thread
+	struct Decoded {
+		Handle handle;
+		unsigned long long hash;
+		// the pixels are either in memory of stb_image's or already in staging memory
+		unsigned char* pixels;
+		texture_upload::Staging staging;
+		// the blocks instead, for a compressed format
+		texture_compressor::Image compressed;
+		// the blocks came from the file next to the source, nothing had to be compressed
+		bool compressedFromCache;
+		int width, height, channels;
+		double decodeMs;
+		// decoded somewhere else and copied into the staging memory afterwards
+		bool copied;
+		// an image with this content is on the GPU already, it was not decoded
+		bool duplicate;
+	};
+
+	// only touched by the render thread
+	std::vector<Texture> textures;
+	std::vector<Image> images;
+	std::vector<int> freeImages;
+	std::unordered_map<std::string, Handle> handlesByPath;
+	std::unordered_map<unsigned long long, int> imagesByHash;
+	// loads and reloads the workers have not handed back yet
+	int pending = 0;
+	unsigned int placeholder = 0;
+	size_t budget = 256 << 20;
+	size_t resident = 0;
+	// counted up by update(), what lastUsed is measured in
+	unsigned long long frame = 0;
+	Stats stats = {};
+
+	// shared with the workers, guarded by mutex
+	std::mutex mutex;
+	std::condition_variable wakeWorkers;
+	// signalled when a worker finished an image, for waitAll
+	std::condition_variable decodedSignal;
+	std::deque<Job> queue;
+	std::deque<Decoded> decoded;
+	// the content of every image on the GPU, a worker does not decode a file that is there already
+	std::unordered_set<unsigned long long> residentHashes;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	// the staging memory the decode on this thread may put its image into
+	thread_local unsigned char* target = NULL;
+	thread_local size_t targetSize = 0;
+	thread_local size_t targetCapacity = 0;
+	thread_local bool targetTaken = false;
+
+	void* decodeMalloc(size_t size)
+	{
+		// The image a decoder returns is its only allocation of the size of the pixels (the JPEG decoder asks
+		// for one byte more). If something else happens to have that size too, the image ends up in memory
+		// of its own and decode() copies it over.
+		if (target != NULL && !targetTaken && size >= targetSize && size <= targetCapacity)
+		{
+			targetTaken = true;
+			return target;
+		}
+		return std::malloc(size);
+	}
+
+	void* decodeRealloc(void* pointer, size_t oldSize, size_t newSize)
+	{
+		// the staging memory can not grow, whatever was put there moves out
+		if (pointer != NULL && pointer == target)
+		{
+			void* moved = std::malloc(newSize);
+			if (moved == NULL) return NULL;
+			std::memcpy(moved, pointer, oldSize < newSize ? oldSize : newSize);
+			targetTaken = false;
+			return moved;
+		}
+		return std::realloc(pointer, newSize);
+	}
+
+	void decodeFree(void* pointer)
+	{
+		if (pointer != NULL && pointer == target)
+		{
+			targetTaken = false;
+			return;
+		}
+		std::free(pointer);
+	}
+
+	bool readFile(const std::string& path, std::vector<unsigned char>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) return false;
+		data.resize((size_t)file.tellg());
+		file.seekg(0);
+		return (bool)file.read((char*)data.data(), data.size());
+	}
+
+	// The blocks of the image in the format, from the file next to it if it was compressed before with the
+	// same settings, otherwise compressed now (on this thread, the other workers have images of their own)
+	// and written there for the next time.
+	void decodeCompressed(const std::string& path, const std::vector<unsigned char>& file, texture_compressor::Format format, Decoded& image)
+	{
+		int settings[] = { texture_compressor::getQuality(format), texture_compressor::ENCODER_VERSION };
+		unsigned long long key = program_cache::hash(settings, sizeof(settings), image.hash);
+		std::string cachePath = path + "." + texture_compressor::name(format) + ".dds";
+		if (dds_file::read(cachePath.c_str(), image.compressed, key) == 0 && image.compressed.format == format)
+		{
+			image.compressedFromCache = true;
+			return;
+		}
+
+		int width, height, channels;
+		unsigned char* rgba = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 4);
+		if (rgba == NULL) return;
+		if (texture_compressor::compress(image.compressed, rgba, width, height, format, 1) == 0)
+		{
+			dds_file::write(cachePath.c_str(), image.compressed, key);
+		}
+		stbi_image_free(rgba);
+	}
+
+	// Decodes the file into the arena of texture_upload if it has room, then the render thread uploads the
+	// pixels from where the decoder wrote them, without a copy and without a buffer of the image's size.
+	// Otherwise stb_image allocates the image and update() copies it into staging memory.
+	void decode(const Job& job, Decoded& image)
+	{
+		std::vector<unsigned char> file;
+		if (!readFile(job.path, file)) return;
+		image.hash = program_cache::hash(file.data(), file.size());
+		// the same file compressed is another texture
+		if (job.format != texture_compressor::FORMAT_NONE) image.hash = program_cache::hash(&job.format, sizeof(job.format), image.hash);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			image.duplicate = residentHashes.count(image.hash) != 0;
+		}
+		if (image.duplicate) return;
+		if (job.format != texture_compressor::FORMAT_NONE)
+		{
+			decodeCompressed(job.path, file, job.format, image);
+			return;
+		}
+
+		const unsigned char* data = file.data();
+		int length = (int)file.size();
+		int width, height, channels;
+		size_t size = 0;
+		if (stbi_info_from_memory(data, length, &width, &height, &channels)) size = (size_t)width * height * channels;
+		if (size > 0 && texture_upload::reserve(image.staging, size + 1) == 0)
+		{
+			target = (unsigned char*)image.staging.data;
+			targetSize = size;
+			targetCapacity = size + 1;
+			targetTaken = false;
+			// the byte for the JPEG decoder is not uploaded
+			image.staging.size = size;
+		}
+
+		image.pixels = stbi_load_from_memory(data, length, &image.width, &image.height, &image.channels, 0);
+		if (target == NULL) return;
+		target = NULL;
+		if (image.pixels == (unsigned char*)image.staging.data)
+		{
+			image.pixels = NULL;
+		}
+		else if (image.pixels != NULL && (size_t)image.width * image.height * image.channels == size)
+		{
+			std::memcpy(image.staging.data, image.pixels, size);
+			stbi_image_free(image.pixels);
+			image.pixels = NULL;
+			image.copied = true;
+		}
+		else
+		{
+			// failed, or not what stbi_info said it would be
+			texture_upload::cancel(image.staging);
+		}
+	}
+
+	bool failed(const Decoded& image)
+	{
+		return image.pixels == NULL && image.staging.data == NULL && image.compressed.data.empty() && !image.duplicate;
+	}
+
+	void worker()
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wakeWorkers.wait(lock, [] { return stopping || !queue.empty(); });
+				if (stopping) return;
+				job = queue.front();
+				queue.pop_front();
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			Decoded image = { job.handle, 0, NULL, { NULL, 0, -1, -1 }, {}, false, 0, 0, 0, 0.0, false, false };
+			decode(job, image);
+			if (failed(image)) std::cout << "ERROR::TEXTURE_LOADER::DECODE_FAILED " << job.path << std::endl;
+			image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			decoded.push_back(image);
+			decodedSignal.notify_all();
+		}
+	}
+
+	int init(int threadCount)
+	{
+		if (placeholder != 0) return 0;
+
+		// white, so a textured surface shows its vertex colors until the texture is there
+		const unsigned char white[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &placeholder);
+		glBindTexture(GL_TEXTURE_2D, placeholder);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (texture_upload::init() != 0) return -1;
+
+		if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+		stopping = false;
+		for (int i = 0; i < threadCount; i++) workers.emplace_back(worker);
+		return 0;
+	}
+
+	void shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			queue.clear();
+		}
+		wakeWorkers.notify_all();
+		for (std::thread& thread : workers) thread.join();
+		workers.clear();
+		for (Decoded& image : decoded)
+		{
+			stbi_image_free(image.pixels);
+			texture_upload::cancel(image.staging);
+		}
+		decoded.clear();
+		residentHashes.clear();
+
+		// whatever the scenes did not release goes too
+		for (Image& image : images) glDeleteTextures(1, &image.texture);
+		images.clear();
+		freeImages.clear();
+		imagesByHash.clear();
+		textures.clear();
+		handlesByPath.clear();
+		pending = 0;
+		resident = 0;
+		glDeleteTextures(1, &placeholder);
+		placeholder = 0;
+		texture_upload::shutdown();
+	}
+
+	void queueLoad(Handle handle)
+	{
+		pending++;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back({ handle, textures[handle].path, textures[handle].format });
+		}
+		wakeWorkers.notify_one();
+	}
+
+	Handle load(const char* path, texture_compressor::Format format)
+	{
+		// without the format the pixels are uploaded as they are
+		if (format != texture_compressor::FORMAT_NONE && !texture_compressor::supported(format)) format = texture_compressor::FORMAT_NONE;
+		std::string key = path;
+		if (format != texture_compressor::FORMAT_NONE) key = key + "#" + texture_compressor::name(format);
+		auto found = handlesByPath.find(key);
+		if (found != handlesByPath.end())
+		{
+			textures[found->second].refs++;
+			stats.cacheHits++;
+			return found->second;
+		}
+
+		Handle handle = (Handle)textures.size();
+		textures.push_back({ TEXTURE_PENDING, path, key, format, 1, -1 });
+		handlesByPath[key] = handle;
+		stats.loads++;
+		queueLoad(handle);
+		return handle;
+	}
+
+	// what GL stores for the image and its mipmaps, RGB8 takes four bytes a texel on most drivers
+	size_t gpuBytes(int width, int height, int channels)
+	{
+		size_t texelSize = channels == 3 ? 4 : channels;
+		size_t bytes = 0;
+		for (;;)
+		{
+			bytes += (size_t)width * height * texelSize;
+			if (width == 1 && height == 1) return bytes;
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+	}
+
+	void setResident(Image& image, bool isResident)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (isResident) residentHashes.insert(image.hash);
+		else residentHashes.erase(image.hash);
+	}
+
+	void evict(Image& image)
+	{
+		glDeleteTextures(1, &image.texture);
+		image.texture = 0;
+		resident -= image.bytes;
+		setResident(image, false);
+	}
+
+	// Evicts the images bound longest ago until the budget holds. What was bound in the last frame (or just
+	// uploaded) stays, the frame would only load it again, so the budget can be exceeded by what one frame draws.
+	void enforceBudget()
+	{
+		while (budget > 0 && resident > budget)
+		{
+			int oldest = -1;
+			for (int i = 0; i < (int)images.size(); i++)
+			{
+				const Image& image = images[i];
+				if (image.texture == 0 || image.lastUsed + 1 >= frame) continue;
+				if (oldest < 0 || image.lastUsed < images[oldest].lastUsed) oldest = i;
+			}
+			if (oldest < 0)
+			{
+				stats.overBudget++;
+				return;
+			}
+			evict(images[oldest]);
+			stats.evictions++;
+		}
+	}
+
+	void upload(Decoded& decodedImage, Image& image)
+	{
+		static const unsigned int formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+		static const unsigned int internalFormats[] = { 0, GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+
+		glGenTextures(1, &image.texture);
+		glBindTexture(GL_TEXTURE_2D, image.texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// Level 0 without pixels, glGenerateMipmap makes the others. The internal format is how GL stores
+		// the texels, the pixels come through a staging buffer (texture_upload).
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormats[decodedImage.channels], decodedImage.width, decodedImage.height, 0,
+			formats[decodedImage.channels], GL_UNSIGNED_BYTE, NULL);
+		// grey images are read as grey, not red
+		if (decodedImage.channels == 1)
+		{
+			const int swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		else if (decodedImage.channels == 2)
+		{
+			const int swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		size_t size = (size_t)decodedImage.width * decodedImage.height * decodedImage.channels;
+		if (decodedImage.staging.data != NULL)
+		{
+			texture_upload::end(decodedImage.staging, image.texture, 0, decodedImage.width, decodedImage.height,
+				formats[decodedImage.channels], GL_UNSIGNED_BYTE);
+			if (decodedImage.copied) stats.copiedDecodes++;
+			else stats.inPlaceDecodes++;
+		}
+		else
+		{
+			texture_upload::upload(image.texture, 0, decodedImage.width, decodedImage.height, formats[decodedImage.channels],
+				GL_UNSIGNED_BYTE, decodedImage.pixels, size);
+			stats.copiedDecodes++;
+		}
+		glBindTexture(GL_TEXTURE_2D, image.texture);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		image.bytes = gpuBytes(decodedImage.width, decodedImage.height, decodedImage.channels);
+		// counts as used, or the budget would throw it out before anyone saw it
+		image.lastUsed = frame;
+		image.reloading = false;
+		resident += image.bytes;
+		setResident(image, true);
+		stats.uploads++;
+		stats.uploadedBytes += size;
+	}
+
+	void uploadCompressed(Decoded& decodedImage, Image& image)
+	{
+		const texture_compressor::Image& compressed = decodedImage.compressed;
+		glGenTextures(1, &image.texture);
+		glBindTexture(GL_TEXTURE_2D, image.texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// the mip chain comes with the blocks (GL can not generate mipmaps of compressed textures), they are a
+		// fraction of the pixels, so they go straight from the worker's memory instead of through texture_upload
+		for (size_t level = 0; level < compressed.levels.size(); level++)
+		{
+			const texture_compressor::Level& mip = compressed.levels[level];
+			glCompressedTexImage2D(GL_TEXTURE_2D, (int)level, texture_compressor::glFormat(compressed.format), mip.width, mip.height, 0,
+				(int)mip.size, compressed.data.data() + mip.offset);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)compressed.levels.size() - 1);
+		// BC4 is a grey image, BC5 stays two channels, it is for normal maps
+		if (compressed.format == texture_compressor::FORMAT_BC4)
+		{
+			const int swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		image.bytes = compressed.data.size();
+		image.lastUsed = frame;
+		image.reloading = false;
+		resident += image.bytes;
+		setResident(image, true);
+		if (decodedImage.compressedFromCache) stats.compressedCacheHits++;
+		else stats.compressions++;
+		stats.uploads++;
+		stats.uploadedBytes += image.bytes;
+	}
+
+	int newImage(unsigned long long hash)
+	{
+		int index;
+		if (!freeImages.empty())
+		{
+			index = freeImages.back();
+			freeImages.pop_back();
+		}
+		else
+		{
+			index = (int)images.size();
+			images.push_back({});
+		}
+		images[index] = { hash, 0, 0, 0, 0, false };
+		imagesByHash[hash] = index;
+		return index;
+	}
+
+	// the handle does not show the image anymore, deletes it if it was the last one
+	void detach(Texture& texture)
+	{
+		if (texture.image < 0) return;
+		Image& image = images[texture.image];
+		if (--image.users == 0)
+		{
+			if (image.texture != 0) evict(image);
+			imagesByHash.erase(image.hash);
+			freeImages.push_back(texture.image);
+		}
+		// The reload was this handle's, and it found other content (or none). Whoever still uses the image
+		// has to load it again, or would wait for that reload forever.
+		else if (image.reloading) image.reloading = false;
+		texture.image = -1;
+	}
+
+	void attach(Texture& texture, int index)
+	{
+		if (texture.image == index) return;
+		// a reload can find the file changed, then the handle moves to the new content
+		detach(texture);
+		texture.image = index;
+		images[index].users++;
+	}
+
+	// hands one decoded image to GL, returns false if none is waiting
+	bool finishOne()
+	{
+		Decoded decodedImage;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (decoded.empty()) return false;
+			decodedImage = decoded.front();
+			decoded.pop_front();
+		}
+		pending--;
+		stats.decodeMs += decodedImage.decodeMs;
+
+		Texture& texture = textures[decodedImage.handle];
+		// released while it was decoded, nobody wants it anymore
+		if (texture.state != TEXTURE_RELEASED && failed(decodedImage))
+		{
+			detach(texture);
+			texture.state = TEXTURE_FAILED;
+			stats.failures++;
+		}
+		else if (texture.state != TEXTURE_RELEASED)
+		{
+			auto found = imagesByHash.find(decodedImage.hash);
+			if (found == imagesByHash.end() && decodedImage.duplicate)
+			{
+				// the image it was a duplicate of was deleted in the meantime, so it has to be decoded after all
+				queueLoad(decodedImage.handle);
+				return true;
+			}
+			int index = found != imagesByHash.end() ? found->second : newImage(decodedImage.hash);
+			if (texture.image < 0 && images[index].users > 0) stats.dedupes++;
+			attach(texture, index);
+			Image& image = images[index];
+			if (image.texture == 0 && !decodedImage.compressed.data.empty()) uploadCompressed(decodedImage, image);
+			else if (image.texture == 0 && !decodedImage.duplicate) upload(decodedImage, image);
+			else if (image.texture == 0 && !image.reloading)
+			{
+				// evicted while the worker looked at the file
+				image.reloading = true;
+				queueLoad(decodedImage.handle);
+			}
+			texture.state = TEXTURE_READY;
+		}
+
+		stbi_image_free(decodedImage.pixels);
+		if (decodedImage.staging.data != NULL) texture_upload::cancel(decodedImage.staging);
+		return true;
+	}
+
+	int update(double budgetMs)
+	{
+		frame++;
+		auto start = std::chrono::steady_clock::now();
+		double elapsed = 0.0;
+		// the arena ranges of earlier uploads, so the workers have room to decode into
+		texture_upload::retire();
+		while (finishOne())
+		{
+			elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (elapsed >= budgetMs)
+			{
+				stats.budgetHits++;
+				break;
+			}
+		}
+		stats.uploadMs += elapsed;
+		enforceBudget();
+		return pending;
+	}
+
+	void waitAll()
+	{
+		while (pending > 0)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				decodedSignal.wait(lock, [] { return !decoded.empty(); });
+			}
+			while (finishOne()) {}
+		}
+	}
+
+	void release(Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)textures.size()) return;
+		Texture& texture = textures[handle];
+		if (texture.state == TEXTURE_RELEASED || --texture.refs > 0) return;
+		// a decode that is still running comes back, finishOne throws it away
+		detach(texture);
+		auto found = handlesByPath.find(texture.key);
+		if (found != handlesByPath.end() && found->second == handle) handlesByPath.erase(found);
+		texture.state = TEXTURE_RELEASED;
+	}
+
+	TextureState state(Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)textures.size()) return TEXTURE_RELEASED;
+		const Texture& texture = textures[handle];
+		if (texture.state == TEXTURE_READY && images[texture.image].texture == 0) return TEXTURE_EVICTED;
+		return texture.state;
+	}
+
+	unsigned int texture(Handle handle)
+	{
+		if (handle < 0 || handle >= (Handle)textures.size() || textures[handle].state != TEXTURE_READY) return placeholder;
+		Image& image = images[textures[handle].image];
+		image.lastUsed = frame;
+		if (image.texture == 0 && !image.reloading)
+		{
+			image.reloading = true;
+			stats.reloads++;
+			queueLoad(handle);
+		}
+		return image.texture != 0 ? image.texture : placeholder;
+	}
+
+	int pendingCount()
+	{
+		return pending;
+	}
+
+	void setBudget(size_t bytes)
+	{
+		// the next update() evicts what is too much
+		budget = bytes;
+	}
+
+	size_t getBudget()
+	{
+		return budget;
+	}
+
+	size_t residentBytes()
+	{
+		return resident;
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
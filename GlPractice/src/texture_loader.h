@@ -0,0 +1,106 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <cstddef>
+#include "texture_compressor.h"
+
+// Loads textures without making the render thread wait for the image decoder.
+// load() only queues the file for the worker threads and returns a handle right away, until the texture is
+// there the handle shows a 1x1 white placeholder. The workers decode the images (stb_image), update() hands
+// the finished ones to GL on the render thread, no more of them per frame than fit in a time budget, so a
+// scene with hundreds of textures draws its first frame at once and the textures stream in over the next ones.
+// When texture_upload has room in its persistently mapped arena the workers decode into it, so the pixels
+// are never copied on the render thread.
+//
+// It is also the cache of the textures. Loading a path that is loaded already gives its handle again, with
+// one more reference, and files with the same content (the hash of the file) share one texture. Every
+// texture counts what it takes on the GPU with its mipmaps, when all of them take more than the budget the
+// ones bound longest ago are evicted and texture() loads them again the next time they are bound.
+//
+// A texture can be loaded block compressed instead (texture_compressor), it takes 4 to 8 times less memory
+// on the GPU. The worker compresses the image with its mip chain the first time and keeps the blocks in a
+// DDS file next to the source (dds_file), later runs read that file and skip the encoder.
+//
+//     texture_loader::Handle wall = texture_loader::load("assets/wall.jpg");
+//     ...
+//     glBindTexture(GL_TEXTURE_2D, texture_loader::texture(wall));
+namespace texture_loader {
+    enum TextureState {
+        // waiting for a worker, or decoded and waiting for update()
+        TEXTURE_PENDING,
+        TEXTURE_READY,
+        // the file could not be read or decoded, the handle keeps the placeholder
+        TEXTURE_FAILED,
+        // the owner released the texture
+        TEXTURE_RELEASED,
+        // thrown out for the budget, the next texture() loads it again
+        TEXTURE_EVICTED
+    };
+
+    // identifies a texture, -1 is never a valid handle
+    typedef int Handle;
+
+    struct Stats {
+        unsigned long long loads;
+        unsigned long long uploads;
+        unsigned long long failures;
+        // bytes of decoded pixels handed to texture_upload
+        unsigned long long uploadedBytes;
+        // time the workers spent decoding, summed over the workers
+        double decodeMs;
+        // time update() spent uploading on the render thread
+        double uploadMs;
+        // frames that stopped uploading because the budget was used up
+        unsigned long long budgetHits;
+        // images the decoder wrote straight into staging memory
+        unsigned long long inPlaceDecodes;
+        // images that had to be copied into staging memory, because the arena had no room (or there is none)
+        unsigned long long copiedDecodes;
+        // loads of a path that was loaded already
+        unsigned long long cacheHits;
+        // files that turned out to have the content of a texture that is loaded already
+        unsigned long long dedupes;
+        unsigned long long evictions;
+        unsigned long long reloads;
+        // frames the budget could not be kept in, because everything on the GPU was bound in the last frame
+        unsigned long long overBudget;
+        // block compressed textures the workers had to compress, and the ones read from their DDS file
+        unsigned long long compressions;
+        unsigned long long compressedCacheHits;
+    };
+
+    // starts threadCount decode threads (0: one per core, but at least one), creates the placeholder, returns 0 on success
+    int init(int threadCount = 0);
+    // stops the threads and deletes every texture that was not released
+    void shutdown();
+
+    // Queues the file for decoding and returns its handle, the texture gets mipmaps and repeats.
+    // A path that is loaded already gives the same handle, every load needs a release.
+    // With a format the texture is block compressed, or uploaded as it is when the driver can not sample the
+    // format (the same path in two formats is two textures).
+    Handle load(const char* path, texture_compressor::Format format = texture_compressor::FORMAT_NONE);
+    // Uploads decoded images until budgetMs have passed (at least one per call, so loading always makes
+    // progress). Returns how many loads and reloads are still pending. Call it once per frame on the GL
+    // thread, it also counts the frames the budget looks at.
+    int update(double budgetMs = 2.0);
+    // blocks until every queued texture is uploaded (or failed)
+    void waitAll();
+    // drops one reference, the last one deletes the texture (a pending decode is thrown away when it finishes)
+    void release(Handle handle);
+    TextureState state(Handle handle);
+    // The texture to bind, the placeholder while it is not ready. Marks it as used in this frame, an
+    // evicted texture is loaded again.
+    unsigned int texture(Handle handle);
+    int pendingCount();
+
+    // how many bytes of textures may stay on the GPU, 0 for no limit
+    void setBudget(size_t bytes);
+    size_t getBudget();
+    // what the textures that are on the GPU take, estimated
+    size_t residentBytes();
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
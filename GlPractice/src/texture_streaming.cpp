@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include "texture_streaming.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "uniform_table.h"
+#include "vertex_layout.h"
+#include "texture_loader.h"
+
+namespace texture_streaming {
+
+	const int gridSize = 16;
+	const char* const paths[] = { "assets/wall.jpg", "assets/64x64.jpg" };
+
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 2>,
+		vertex_layout::Attr<1, float, 2>> VertexLayout;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO;
+	// one per cell, the cells with the same file get the same handle (one more reference each)
+	std::vector<texture_loader::Handle> textures;
+	uniform_table::Table uniformTable;
+	uniform_table::Vec2Handle offsetHandle = { -1 };
+	uniform_table::IntHandle samplerHandle = { -1 };
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// the corner of the cell
+uniform vec2 offset;
+
+out vec2 texCoord;
+
+void main()
+{
+    gl_Position = vec4(aPos + offset, 0.0, 1.0);
+    texCoord = aTexCoord;
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+
+uniform sampler2D textureSampler;
+
+in vec2 texCoord;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = texture(textureSampler, texCoord);
+}
+)";
+
+	void registerScene()
+	{
+		scene::registerScene({ "texture_streaming", init, NULL, render, shutdown });
+	}
+
+	int init()
+	{
+		if (initShaders() != 0) return -1;
+		initTextures();
+		initVAOs();
+		return 0;
+	}
+
+	void initTextures()
+	{
+		// BC1 takes half a byte a texel, an eighth of what the RGB images take uncompressed (4 bytes on most drivers)
+		for (int i = 0; i < gridSize * gridSize; i++) textures.push_back(texture_loader::load(paths[i % 2], texture_compressor::FORMAT_BC1));
+	}
+
+	void initVAOs()
+	{
+		// one cell at the bottom left corner, the offset moves it, with a small gap to the next one
+		const float size = 2.0f / gridSize * 0.9f;
+		float positions[] = { -1.0f, -1.0f, -1.0f + size, -1.0f, -1.0f + size, -1.0f + size, -1.0f, -1.0f + size };
+		float texCoords[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+		unsigned char vertices[VertexLayout::bufferSize(4)];
+		VertexLayout::fill<0>(vertices, 4, positions);
+		VertexLayout::fill<1>(vertices, 4, texCoords);
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		VertexLayout::setup(VBO, 4);
+		glBindVertexArray(0);
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		uniform_table::setInt(uniformTable, samplerHandle, 0);
+		glBindVertexArray(VAO);
+		for (int i = 0; i < gridSize * gridSize; i++)
+		{
+			uniform_table::setVec2(uniformTable, offsetHandle, (i % gridSize) * 2.0f / gridSize, (i / gridSize) * 2.0f / gridSize);
+			// the placeholder until the texture is uploaded
+			glBindTexture(GL_TEXTURE_2D, texture_loader::texture(textures[i]));
+			glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindVertexArray(0);
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		for (texture_loader::Handle texture : textures) texture_loader::release(texture);
+		textures.clear();
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = shaderProgram = 0;
+		programJob = -1;
+		offsetHandle = { -1 };
+		samplerHandle = { -1 };
+	}
+
+	int initShaders()
+	{
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+
+		uniform_table::build(uniformTable, shaderProgram);
+		offsetHandle = uniform_table::getVec2(uniformTable, "offset");
+		samplerHandle = uniform_table::getInt(uniformTable, "textureSampler");
+	}
+
+}
@@ -0,0 +1,21 @@
+#ifndef TEXTURE_STREAMING_H
+#define TEXTURE_STREAMING_H
+
+// A grid of 256 quads with a texture each, all loaded through texture_loader. init only queues the
+// files, so the first frame is drawn right away with the placeholder and the textures pop in as the
+// workers decode them and texture_loader::update uploads a few per frame. There are only two files,
+// the loader's cache makes that two textures however many cells show them.
+namespace texture_streaming {
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+    void initTextures();
+    void initVAOs();
+}
+
+#endif
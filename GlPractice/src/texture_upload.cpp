@@ -0,0 +1,317 @@
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <cstring>
+#include <glad/glad.h>
+#include "texture_upload.h"
+#include "stream_buffer.h"
+#include "range_allocator.h"
+
+namespace texture_upload {
+
+	struct Buffer {
+		unsigned int id;
+		size_t capacity;
+		// the last upload from the buffer, NULL if the GPU is done with it
+		GLsync fence;
+	};
+
+	// a range of the arena the GPU may still be reading
+	struct Retiring {
+		range_allocator::Handle range;
+		GLsync fence;
+	};
+
+	std::vector<Buffer> buffers;
+	int next = 0;
+	UploadMode mode = UPLOAD_PBO;
+
+	// the arena, 0 / NULL without persistent mapping
+	unsigned int arena = 0;
+	unsigned char* arenaData = NULL;
+	// the allocator counts in units of this many bytes
+	const size_t ARENA_UNIT = 256;
+	// reserve() and cancel() run on the decode threads, the allocator (and mode, which reserve reads) is
+	// guarded by arenaMutex
+	std::mutex arenaMutex;
+	range_allocator::Allocator arenaRanges;
+	// oldest upload first, only touched on the GL thread
+	std::deque<Retiring> retiring;
+	// the pixels of a direct upload
+	std::vector<unsigned char> clientMemory;
+	Stats stats = {};
+
+	int init(int bufferCount, size_t bufferSize, size_t arenaSize)
+	{
+		if (!buffers.empty()) return 0;
+		if (bufferCount < 1) bufferCount = 1;
+		buffers.resize(bufferCount);
+		for (Buffer& buffer : buffers)
+		{
+			glGenBuffers(1, &buffer.id);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+			buffer.capacity = bufferSize;
+			buffer.fence = NULL;
+		}
+		next = 0;
+
+		if (arenaSize > 0 && stream_buffer::persistentSupported())
+		{
+			arenaSize = (arenaSize + ARENA_UNIT - 1) / ARENA_UNIT * ARENA_UNIT;
+			// coherent: what the decoder writes is visible to the upload without flushing
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glGenBuffers(1, &arena);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, arena);
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, arenaSize, NULL, flags);
+			arenaData = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, arenaSize, flags);
+			if (arenaData == NULL)
+			{
+				// the ring still works, only reserve() has nothing to give
+				std::cout << "ERROR::TEXTURE_UPLOAD::MAP_FAILED" << std::endl;
+				glDeleteBuffers(1, &arena);
+				arena = 0;
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(arenaMutex);
+				range_allocator::create(arenaRanges, arenaSize / ARENA_UNIT);
+			}
+		}
+		// a bound unpack buffer would make every other texture upload read from it
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return 0;
+	}
+
+	void shutdown()
+	{
+		for (Buffer& buffer : buffers)
+		{
+			if (buffer.fence != NULL) glDeleteSync(buffer.fence);
+			glDeleteBuffers(1, &buffer.id);
+		}
+		buffers.clear();
+		for (Retiring& upload : retiring) glDeleteSync(upload.fence);
+		retiring.clear();
+		if (arena != 0)
+		{
+			// deleting the buffer unmaps it
+			glDeleteBuffers(1, &arena);
+			arena = 0;
+			std::lock_guard<std::mutex> lock(arenaMutex);
+			arenaData = NULL;
+			range_allocator::create(arenaRanges, 0);
+		}
+		clientMemory.clear();
+		clientMemory.shrink_to_fit();
+	}
+
+	void setMode(UploadMode uploadMode)
+	{
+		std::lock_guard<std::mutex> lock(arenaMutex);
+		mode = uploadMode;
+	}
+
+	UploadMode getMode()
+	{
+		return mode;
+	}
+
+	// Waits until the GPU is done reading the buffer, returns false if it could not tell (the wait failed or
+	// took more than a second), then the GPU may still be reading it.
+	bool waitFence(Buffer& buffer)
+	{
+		if (buffer.fence == NULL) return true;
+		GLenum result = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			stats.fenceWaits++;
+			// a second at most, after that something is wrong anyway
+			result = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+		}
+		glDeleteSync(buffer.fence);
+		buffer.fence = NULL;
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			std::cout << "ERROR::TEXTURE_UPLOAD::FENCE_TIMEOUT" << std::endl;
+			return false;
+		}
+		if (result == GL_WAIT_FAILED)
+		{
+			std::cout << "ERROR::TEXTURE_UPLOAD::FENCE_WAIT_FAILED" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	int begin(Staging& staging, size_t size)
+	{
+		staging = { NULL, size, -1, -1 };
+		if (mode == UPLOAD_DIRECT || buffers.empty())
+		{
+			clientMemory.resize(size);
+			staging.data = clientMemory.data();
+			return 0;
+		}
+
+		GLbitfield access = GL_MAP_WRITE_BIT;
+		if (mode == UPLOAD_PBO_ORPHAN)
+		{
+			// the old storage stays alive until the GPU is done with it, we get new memory right away
+			staging.buffer = 0;
+			Buffer& buffer = buffers[0];
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+			// new storage every time anyway, of the size of this upload
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+			buffer.capacity = size;
+		}
+		else
+		{
+			staging.buffer = next;
+			next = (next + 1) % (int)buffers.size();
+			Buffer& buffer = buffers[staging.buffer];
+			bool idle = waitFence(buffer);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+			if (size > buffer.capacity)
+			{
+				buffer.capacity = size;
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer.capacity, NULL, GL_STREAM_DRAW);
+				stats.grows++;
+			}
+			else if (!idle)
+			{
+				// the GPU may still read the old storage, this upload goes into new storage
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer.capacity, NULL, GL_STREAM_DRAW);
+			}
+			access |= GL_MAP_INVALIDATE_RANGE_BIT;
+			// the fence says the GPU is done with it, the driver does not have to check again
+			if (idle) access |= GL_MAP_UNSYNCHRONIZED_BIT;
+		}
+
+		staging.data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (staging.data == NULL)
+		{
+			std::cout << "ERROR::TEXTURE_UPLOAD::MAP_FAILED" << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	void subImage(unsigned int texture, int level, int width, int height, unsigned int format, unsigned int type, const void* pixels)
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, type, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	int reserve(Staging& staging, size_t size)
+	{
+		staging = { NULL, size, -1, -1 };
+		std::lock_guard<std::mutex> lock(arenaMutex);
+		if (arenaData == NULL || mode != UPLOAD_PBO) return -1;
+		range_allocator::Handle range = range_allocator::allocate(arenaRanges, (size + ARENA_UNIT - 1) / ARENA_UNIT);
+		if (range < 0) return -1;
+		staging.data = arenaData + range_allocator::offset(arenaRanges, range) * ARENA_UNIT;
+		staging.range = range;
+		return 0;
+	}
+
+	void cancel(Staging& staging)
+	{
+		if (staging.range >= 0)
+		{
+			std::lock_guard<std::mutex> lock(arenaMutex);
+			// shutdown() may have taken the arena away in the meantime
+			if (arenaData != NULL) range_allocator::free(arenaRanges, staging.range);
+		}
+		else if (staging.buffer >= 0)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[staging.buffer].id);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		staging = { NULL, 0, -1, -1 };
+	}
+
+	void retire()
+	{
+		while (!retiring.empty())
+		{
+			// fences signal in order, the first one that has not tells there is nothing more to take back
+			GLenum result = glClientWaitSync(retiring.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) break;
+			glDeleteSync(retiring.front().fence);
+			{
+				std::lock_guard<std::mutex> lock(arenaMutex);
+				range_allocator::free(arenaRanges, retiring.front().range);
+			}
+			retiring.pop_front();
+		}
+	}
+
+	void end(Staging& staging, unsigned int texture, int level, int width, int height, unsigned int format, unsigned int type)
+	{
+		const void* pixels = staging.data;
+		if (staging.range >= 0)
+		{
+			// mapped for good, the pointer becomes the offset of the range
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, arena);
+			pixels = (const void*)((unsigned char*)staging.data - arenaData);
+		}
+		else if (staging.buffer >= 0)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[staging.buffer].id);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			// with an unpack buffer bound the pointer is an offset into it
+			pixels = NULL;
+		}
+
+		subImage(texture, level, width, height, format, type, pixels);
+
+		if (staging.range >= 0)
+		{
+			retiring.push_back({ staging.range, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		else if (staging.buffer >= 0)
+		{
+			if (mode == UPLOAD_PBO) buffers[staging.buffer].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		stats.uploads++;
+		stats.bytes += staging.size;
+		staging = { NULL, 0, -1, -1 };
+		retire();
+	}
+
+	void upload(unsigned int texture, int level, int width, int height, unsigned int format, unsigned int type, const void* pixels, size_t size)
+	{
+		if (mode == UPLOAD_DIRECT || buffers.empty())
+		{
+			// the pixels are already in client memory, copying them into ours first would only cost time
+			subImage(texture, level, width, height, format, type, pixels);
+			stats.uploads++;
+			stats.bytes += size;
+			return;
+		}
+		Staging staging;
+		if (begin(staging, size) != 0) return;
+		std::memcpy(staging.data, pixels, size);
+		end(staging, texture, level, width, height, format, type);
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
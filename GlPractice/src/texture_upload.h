@@ -0,0 +1,86 @@
+#ifndef TEXTURE_UPLOAD_H
+#define TEXTURE_UPLOAD_H
+
+#include <cstddef>
+
+// Texture uploads through pixel buffer objects.
+// glTexImage2D / glTexSubImage2D from client memory have to be done with the pixels before they return,
+// so the driver either copies them into memory of its own or converts them into the texture right there.
+// With a GL_PIXEL_UNPACK_BUFFER bound the pixels come from a buffer object instead: we write them into the
+// mapped buffer, the call only records the copy and returns, the GPU (or the driver's thread) does it later.
+//
+// The staging buffers are a small ring. A buffer is written again only after the fence of its last upload
+// signalled, so the CPU never writes into pixels the GPU is still reading, and the mapping can be
+// unsynchronized. Orphaning (glBufferData with NULL before mapping one buffer) is the other way to get
+// there, the driver hands out fresh memory whenever the old one is still in use.
+//
+// With ARB_buffer_storage there is also an arena, one buffer mapped persistently for its whole life.
+// reserve() hands out ranges of it on any thread without a GL call, so the image decoder can write its
+// pixels straight into memory the texture is uploaded from (texture_loader does). A range goes back to the
+// arena once the fence of its upload signalled.
+//
+//     texture_upload::Staging staging;
+//     if (texture_upload::begin(staging, width * height * 4) == 0)
+//     {
+//         // write the pixels into staging.data
+//         texture_upload::end(staging, texture, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+//     }
+namespace texture_upload {
+    enum UploadMode {
+        // glTexSubImage2D straight from client memory
+        UPLOAD_DIRECT,
+        // the ring of fenced staging buffers
+        UPLOAD_PBO,
+        // one staging buffer, orphaned before every upload
+        UPLOAD_PBO_ORPHAN
+    };
+
+    // where begin() wants the pixels written
+    struct Staging {
+        void* data;
+        size_t size;
+        // index of the staging buffer, -1 for client memory or the arena
+        int buffer;
+        // range of the arena, -1 if the memory is not from there
+        int range;
+    };
+
+    struct Stats {
+        unsigned long long uploads;
+        unsigned long long bytes;
+        // uploads that had to wait for the GPU to finish with a staging buffer
+        unsigned long long fenceWaits;
+        // times a staging buffer had to grow for a bigger image
+        unsigned long long grows;
+    };
+
+    // Creates bufferCount staging buffers of bufferSize bytes (they grow for bigger images) and, if the driver
+    // can map persistently, the arena of arenaSize bytes. Returns 0 on success.
+    int init(int bufferCount = 2, size_t bufferSize = 4 << 20, size_t arenaSize = 64 << 20);
+    void shutdown();
+    void setMode(UploadMode mode);
+    UploadMode getMode();
+
+    // Gives out size bytes to write the pixels of one upload into, returns 0 on success.
+    // Nothing else may be uploaded until end(), the staging buffer is mapped until then.
+    int begin(Staging& staging, size_t size);
+    // Copies the pixels written into staging into level of the texture (GL_TEXTURE_2D), from its corner.
+    // The rows are tightly packed. Leaves GL_TEXTURE_2D bound to 0.
+    void end(Staging& staging, unsigned int texture, int level, int width, int height, unsigned int format, unsigned int type);
+    // Reserves size bytes of the arena to write pixels into, end() uploads them like the ones from begin().
+    // Safe to call on any thread, there is no GL call in it. Returns -1 if there is no arena, the mode is not
+    // UPLOAD_PBO or the arena has no room right now, the caller then uses begin() or upload().
+    int reserve(Staging& staging, size_t size);
+    // Gives the staging memory back without uploading anything. Arena ranges can be cancelled on any thread,
+    // the rest only on the GL thread.
+    void cancel(Staging& staging);
+    // returns the ranges of the arena the GPU is done with, end() does it too
+    void retire();
+    // begin, copy the pixels, end
+    void upload(unsigned int texture, int level, int width, int height, unsigned int format, unsigned int type, const void* pixels, size_t size);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <cstring>
+#include <glad/glad.h>
+#include "uniform_ring.h"
+
+namespace uniform_ring {
+
+	int create(Ring& ring, size_t blockCount, size_t blockSize)
+	{
+		GLint alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		ring.alignment = alignment > 0 ? (size_t)alignment : 256;
+
+		// every block starts aligned, so each one takes its size rounded up to the alignment
+		// (this also keeps the start of every frame's region aligned)
+		size_t alignedSize = (blockSize + ring.alignment - 1) / ring.alignment * ring.alignment;
+		return stream_buffer::create(ring.buffer, blockCount * alignedSize);
+	}
+
+	void destroy(Ring& ring)
+	{
+		stream_buffer::destroy(ring.buffer);
+	}
+
+	void beginFrame(Ring& ring)
+	{
+		stream_buffer::beginFrame(ring.buffer);
+	}
+
+	int push(Ring& ring, const void* block, size_t size, size_t& offset)
+	{
+		void* data = stream_buffer::allocate(ring.buffer, size, ring.alignment, offset);
+		if (data == NULL) return -1;
+		std::memcpy(data, block, size);
+		return 0;
+	}
+
+	void flush(Ring& ring)
+	{
+		stream_buffer::flush(ring.buffer);
+	}
+
+	void bind(const Ring& ring, unsigned int binding, size_t offset, size_t size)
+	{
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring.buffer.id, offset, size);
+	}
+
+	void endFrame(Ring& ring)
+	{
+		stream_buffer::endFrame(ring.buffer);
+	}
+
+	int bindBlock(unsigned int program, const char* name, unsigned int binding)
+	{
+		unsigned int index = glGetUniformBlockIndex(program, name);
+		if (index == GL_INVALID_INDEX)
+		{
+			std::cout << "ERROR::UNIFORM_RING::BLOCK_NOT_FOUND " << name << std::endl;
+			return -1;
+		}
+		// GLSL 3.30 has no layout(binding = N), so the binding point is set on the program
+		glUniformBlockBinding(program, index, binding);
+		return 0;
+	}
+
+}
@@ -0,0 +1,38 @@
+#ifndef UNIFORM_RING_H
+#define UNIFORM_RING_H
+
+#include <cstddef>
+#include "stream_buffer.h"
+
+// Uniform blocks of every draw in a frame, written one after the other into a stream buffer.
+// A frame first pushes the blocks of all its draws, flushes once, then before each draw binds that draw's
+// block with glBindBufferRange. That is one upload per frame instead of a glUniform* call per value per draw.
+// The blocks have to use the std140 layout, so the C++ structs can be copied as they are.
+namespace uniform_ring {
+    struct Ring {
+        stream_buffer::Buffer buffer;
+        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, every block starts at a multiple of it
+        size_t alignment;
+    };
+
+    // creates the ring with room for blockCount blocks of at most blockSize bytes per frame
+    int create(Ring& ring, size_t blockCount, size_t blockSize);
+    void destroy(Ring& ring);
+
+    // waits until the GPU is done with the region of the frame from FRAME_COUNT frames ago
+    void beginFrame(Ring& ring);
+    // Copies the block into the frame's region, offset is set to where it was written (what bind needs).
+    // Returns 0 on success, -1 if the frame pushed more than it has room for.
+    int push(Ring& ring, const void* block, size_t size, size_t& offset);
+    // makes the pushed blocks visible to the GPU, call it once after the last push and before the draws
+    void flush(Ring& ring);
+    // binds size bytes at offset to the uniform block binding point
+    void bind(const Ring& ring, unsigned int binding, size_t offset, size_t size);
+    void endFrame(Ring& ring);
+
+    // Connects the program's uniform block called name to the binding point. Returns 0 on success,
+    // -1 if the program has no such (active) block.
+    int bindBlock(unsigned int program, const char* name, unsigned int binding);
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cstring>
+#include <glad/glad.h>
+#include "uniform_table.h"
+
+namespace uniform_table {
+
+	Stats stats = {};
+
+	bool isIntType(unsigned int type)
+	{
+		switch (type)
+		{
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	int build(Table& table, unsigned int program)
+	{
+		table.program = program;
+		table.uniforms.clear();
+
+		int count = 0, maxLength = 0;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		if (count == 0) return 0;
+
+		std::vector<char> name(maxLength + 1);
+		for (int i = 0; i < count; i++)
+		{
+			int length = 0, size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+			Uniform uniform = {};
+			uniform.name.assign(name.data(), length);
+			// arrays are reported as "name[0]", but we want to find them by their plain name
+			size_t bracket = uniform.name.find('[');
+			if (bracket != std::string::npos) uniform.name.erase(bracket);
+			// uniforms inside uniform blocks have no location, they are set through buffers instead
+			uniform.location = glGetUniformLocation(program, name.data());
+			if (uniform.location < 0) continue;
+			uniform.type = type;
+			uniform.arraySize = size;
+			uniform.written = false;
+			table.uniforms.push_back(uniform);
+		}
+
+		return 0;
+	}
+
+	int find(const Table& table, const char* name, unsigned int type)
+	{
+		for (size_t i = 0; i < table.uniforms.size(); i++)
+		{
+			const Uniform& uniform = table.uniforms[i];
+			if (uniform.name != name) continue;
+
+			bool typeMatches = type == GL_INT ? isIntType(uniform.type) : uniform.type == type;
+			if (!typeMatches)
+			{
+				std::cout << "ERROR::UNIFORM::TYPE_MISMATCH " << name << std::endl;
+				return -1;
+			}
+			return (int)i;
+		}
+		return -1;
+	}
+
+	FloatHandle getFloat(const Table& table, const char* name) { return { find(table, name, GL_FLOAT) }; }
+	Vec2Handle getVec2(const Table& table, const char* name) { return { find(table, name, GL_FLOAT_VEC2) }; }
+	Vec3Handle getVec3(const Table& table, const char* name) { return { find(table, name, GL_FLOAT_VEC3) }; }
+	Vec4Handle getVec4(const Table& table, const char* name) { return { find(table, name, GL_FLOAT_VEC4) }; }
+	IntHandle getInt(const Table& table, const char* name) { return { find(table, name, GL_INT) }; }
+	Mat4Handle getMat4(const Table& table, const char* name) { return { find(table, name, GL_FLOAT_MAT4) }; }
+
+	// Compares the new value to the cached one and stores it if it changed.
+	// Returns the uniform to upload, or NULL if the upload can be skipped.
+	Uniform* update(Table& table, int index, const void* value, size_t size)
+	{
+		if (index < 0) return NULL;
+
+		stats.lookupsAvoided++;
+
+		Uniform& uniform = table.uniforms[index];
+		if (uniform.written && std::memcmp(uniform.value, value, size) == 0)
+		{
+			stats.uploadsSkipped++;
+			return NULL;
+		}
+		std::memcpy(uniform.value, value, size);
+		uniform.written = true;
+		stats.uploads++;
+		return &uniform;
+	}
+
+	void setFloat(Table& table, FloatHandle handle, float x)
+	{
+		Uniform* uniform = update(table, handle.index, &x, sizeof(x));
+		if (uniform != NULL) glUniform1f(uniform->location, x);
+	}
+
+	void setVec2(Table& table, Vec2Handle handle, float x, float y)
+	{
+		float v[] = { x, y };
+		Uniform* uniform = update(table, handle.index, v, sizeof(v));
+		if (uniform != NULL) glUniform2f(uniform->location, x, y);
+	}
+
+	void setVec3(Table& table, Vec3Handle handle, float x, float y, float z)
+	{
+		float v[] = { x, y, z };
+		Uniform* uniform = update(table, handle.index, v, sizeof(v));
+		if (uniform != NULL) glUniform3f(uniform->location, x, y, z);
+	}
+
+	void setVec4(Table& table, Vec4Handle handle, float x, float y, float z, float w)
+	{
+		float v[] = { x, y, z, w };
+		Uniform* uniform = update(table, handle.index, v, sizeof(v));
+		if (uniform != NULL) glUniform4f(uniform->location, x, y, z, w);
+	}
+
+	void setInt(Table& table, IntHandle handle, int x)
+	{
+		Uniform* uniform = update(table, handle.index, &x, sizeof(x));
+		if (uniform != NULL) glUniform1i(uniform->location, x);
+	}
+
+	void setMat4(Table& table, Mat4Handle handle, const float* m)
+	{
+		Uniform* uniform = update(table, handle.index, m, 16 * sizeof(float));
+		if (uniform != NULL) glUniformMatrix4fv(uniform->location, 1, GL_FALSE, m);
+	}
+
+	const Stats& getStats()
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+}
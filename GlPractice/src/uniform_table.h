@@ -0,0 +1,72 @@
+#ifndef UNIFORM_TABLE_H
+#define UNIFORM_TABLE_H
+
+#include <string>
+#include <vector>
+
+// Reflects the active uniforms of a linked program once, so the render loop never has to look up
+// a location by name, and remembers the last written value so unchanged uniforms are not uploaded again.
+namespace uniform_table {
+    struct Uniform {
+        std::string name;
+        int location;
+        // GL_FLOAT_VEC4, GL_SAMPLER_2D, ...
+        unsigned int type;
+        // number of elements, 1 if the uniform is not an array
+        int arraySize;
+        // false until the first upload, the cached value means nothing before that
+        bool written;
+        // last value uploaded, big enough for a mat4
+        unsigned char value[64];
+    };
+
+    struct Table {
+        unsigned int program;
+        std::vector<Uniform> uniforms;
+    };
+
+    // Typed handles, so a vec4 uniform can not be set as a float by accident.
+    // An index of -1 means the uniform does not exist (or was optimized out), setting it does nothing.
+    struct FloatHandle { int index; };
+    struct Vec2Handle { int index; };
+    struct Vec3Handle { int index; };
+    struct Vec4Handle { int index; };
+    // ints, bools and samplers
+    struct IntHandle { int index; };
+    struct Mat4Handle { int index; };
+
+    struct Stats {
+        // glGetUniformLocation calls we did not have to make thanks to the handles
+        unsigned long long lookupsAvoided;
+        // glUniform* calls skipped because the value did not change
+        unsigned long long uploadsSkipped;
+        // glUniform* calls actually made
+        unsigned long long uploads;
+    };
+
+    // fills the table from glGetActiveUniform, the program has to be linked already
+    int build(Table& table, unsigned int program);
+    // index of the uniform with the given name and type, -1 if there is none
+    int find(const Table& table, const char* name, unsigned int type);
+
+    FloatHandle getFloat(const Table& table, const char* name);
+    Vec2Handle getVec2(const Table& table, const char* name);
+    Vec3Handle getVec3(const Table& table, const char* name);
+    Vec4Handle getVec4(const Table& table, const char* name);
+    IntHandle getInt(const Table& table, const char* name);
+    Mat4Handle getMat4(const Table& table, const char* name);
+
+    // Like glUniform*, these update the program that is currently in use, so table.program has to be bound.
+    void setFloat(Table& table, FloatHandle handle, float x);
+    void setVec2(Table& table, Vec2Handle handle, float x, float y);
+    void setVec3(Table& table, Vec3Handle handle, float x, float y, float z);
+    void setVec4(Table& table, Vec4Handle handle, float x, float y, float z, float w);
+    void setInt(Table& table, IntHandle handle, int x);
+    // column major, like glUniformMatrix4fv without transpose
+    void setMat4(Table& table, Mat4Handle handle, const float* m);
+
+    const Stats& getStats();
+    void resetStats();
+}
+
+#endif
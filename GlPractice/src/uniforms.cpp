@@ -1,14 +1,33 @@
 #include <iostream>
+#include <cmath>
+#include <string>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include "uniforms.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "uniform_ring.h"
+#include "gl_layout.h"
 
 namespace uniforms {
 
-	GLFWwindow* window;
 	// hint: could just attach and detach the yellow and orange shaders
 	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
 	unsigned int orangeVAO, yellowVAO;
+	unsigned int orangeVBO, yellowVBO;
+	// the per-draw uniforms, one DrawBlock for every triangle of every frame
+	uniform_ring::Ring uniformRing = {};
+	// the C++ side of the DrawBlock uniform block, copied into the ring as it is
+	struct DrawBlock {
+		gl_layout::Vec4 color;
+	};
+	// the GLSL side, the declaration in the fragment shader is generated from this
+	typedef gl_layout::Block<gl_layout::Std140, gl_layout::Vec4> DrawBlockLayout;
+	static_assert(gl_layout::matches<DrawBlockLayout, DrawBlock>({ GL_LAYOUT_FIELD(DrawBlock, color) }),
+		"DrawBlock does not match its std140 layout");
+	const unsigned int drawBlockBinding = 0;
+	// seconds since the start, set by update()
+	double elapsedTime;
 
 	const char* vertexShaderSrc = R"(
 #version 330 core
@@ -19,77 +38,97 @@ void main()
     gl_Position = vec4(aPos.xyz, 1.0);
 }
 )";
+	// the DrawBlock declaration goes between the two halves
 	const char* fragmentShaderSrc = R"(
 #version 330 core
 out vec4 FragColor;
-
-uniform vec4 color;
-
+)";
+	const char* fragmentShaderMainSrc = R"(
 void main()
 {
     FragColor = color;
 }
 )";
 
-	int main() {
-		// 1. create a window, initialize OpenGL
-		if (initContext() != 0) return -1;
-		// 2. black background color
-		glClearColor(.0f, .0f, .0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		// 3. initialize shaders
+	void registerScene()
+	{
+		scene::registerScene({ "uniforms", init, update, render, shutdown });
+	}
+
+	int init() {
+		// 1. initialize shaders
 		if (initShaders() != 0) return -1;
-		// 4. create two triangles
+		// 2. create the triangles
 		initVAOs();
+		// 3. room for the uniforms of both triangles
+		return uniform_ring::create(uniformRing, 2, sizeof(DrawBlock));
+	}
 
-		// 5. create render loop
-		while (!glfwWindowShouldClose(window))
-		{
-			// 6. render the triangles
-			renderTriangles();
-
-			if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-			{
-				glfwSetWindowShouldClose(window, true);
-			}
-
-			glfwPollEvents();
-			glfwSwapBuffers(window);
-		}
+	void update(double t)
+	{
+		elapsedTime = t;
+	}
 
-		// 7. clean resources
-		glfwTerminate();
+	void render()
+	{
+		// black background color
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		// render the triangles
+		renderTriangles();
+	}
 
-		return 0;
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &orangeVAO);
+		glDeleteVertexArrays(1, &yellowVAO);
+		glDeleteBuffers(1, &orangeVBO);
+		glDeleteBuffers(1, &yellowVBO);
+		uniform_ring::destroy(uniformRing);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		orangeVAO = yellowVAO = orangeVBO = yellowVBO = shaderProgram = 0;
+		programJob = -1;
 	}
 
 	void renderTriangles()
 	{
-		// get the time to animate
-		double t = glfwGetTime();
+		// the time to animate with
+		double t = elapsedTime;
+
+		// First write the uniforms of every draw into the ring, the red part of the orange triangle and
+		// the green part of the yellow one follow the sin of time (over time it will animate).
+		// The two blocks get to the GPU together at the flush, there is no glUniform call per draw.
+		uniform_ring::beginFrame(uniformRing);
+		DrawBlock orange = { { (float)sin(t) / 2.f + .5f, .1f, .1f, 1.0f } };
+		DrawBlock yellow = { { .1f, (float)-sin(t) / 2.f + .5f, .1f, 1.0f } };
+		size_t orangeOffset, yellowOffset;
+		if (uniform_ring::push(uniformRing, &orange, sizeof(orange), orangeOffset) != 0 ||
+			uniform_ring::push(uniformRing, &yellow, sizeof(yellow), yellowOffset) != 0)
+		{
+			uniform_ring::endFrame(uniformRing);
+			return;
+		}
+		uniform_ring::flush(uniformRing);
 
-		// get the location of the "color" uniform
-		int colorLocation = glGetUniformLocation(shaderProgram, "color");
 		// use shader program once
-		// Note that finding the uniform location does not require you to use the shader program first, 
-		// but updating a uniform does require you to first use the program (by calling glUseProgram), 
-		// because it sets the uniform on the currently active shader program.
-		glUseProgram(shaderProgram);
-		// and set the "color" uniform 's red part to the sin of time (over time it will animate)
-		float redPart = sin(t) / 2.f + .5f;
-		glUniform4f(colorLocation, redPart, .1f, .1f, 1.0f);
+		// The program reads DrawBlock from binding point drawBlockBinding (onProgramReady connected them),
+		// so selecting the color of a draw is only pointing the binding at its block.
+		shader_compiler::useProgram(shaderProgram);
 
+		uniform_ring::bind(uniformRing, drawBlockBinding, orangeOffset, sizeof(DrawBlock));
 		glBindVertexArray(orangeVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
 		// now the same for the yellow triangle
-		float greenPart = -sin(t) / 2.f + .5f;
-		glUniform4f(colorLocation, .1f, greenPart, .1f, 1.0f);
-
+		uniform_ring::bind(uniformRing, drawBlockBinding, yellowOffset, sizeof(DrawBlock));
 		glBindVertexArray(yellowVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
 		glBindVertexArray(0);
+
+		// the region can be written again once the GPU passed this point
+		uniform_ring::endFrame(uniformRing);
 	}
 
 	void initVAOs() {
@@ -106,7 +145,6 @@ void main()
 		};
 
 		// create VBOs
-		unsigned int orangeVBO, yellowVBO;
 		glGenBuffers(1, &orangeVBO);
 		glGenBuffers(1, &yellowVBO);
 
@@ -136,87 +174,21 @@ void main()
 	}
 
 	int initShaders() {
-		// compile shaders by creating a shader object and attaching the shader sources to them
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-		glShaderSource(vertexShader, 1, &vertexShaderSrc, NULL);
-		glShaderSource(fragmentShader, 1, &fragmentShaderSrc, NULL);
-
-		glCompileShader(vertexShader);
-		glCompileShader(fragmentShader);
-
-		int success;
-		char infoLog[512];
-
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		shaderProgram = glCreateProgram();
-
-		glAttachShader(shaderProgram, vertexShader);
-		glAttachShader(shaderProgram, fragmentShader);
+		std::string fragmentSource = fragmentShaderSrc;
+		fragmentSource += DrawBlockLayout::glsl("DrawBlock", { "color" });
+		fragmentSource += fragmentShaderMainSrc;
 
-		glLinkProgram(shaderProgram);
-
-		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::PROGRAM::SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-			return -1;
-		}
-
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
-
-		return 0;
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentSource.c_str(), onProgramReady);
+		return programJob < 0 ? -1 : 0;
 	}
 
-	int initContext() {
-		int width = 800, height = 800;
-		// init glfw
-		glfwInit();
-		// hint window for OpenGl version 3.3
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-		// hint window to use core profile
-		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-		// request glfw to create a window
-		window = glfwCreateWindow(width, height, "Hello triangle excercise", NULL, NULL);
-		// check for error during window creation
-		if (window == NULL)
-		{
-			std::cout << "ERROR::WINDOW::FAILED_TO_CREATE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-		// set the current context to the created window
-		glfwMakeContextCurrent(window);
-		// initialize glad
-		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-		{
-			std::cout << "ERROR::GLAD::FAILED_TO_INITIALIZE" << std::endl;
-			glfwTerminate();
-			return -1;
-		}
-
-		glViewport(0, 0, width, height);
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
 
-		return 0;
+		// connect the block to its binding point once, the render loop only binds buffer ranges
+		uniform_ring::bindBlock(shaderProgram, "DrawBlock", drawBlockBinding);
 	}
 
 }
\ No newline at end of file
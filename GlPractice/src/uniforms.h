@@ -2,9 +2,17 @@
 #define UNIFORMS_H
 
 namespace uniforms {
-    int main();
-    int initContext();
+    // adds the demo to the scene registry
+    void registerScene();
+    int init();
+    // stores the time used by the color animation
+    void update(double time);
+    // clears the screen and draws the triangles
+    void render();
+    void shutdown();
     int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
     void initVAOs();
     void renderTriangles();
 }
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include "vertex_fetch.h"
+#include "scene.h"
+#include "shader_compiler.h"
+#include "vertex_layout.h"
+#include "mesh_optimizer.h"
+
+namespace vertex_fetch {
+
+	// the full vertex of the mesh: position, normal, texture coordinates and color, 24 bytes
+	typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+		vertex_layout::Attr<0, float, 3>,
+		vertex_layout::Attr<1, vertex_layout::int2_10_10_10, 4, vertex_layout::normalized>,
+		vertex_layout::Attr<2, vertex_layout::half, 2>,
+		vertex_layout::Attr<3, vertex_layout::ubyte, 4, vertex_layout::normalized>> InterleavedLayout;
+	typedef vertex_layout::VertexLayout<vertex_layout::SoA,
+		vertex_layout::Attr<0, float, 3>,
+		vertex_layout::Attr<1, vertex_layout::int2_10_10_10, 4, vertex_layout::normalized>,
+		vertex_layout::Attr<2, vertex_layout::half, 2>,
+		vertex_layout::Attr<3, vertex_layout::ubyte, 4, vertex_layout::normalized>> SoALayout;
+
+	// 256 x 256 vertices, the most 16 bit indices can address
+	const int gridSize = 255;
+	// how many times the pass is drawn per frame
+	const int passCount = 4;
+
+	unsigned int shaderProgram;
+	shader_compiler::Handle programJob = -1;
+	unsigned int VAO, VBO, EBO;
+	int indexCount;
+	unsigned int indexType;
+
+	const char* vertexShaderSrc = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+void main()
+{
+    gl_Position = vec4(aPos, 1.0);
+}
+)";
+	const char* fragmentShaderSrc = R"(
+#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.2, 0.4, 0.8, 1.0);
+}
+)";
+
+	void registerScene()
+	{
+		scene::registerScene({ "vertex_fetch_interleaved", initInterleaved, NULL, render, shutdown });
+		scene::registerScene({ "vertex_fetch_soa", initSoA, NULL, render, shutdown });
+	}
+
+	// builds the grid in the layout, only the position attribute is set up in the VAO
+	template <typename Layout>
+	int initMesh()
+	{
+		// position, normal, texture coordinates, color as floats, the optimizer reorders whole vertices
+		const size_t floatsPerVertex = 3 + 4 + 2 + 4;
+		size_t vertexCount = (gridSize + 1) * (gridSize + 1);
+		std::vector<float> mesh;
+		mesh.reserve(vertexCount * floatsPerVertex);
+		for (int y = 0; y <= gridSize; y++)
+		{
+			for (int x = 0; x <= gridSize; x++)
+			{
+				float u = (float)x / gridSize, v = (float)y / gridSize;
+				mesh.insert(mesh.end(), { u * 1.8f - 0.9f, v * 1.8f - 0.9f, 0.0f,   0.0f, 0.0f, 1.0f, 0.0f,   u, v,   u, v, 1.0f, 1.0f });
+			}
+		}
+
+		std::vector<unsigned int> indices;
+		indices.reserve(gridSize * gridSize * 6);
+		for (int y = 0; y < gridSize; y++)
+		{
+			for (int x = 0; x < gridSize; x++)
+			{
+				unsigned int corner = y * (gridSize + 1) + x;
+				unsigned int above = corner + gridSize + 1;
+				indices.insert(indices.end(), { corner, corner + 1, above, corner + 1, above + 1, above });
+			}
+		}
+
+		// The grid is built row by row, by the time the next row reuses a vertex it has long left the cache.
+		std::vector<unsigned char> optimized((unsigned char*)mesh.data(), (unsigned char*)(mesh.data() + mesh.size()));
+		mesh_optimizer::optimizeMesh(optimized, vertexCount, floatsPerVertex * sizeof(float), indices);
+
+		// split the attributes into the streams fill() reads
+		std::vector<float> positions, normals, texCoords, colors;
+		const float* vertex = (const float*)optimized.data();
+		for (size_t v = 0; v < vertexCount; v++, vertex += floatsPerVertex)
+		{
+			positions.insert(positions.end(), vertex, vertex + 3);
+			normals.insert(normals.end(), vertex + 3, vertex + 7);
+			texCoords.insert(texCoords.end(), vertex + 7, vertex + 9);
+			colors.insert(colors.end(), vertex + 9, vertex + 13);
+		}
+
+		indexCount = (int)indices.size();
+		std::vector<unsigned char> narrowIndices;
+		indexType = mesh_optimizer::narrowIndices(narrowIndices, indices.data(), indices.size(), vertexCount);
+
+		std::vector<unsigned char> vertices(Layout::bufferSize(vertexCount));
+		Layout::template fill<0>(vertices.data(), vertexCount, positions.data());
+		Layout::template fill<1>(vertices.data(), vertexCount, normals.data());
+		Layout::template fill<2>(vertices.data(), vertexCount, texCoords.data());
+		Layout::template fill<3>(vertices.data(), vertexCount, colors.data());
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrowIndices.size(), narrowIndices.data(), GL_STATIC_DRAW);
+		// the pass only reads the position, the first attribute
+		Layout::setup(VBO, vertexCount, 1u << 0);
+		glBindVertexArray(0);
+
+		return 0;
+	}
+
+	int initInterleaved()
+	{
+		if (initShaders() != 0) return -1;
+		return initMesh<InterleavedLayout>();
+	}
+
+	int initSoA()
+	{
+		if (initShaders() != 0) return -1;
+		return initMesh<SoALayout>();
+	}
+
+	void render()
+	{
+		glClearColor(.0f, .0f, .0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shader_compiler::useProgram(shaderProgram);
+		glBindVertexArray(VAO);
+		for (int i = 0; i < passCount; i++)
+		{
+			glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+		}
+		glBindVertexArray(0);
+	}
+
+	void shutdown()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		// the program belongs to the shader compiler, it also releases the shared stages
+		shader_compiler::release(programJob);
+		VAO = VBO = EBO = shaderProgram = 0;
+		programJob = -1;
+	}
+
+	int initShaders() {
+		// compile the program in the background, the fallback program is used until it is done
+		programJob = shader_compiler::submit(vertexShaderSrc, fragmentShaderSrc, onProgramReady);
+		return programJob < 0 ? -1 : 0;
+	}
+
+	void onProgramReady(unsigned int program)
+	{
+		shaderProgram = program;
+	}
+
+}
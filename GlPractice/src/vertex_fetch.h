@@ -0,0 +1,19 @@
+#ifndef VERTEX_FETCH_H
+#define VERTEX_FETCH_H
+
+// A position-only pass (like a depth prepass or a shadow map) over a dense grid mesh, drawn a few times a frame.
+// "vertex_fetch_interleaved" keeps the vertices interleaved, "vertex_fetch_soa" keeps every attribute in its
+// own stream, so the bench shows how much the unused attributes cost the vertex fetch.
+namespace vertex_fetch {
+    // adds both versions of the demo to the scene registry
+    void registerScene();
+    int initInterleaved();
+    int initSoA();
+    void render();
+    void shutdown();
+    int initShaders();
+    // called by the shader compiler once the program is linked
+    void onProgramReady(unsigned int program);
+}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <tuple>
+#include <type_traits>
+#include <glad/glad.h>
+#include "vertex_pack.h"
+
+// Vertex formats described at compile time instead of hand-written strides and offsets:
+//
+//     typedef vertex_layout::VertexLayout<vertex_layout::Interleaved,
+//         vertex_layout::Attr<0, vertex_layout::half, 3>,
+//         vertex_layout::Attr<1, vertex_layout::ubyte, 3, vertex_layout::normalized>> Layout;
+//
+// The stride and the offsets are constexpr, setup() makes the glVertexAttribPointer calls and fill()
+// converts float data into the attribute's type. The storage is chosen with the first parameter:
+// Interleaved puts the attributes of a vertex next to each other, SoA (struct of arrays) puts every
+// attribute into its own tightly packed stream, one after the other in the same buffer. A pass that only
+// reads positions fetches only the position stream with SoA, with Interleaved it drags the rest along.
+namespace vertex_layout {
+    typedef uint8_t ubyte;
+    typedef int8_t byte;
+    typedef uint16_t ushort;
+    // 16 bit float, stored as its bits
+    struct half { uint16_t bits; };
+    // xyz in 10 bits and w in 2 bits (GL_INT_2_10_10_10_REV), always 4 components
+    struct int2_10_10_10 { uint32_t bits; };
+
+    const bool normalized = true;
+
+    struct Interleaved {};
+    struct SoA {};
+
+    // GL type and size of one component
+    template <typename T> struct ComponentType;
+    template <> struct ComponentType<float> { static constexpr GLenum type = GL_FLOAT; static constexpr size_t size = 4; };
+    template <> struct ComponentType<half> { static constexpr GLenum type = GL_HALF_FLOAT; static constexpr size_t size = 2; };
+    template <> struct ComponentType<short> { static constexpr GLenum type = GL_SHORT; static constexpr size_t size = 2; };
+    template <> struct ComponentType<ushort> { static constexpr GLenum type = GL_UNSIGNED_SHORT; static constexpr size_t size = 2; };
+    template <> struct ComponentType<byte> { static constexpr GLenum type = GL_BYTE; static constexpr size_t size = 1; };
+    template <> struct ComponentType<ubyte> { static constexpr GLenum type = GL_UNSIGNED_BYTE; static constexpr size_t size = 1; };
+    // the whole vector is one 4 byte value
+    template <> struct ComponentType<int2_10_10_10> { static constexpr GLenum type = GL_INT_2_10_10_10_REV; static constexpr size_t size = 0; };
+
+    template <unsigned int Location, typename T, int Components, bool Normalized = false>
+    struct Attr {
+        static_assert(Components >= 1 && Components <= 4, "an attribute has 1 to 4 components");
+        static_assert(ComponentType<T>::size != 0 || Components == 4, "int2_10_10_10 always has 4 components");
+
+        typedef T Type;
+        static constexpr unsigned int location = Location;
+        static constexpr int components = Components;
+        static constexpr bool isNormalized = Normalized;
+        static constexpr GLenum glType = ComponentType<T>::type;
+        // rounded up to 4 bytes, GL wants every attribute to start aligned
+        static constexpr size_t size = ComponentType<T>::size == 0 ? 4 : (ComponentType<T>::size * Components + 3) / 4 * 4;
+        // the bytes that hold data, size without the padding
+        static constexpr size_t dataSize = ComponentType<T>::size == 0 ? 4 : ComponentType<T>::size * Components;
+    };
+
+    // Converts count vectors of components floats. Normalized integers are clamped and scaled,
+    // plain integers just take the value.
+    inline void convert(const float* in, float* out, size_t count, int components, bool)
+    {
+        for (size_t i = 0; i < count * components; i++) out[i] = in[i];
+    }
+    inline void convert(const float* in, half* out, size_t count, int components, bool)
+    {
+        vertex_pack::toHalf(in, (uint16_t*)out, count * components);
+    }
+    inline void convert(const float* in, short* out, size_t count, int components, bool isNormalized)
+    {
+        if (isNormalized) vertex_pack::toSnorm16(in, out, count * components);
+        else for (size_t i = 0; i < count * components; i++) out[i] = (short)in[i];
+    }
+    inline void convert(const float* in, ushort* out, size_t count, int components, bool isNormalized)
+    {
+        if (isNormalized) vertex_pack::toUnorm16(in, out, count * components);
+        else for (size_t i = 0; i < count * components; i++) out[i] = (ushort)in[i];
+    }
+    inline void convert(const float* in, byte* out, size_t count, int components, bool isNormalized)
+    {
+        for (size_t i = 0; i < count * components; i++)
+        {
+            float value = in[i];
+            if (isNormalized) value = (value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value) * 127.0f;
+            out[i] = (byte)(value < 0.0f ? value - 0.5f : value + 0.5f);
+        }
+    }
+    inline void convert(const float* in, ubyte* out, size_t count, int components, bool isNormalized)
+    {
+        if (isNormalized) vertex_pack::toUnorm8(in, out, count * components);
+        else for (size_t i = 0; i < count * components; i++) out[i] = (ubyte)in[i];
+    }
+    inline void convert(const float* in, int2_10_10_10* out, size_t count, int components, bool)
+    {
+        vertex_pack::toSnorm2101010(in, (uint32_t*)out, count, components);
+    }
+
+    template <typename Storage, typename... Attrs>
+    struct VertexLayout {
+        static_assert(sizeof...(Attrs) > 0, "a vertex layout needs at least one attribute");
+        static constexpr size_t count = sizeof...(Attrs);
+        static constexpr bool interleaved = std::is_same<Storage, Interleaved>::value;
+
+        // bytes of one attribute of one vertex
+        static constexpr size_t attributeSize(size_t attribute)
+        {
+            const size_t sizes[] = { Attrs::size... };
+            return sizes[attribute];
+        }
+
+        // what glVertexAttribPointer gets for the attribute
+        static constexpr unsigned int location(size_t attribute)
+        {
+            const unsigned int locations[] = { Attrs::location... };
+            return locations[attribute];
+        }
+        static constexpr int components(size_t attribute)
+        {
+            const int components[] = { Attrs::components... };
+            return components[attribute];
+        }
+        static constexpr GLenum glType(size_t attribute)
+        {
+            const GLenum types[] = { Attrs::glType... };
+            return types[attribute];
+        }
+        static constexpr bool isNormalized(size_t attribute)
+        {
+            const bool normalizes[] = { Attrs::isNormalized... };
+            return normalizes[attribute];
+        }
+
+        // bytes of a whole vertex, the stride of the interleaved layout
+        static constexpr size_t vertexSize()
+        {
+            size_t size = 0;
+            for (size_t i = 0; i < count; i++) size += attributeSize(i);
+            return size;
+        }
+
+        // distance of the same attribute of two neighbouring vertices
+        static constexpr size_t stride(size_t attribute)
+        {
+            return interleaved ? vertexSize() : attributeSize(attribute);
+        }
+
+        // where the attribute of the first vertex is, vertexCount is only needed for SoA
+        // (the streams follow each other, so where one starts depends on how long the others are)
+        static constexpr size_t offset(size_t attribute, size_t vertexCount = 0)
+        {
+            size_t offset = 0;
+            for (size_t i = 0; i < attribute; i++) offset += interleaved ? attributeSize(i) : attributeSize(i) * vertexCount;
+            return offset;
+        }
+
+        static constexpr size_t bufferSize(size_t vertexCount)
+        {
+            return vertexSize() * vertexCount;
+        }
+
+        // Points the attributes of the bound VAO into buffer. attributeMask selects the attributes to set up
+        // (bit i is the i-th attribute of the layout), a pass that needs less can leave the rest disabled.
+        static void setup(unsigned int buffer, size_t vertexCount, unsigned int attributeMask = ~0u)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            for (size_t i = 0; i < count; i++)
+            {
+                if ((attributeMask & (1u << i)) == 0) continue;
+                glVertexAttribPointer(location(i), components(i), glType(i), isNormalized(i) ? GL_TRUE : GL_FALSE,
+                    (GLsizei)stride(i), (void*)offset(i, vertexCount));
+                glEnableVertexAttribArray(location(i));
+            }
+        }
+
+        // Converts vertexCount vectors of floats (as many as the attribute has components) into the
+        // Attribute-th attribute of the vertices in data (bufferSize(vertexCount) bytes).
+        template <size_t Attribute>
+        static void fill(unsigned char* data, size_t vertexCount, const float* source)
+        {
+            typedef typename std::tuple_element<Attribute, std::tuple<Attrs...>>::type A;
+            unsigned char* first = data + offset(Attribute, vertexCount);
+            if (!interleaved && A::size == A::dataSize)
+            {
+                // a tightly packed stream, convert straight into it
+                convert(source, (typename A::Type*)first, vertexCount, A::components, A::isNormalized);
+                return;
+            }
+
+            std::vector<unsigned char> converted(A::dataSize * vertexCount);
+            convert(source, (typename A::Type*)converted.data(), vertexCount, A::components, A::isNormalized);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                std::memcpy(first + i * stride(Attribute), &converted[i * A::dataSize], A::dataSize);
+            }
+        }
+    };
+}
+
+#endif
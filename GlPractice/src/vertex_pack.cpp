@@ -0,0 +1,330 @@
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <glad/glad.h>
+#include "vertex_pack.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_PACK_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace vertex_pack {
+
+	uint32_t floatBits(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float bitsFloat(uint32_t bits)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// float to half with round to nearest even, like the GPU does it
+	uint16_t halfScalar(float value)
+	{
+		const uint32_t f32Infinity = 255u << 23;
+		// the first float that is too big for a half
+		const uint32_t f16Max = (127u + 16u) << 23;
+		// adding this float moves the bits of a half denormal to the bottom of the mantissa
+		const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+		uint32_t bits = floatBits(value);
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint16_t result;
+		if (bits >= f16Max)
+		{
+			// infinity or NaN
+			result = bits > f32Infinity ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < (113u << 23))
+		{
+			// too small for a normal half, becomes a denormal or zero
+			result = (uint16_t)(floatBits(bitsFloat(bits) + bitsFloat(denormMagic)) - denormMagic);
+		}
+		else
+		{
+			uint32_t mantissaOdd = (bits >> 13) & 1;
+			// rebias the exponent and round, the carry of the rounding moves into the exponent by itself
+			bits += ((uint32_t)(15 - 127) << 23) + 0xfff;
+			bits += mantissaOdd;
+			result = (uint16_t)(bits >> 13);
+		}
+		return result | (uint16_t)(sign >> 16);
+	}
+
+	float fromHalf(uint16_t half)
+	{
+		uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+		uint32_t exponent = (half >> 10) & 0x1f;
+		uint32_t mantissa = half & 0x3ff;
+
+		if (exponent == 0x1f) return bitsFloat(sign | 0x7f800000u | (mantissa << 13));
+		// denormals and zero: mantissa * 2^-24
+		if (exponent == 0) return bitsFloat(sign) + (sign ? -1.0f : 1.0f) * mantissa * (1.0f / 16777216.0f);
+		return bitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+#ifdef VERTEX_PACK_SSE2
+	// halfScalar for 4 floats, every branch is computed and the right one is selected with masks
+	__m128i halfSSE2(__m128 value)
+	{
+		const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+		const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+		const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i normalMin = _mm_set1_epi32(113 << 23);
+
+		__m128i bits = _mm_castps_si128(value);
+		__m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000u));
+		bits = _mm_xor_si128(bits, sign);
+
+		// the sign is cleared, so the signed compares work on the bits too
+		__m128i isInfOrNan = _mm_cmpgt_epi32(bits, _mm_sub_epi32(f16Max, _mm_set1_epi32(1)));
+		__m128i isNan = _mm_cmpgt_epi32(bits, f32Infinity);
+		__m128i isDenorm = _mm_cmpgt_epi32(normalMin, bits);
+
+		__m128i infOrNan = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(isNan, _mm_set1_epi32(0x200)));
+
+		__m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(denormMagic))), denormMagic);
+
+		__m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+		__m128i normal = _mm_add_epi32(bits, _mm_set1_epi32((int)((uint32_t)(15 - 127) << 23) + 0xfff));
+		normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+		__m128i result = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+		result = _mm_or_si128(_mm_and_si128(isInfOrNan, infOrNan), _mm_andnot_si128(isInfOrNan, result));
+		return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+	}
+
+	// packs two vectors of 4 values in [0, 0xffff] into 8 16 bit values
+	// (packs_epi32 saturates to signed shorts, so the values are sign extended first to keep their bits)
+	__m128i packLow16(__m128i low, __m128i high)
+	{
+		low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+		high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+		return _mm_packs_epi32(low, high);
+	}
+#endif
+
+	void toHalf(const float* in, uint16_t* out, size_t count)
+	{
+		size_t i = 0;
+#ifdef VERTEX_PACK_SSE2
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i low = halfSSE2(_mm_loadu_ps(in + i));
+			__m128i high = halfSSE2(_mm_loadu_ps(in + i + 4));
+			_mm_storeu_si128((__m128i*)(out + i), packLow16(low, high));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			out[i] = halfScalar(in[i]);
+		}
+	}
+
+	// the normalized conversions all clamp, scale and round to the nearest integer (like the GL spec's
+	// conversion the other way around expects). cvtps_epi32 rounds to nearest even in the default mode.
+	void toSnorm16(const float* in, int16_t* out, size_t count)
+	{
+		size_t i = 0;
+#ifdef VERTEX_PACK_SSE2
+		const __m128 minimum = _mm_set1_ps(-1.0f), maximum = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128 low = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), minimum), maximum), scale);
+			__m128 high = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), minimum), maximum), scale);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float value = in[i] < -1.0f ? -1.0f : in[i] > 1.0f ? 1.0f : in[i];
+			out[i] = (int16_t)std::nearbyint(value * 32767.0f);
+		}
+	}
+
+	void toUnorm16(const float* in, uint16_t* out, size_t count)
+	{
+		size_t i = 0;
+#ifdef VERTEX_PACK_SSE2
+		const __m128 minimum = _mm_setzero_ps(), maximum = _mm_set1_ps(1.0f), scale = _mm_set1_ps(65535.0f);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128 low = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), minimum), maximum), scale);
+			__m128 high = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), minimum), maximum), scale);
+			_mm_storeu_si128((__m128i*)(out + i), packLow16(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float value = in[i] < 0.0f ? 0.0f : in[i] > 1.0f ? 1.0f : in[i];
+			out[i] = (uint16_t)std::nearbyint(value * 65535.0f);
+		}
+	}
+
+	void toUnorm8(const float* in, uint8_t* out, size_t count)
+	{
+		size_t i = 0;
+#ifdef VERTEX_PACK_SSE2
+		const __m128 minimum = _mm_setzero_ps(), maximum = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i values[4];
+			for (int j = 0; j < 4; j++)
+			{
+				__m128 scaled = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + j * 4), minimum), maximum), scale);
+				values[j] = _mm_cvtps_epi32(scaled);
+			}
+			// the values are 0..255, they survive both saturating packs
+			__m128i shorts0 = _mm_packs_epi32(values[0], values[1]);
+			__m128i shorts1 = _mm_packs_epi32(values[2], values[3]);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(shorts0, shorts1));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float value = in[i] < 0.0f ? 0.0f : in[i] > 1.0f ? 1.0f : in[i];
+			out[i] = (uint8_t)std::nearbyint(value * 255.0f);
+		}
+	}
+
+	void toSnorm2101010(const float* in, uint32_t* out, size_t count, int components)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* vector = in + i * components;
+			int32_t values[4];
+#ifdef VERTEX_PACK_SSE2
+			__m128 v = components == 4 ? _mm_loadu_ps(vector) : _mm_set_ps(0.0f, vector[2], vector[1], vector[0]);
+			v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+			// 10 bit signed: -511..511, 2 bit signed: -1..1
+			v = _mm_mul_ps(v, _mm_set_ps(1.0f, 511.0f, 511.0f, 511.0f));
+			_mm_storeu_si128((__m128i*)values, _mm_cvtps_epi32(v));
+#else
+			for (int j = 0; j < 4; j++)
+			{
+				float value = j < components ? vector[j] : 0.0f;
+				value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+				values[j] = (int32_t)std::nearbyint(value * (j == 3 ? 1.0f : 511.0f));
+			}
+#endif
+			// REV: x is in the lowest bits
+			out[i] = ((uint32_t)values[0] & 0x3ff) | (((uint32_t)values[1] & 0x3ff) << 10)
+				| (((uint32_t)values[2] & 0x3ff) << 20) | (((uint32_t)values[3] & 0x3) << 30);
+		}
+	}
+
+	size_t attributeSize(Format format, int components)
+	{
+		size_t size = 0;
+		switch (format)
+		{
+		case FORMAT_FLOAT: size = components * 4; break;
+		case FORMAT_HALF:
+		case FORMAT_SNORM16:
+		case FORMAT_UNORM16: size = components * 2; break;
+		case FORMAT_UNORM8: size = components; break;
+		case FORMAT_SNORM_2_10_10_10: size = 4; break;
+		}
+		return (size + 3) / 4 * 4;
+	}
+
+	int pack(PackedVertices& packed, const std::vector<Attribute>& attributes, int vertexCount)
+	{
+		packed.attributes = attributes;
+		packed.vertexCount = vertexCount;
+		packed.stride = 0;
+		for (Attribute& attribute : packed.attributes)
+		{
+			if (attribute.components < 1 || attribute.components > 4 ||
+				(attribute.format == FORMAT_SNORM_2_10_10_10 && attribute.components < 3))
+			{
+				std::cout << "ERROR::VERTEX_PACK::INVALID_COMPONENT_COUNT " << attribute.location << std::endl;
+				return -1;
+			}
+			attribute.offset = packed.stride;
+			packed.stride += attributeSize(attribute.format, attribute.components);
+		}
+		packed.data.assign(packed.stride * vertexCount, 0);
+
+		// Every attribute is converted as one long stream (that is where SIMD helps), then scattered into
+		// the interleaved vertices. The temporary buffer is reused by the attributes.
+		std::vector<unsigned char> converted;
+		for (const Attribute& attribute : packed.attributes)
+		{
+			size_t count = (size_t)vertexCount * attribute.components;
+			size_t elementSize;
+			switch (attribute.format)
+			{
+			case FORMAT_FLOAT:
+				converted.resize(count * 4);
+				std::memcpy(converted.data(), attribute.source, count * 4);
+				elementSize = 4 * attribute.components;
+				break;
+			case FORMAT_HALF:
+				converted.resize(count * 2);
+				toHalf(attribute.source, (uint16_t*)converted.data(), count);
+				elementSize = 2 * attribute.components;
+				break;
+			case FORMAT_SNORM16:
+				converted.resize(count * 2);
+				toSnorm16(attribute.source, (int16_t*)converted.data(), count);
+				elementSize = 2 * attribute.components;
+				break;
+			case FORMAT_UNORM16:
+				converted.resize(count * 2);
+				toUnorm16(attribute.source, (uint16_t*)converted.data(), count);
+				elementSize = 2 * attribute.components;
+				break;
+			case FORMAT_UNORM8:
+				converted.resize(count);
+				toUnorm8(attribute.source, converted.data(), count);
+				elementSize = attribute.components;
+				break;
+			default:
+				converted.resize((size_t)vertexCount * 4);
+				toSnorm2101010(attribute.source, (uint32_t*)converted.data(), vertexCount, attribute.components);
+				elementSize = 4;
+				break;
+			}
+
+			for (int i = 0; i < vertexCount; i++)
+			{
+				std::memcpy(&packed.data[i * packed.stride + attribute.offset], &converted[i * elementSize], elementSize);
+			}
+		}
+
+		return 0;
+	}
+
+	void setAttributes(const PackedVertices& packed)
+	{
+		for (const Attribute& attribute : packed.attributes)
+		{
+			GLenum type = GL_FLOAT;
+			GLboolean normalized = GL_TRUE;
+			GLint size = attribute.components;
+			switch (attribute.format)
+			{
+			case FORMAT_FLOAT: type = GL_FLOAT; normalized = GL_FALSE; break;
+			case FORMAT_HALF: type = GL_HALF_FLOAT; normalized = GL_FALSE; break;
+			case FORMAT_SNORM16: type = GL_SHORT; break;
+			case FORMAT_UNORM16: type = GL_UNSIGNED_SHORT; break;
+			case FORMAT_UNORM8: type = GL_UNSIGNED_BYTE; break;
+			// the packed types always have 4 components, a vec3 input simply ignores w
+			case FORMAT_SNORM_2_10_10_10: type = GL_INT_2_10_10_10_REV; size = 4; break;
+			}
+			glVertexAttribPointer(attribute.location, size, type, normalized, (GLsizei)packed.stride, (void*)attribute.offset);
+			glEnableVertexAttribArray(attribute.location);
+		}
+	}
+
+}
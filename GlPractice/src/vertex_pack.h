@@ -0,0 +1,68 @@
+#ifndef VERTEX_PACK_H
+#define VERTEX_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs float vertex data into smaller GPU formats. A vertex of the texture scene is 32 bytes as floats,
+// but positions fit into half floats, colors into 4 bytes and texture coordinates into 16 bit integers,
+// which is half the memory and half the bandwidth the vertex fetch needs.
+// The converters work on 4 values at a time with SSE2 where it is available.
+namespace vertex_pack {
+    enum Format {
+        // 32 bit float, no conversion
+        FORMAT_FLOAT,
+        // 16 bit float (GL_HALF_FLOAT), for positions and texture coordinates
+        FORMAT_HALF,
+        // [-1, 1] in a 16 bit integer (GL_SHORT normalized), for positions already inside [-1, 1]
+        FORMAT_SNORM16,
+        // [0, 1] in a 16 bit integer (GL_UNSIGNED_SHORT normalized), for texture coordinates
+        FORMAT_UNORM16,
+        // [0, 1] in a byte (GL_UNSIGNED_BYTE normalized), for colors
+        FORMAT_UNORM8,
+        // xyz in 10 bits and w in 2 bits of one int (GL_INT_2_10_10_10_REV normalized), for normals and tangents
+        FORMAT_SNORM_2_10_10_10
+    };
+
+    struct Attribute {
+        unsigned int location;
+        // floats per vertex in the source (1..4, 3 or 4 for FORMAT_SNORM_2_10_10_10)
+        int components;
+        Format format;
+        // vertexCount * components floats
+        const float* source;
+        // set by pack: where the attribute is inside a packed vertex
+        size_t offset;
+    };
+
+    // interleaved packed vertices, ready to be uploaded to a VBO
+    struct PackedVertices {
+        std::vector<unsigned char> data;
+        std::vector<Attribute> attributes;
+        size_t stride;
+        int vertexCount;
+    };
+
+    // bytes one attribute takes in a packed vertex (rounded up to 4, GL wants aligned attributes)
+    size_t attributeSize(Format format, int components);
+
+    // Converts the attributes into one interleaved buffer, returns 0 on success.
+    // The source pointers are only read during the call.
+    int pack(PackedVertices& packed, const std::vector<Attribute>& attributes, int vertexCount);
+    // calls glVertexAttribPointer for every attribute with the right type and normalize flag,
+    // the VBO with the packed data has to be bound to GL_ARRAY_BUFFER
+    void setAttributes(const PackedVertices& packed);
+
+    // the converters, count is the number of floats
+    void toHalf(const float* in, uint16_t* out, size_t count);
+    void toSnorm16(const float* in, int16_t* out, size_t count);
+    void toUnorm16(const float* in, uint16_t* out, size_t count);
+    void toUnorm8(const float* in, uint8_t* out, size_t count);
+    // count is the number of vectors, in has components (3 or 4) floats per vector, w is 0 for 3 components
+    void toSnorm2101010(const float* in, uint32_t* out, size_t count, int components);
+    // for checking the results
+    float fromHalf(uint16_t half);
+}
+
+#endif